@@ -1,4 +1,8 @@
 """Test UGrid2dDataExtractor.cpp."""
+from concurrent.futures import ThreadPoolExecutor
+import os
+import tempfile
+import time
 import unittest
 
 import numpy as np
@@ -320,8 +324,8 @@ class TestUGrid2dDataExtractor(unittest.TestCase):
 
         # expected results with point 4 inactive
         expected_interp_values = [
-            2.0, 3.4444, float('nan'), 6.75,  # row 1 cells
-            3.5, 5.7303, 5.4652, 8.25     # row 2 cells
+            2.0, 3.4444, float('nan'), 8.25,  # row 1 cells
+            4.0, 5.9289, 6.7888, 9.75     # row 2 cells
         ]
 
         ugrid = UGrid(points, cells)
@@ -499,6 +503,245 @@ class TestUGrid2dDataExtractor(unittest.TestCase):
         expected_values = [4.5, 5, 5.5]
         np.testing.assert_array_equal(expected_values, extracted_values)
 
+    def test_multithreaded_extraction(self):
+        """Test that extracting with several threads matches extracting serially."""
+        rows, cols = 30, 40
+        points = [(col, row, 0) for row in range(rows + 1) for col in range(cols + 1)]
+        cells = []
+        for row in range(rows):
+            for col in range(cols):
+                pt0 = row * (cols + 1) + col
+                pt1 = pt0 + cols + 1
+                cells.extend([UGrid.cell_type_enum.QUAD, 4, pt0, pt0 + 1, pt1 + 1, pt1])
+        ugrid = UGrid(points, cells)
+        extractor = UGrid2dDataExtractor(ugrid)
+        self.assertEqual(1, extractor.thread_count)
+
+        point_scalars = [(i * 37) % 101 / 7.0 for i in range(len(points))]
+        extractor.set_grid_point_scalars(point_scalars, [], 'points')
+        xs = np.linspace(-1, cols + 1, 80)
+        ys = np.linspace(-1, rows + 1, 60)
+        extractor.extract_locations = [(x, y, 0) for y in ys for x in xs]
+
+        serial_values = extractor.extract_data()
+        serial_cells = extractor.cell_indexes
+        extractor.thread_count = 4
+        self.assertEqual(4, extractor.thread_count)
+        np.testing.assert_array_equal(serial_values, extractor.extract_data())
+        np.testing.assert_array_equal(serial_cells, extractor.cell_indexes)
+
+    def test_prepared_locations(self):
+        """Test that prepared locations match searching for each location."""
+        points = [(0, 0, 0), (1, 0, 0), (2, 0, 0), (0, 1, 0), (1, 1, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 4, 3,
+                 UGrid.cell_type_enum.QUAD, 4, 1, 2, 5, 4]
+        ugrid = UGrid(points, cells)
+        searched = UGrid2dDataExtractor(ugrid)
+        prepared = UGrid2dDataExtractor(ugrid)
+        self.assertFalse(prepared.use_prepared_locations)
+        prepared.use_prepared_locations = True
+        self.assertTrue(prepared.use_prepared_locations)
+        extract_locations = [(0.25, 0.5, 0), (1.0, 0.5, 0), (1.75, 0.25, 0), (3.0, 0.5, 0)]
+        searched.extract_locations = extract_locations
+        prepared.extract_locations = extract_locations
+
+        for step in range(3):
+            scalars = [step + i for i in range(6)]
+            activity = [True] * 6 if step != 1 else [True, True, True, True, False, True]
+            searched.set_grid_point_scalars(scalars, activity, 'points')
+            prepared.set_grid_point_scalars(scalars, activity, 'points')
+            np.testing.assert_array_equal(searched.extract_data(), prepared.extract_data())
+            np.testing.assert_array_equal(searched.cell_indexes, prepared.cell_indexes)
+
+    def test_triangles_cache_file(self):
+        """Test reading triangles from a cache file written by another extractor."""
+        points = [(0, 0, 0), (1, 0, 0), (2, 0, 0), (0, 1, 0), (1, 1, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 4, 3,
+                 UGrid.cell_type_enum.QUAD, 4, 1, 2, 5, 4]
+        ugrid = UGrid(points, cells)
+        extract_locations = [(0.25, 0.5, 0), (1.0, 0.5, 0), (1.75, 0.25, 0), (3.0, 0.5, 0)]
+        with tempfile.TemporaryDirectory() as temp_dir:
+            file_name = os.path.join(temp_dir, 'triangles.bin')
+            values = []
+            for _ in range(2):
+                extractor = UGrid2dDataExtractor(ugrid)
+                self.assertEqual('', extractor.triangles_cache_file)
+                extractor.triangles_cache_file = file_name
+                self.assertEqual(file_name, extractor.triangles_cache_file)
+                extractor.set_grid_cell_scalars([1, 2], [], 'cells')
+                extractor.extract_locations = extract_locations
+                values.append(extractor.extract_data())
+                self.assertTrue(os.path.exists(file_name + '.cells'))
+            np.testing.assert_array_equal(values[0], values[1])
+
+    def test_update_grid_activity(self):
+        """Test changing the activity of one cell."""
+        points = [(0, 0, 0), (1, 0, 0), (2, 0, 0), (0, 1, 0), (1, 1, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 4, 3,
+                 UGrid.cell_type_enum.QUAD, 4, 1, 2, 5, 4]
+        ugrid = UGrid(points, cells)
+        extract_locations = [(0.25, 0.5, 0), (1.75, 0.5, 0)]
+        extractor = UGrid2dDataExtractor(ugrid)
+        extractor.extract_locations = extract_locations
+        extractor.set_grid_cell_scalars([1, 2], [], 'cells')
+        extractor.update_grid_activity([1], [True, False], 'cells')
+
+        expected = UGrid2dDataExtractor(ugrid)
+        expected.extract_locations = extract_locations
+        expected.set_grid_cell_scalars([1, 2], [True, False], 'cells')
+        np.testing.assert_array_equal(expected.extract_data(), extractor.extract_data())
+
+    def test_update_grid_scalars(self):
+        """Test changing one point scalar."""
+        points = [(0, 0, 0), (1, 0, 0), (2, 0, 0), (0, 1, 0), (1, 1, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 4, 3,
+                 UGrid.cell_type_enum.QUAD, 4, 1, 2, 5, 4]
+        ugrid = UGrid(points, cells)
+        extract_locations = [(0.25, 0.5, 0), (1.75, 0.5, 0)]
+        extractor = UGrid2dDataExtractor(ugrid)
+        extractor.extract_locations = extract_locations
+        extractor.set_grid_point_scalars([1, 2, 3, 4, 5, 6], [], 'points')
+        extractor.update_grid_scalars([2], [8])
+
+        expected = UGrid2dDataExtractor(ugrid)
+        expected.extract_locations = extract_locations
+        expected.set_grid_point_scalars([1, 2, 8, 4, 5, 6], [], 'points')
+        np.testing.assert_array_equal(expected.extract_data(), extractor.extract_data())
+
+    def test_extract_timesteps(self):
+        """Test extracting several time steps at once."""
+        points = [(0, 0, 0), (1, 0, 0), (2, 0, 0), (0, 1, 0), (1, 1, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 4, 3,
+                 UGrid.cell_type_enum.QUAD, 4, 1, 2, 5, 4]
+        ugrid = UGrid(points, cells)
+        extractor = UGrid2dDataExtractor(ugrid)
+        extractor.extract_locations = [(0.5, 0.5, 0), (1.0, 0.5, 0), (1.5, 0.5, 0), (3.0, 0.5, 0)]
+
+        scalars = np.array([[1, 2], [3, 4], [5, 6]])
+        activity = [[], [False, True], [True, True]]
+        values = extractor.extract_timesteps(scalars, 'cells', activity, 'cells')
+        self.assertEqual((3, 4), values.shape)
+        for step in range(3):
+            extractor.set_grid_cell_scalars(scalars[step], activity[step], 'cells')
+            np.testing.assert_array_equal(extractor.extract_data(), values[step])
+
+    def test_numpy_arrays(self):
+        """Test extracting with NumPy array inputs and outputs."""
+        points = [(0, 0, 0), (1, 0, 0), (2, 0, 0), (0, 1, 0), (1, 1, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 4, 3,
+                 UGrid.cell_type_enum.QUAD, 4, 1, 2, 5, 4]
+        ugrid = UGrid(points, cells)
+        extractor = UGrid2dDataExtractor(ugrid)
+        extractor.no_data_value = -999.0
+
+        locations = np.array([(0.5, 0.5), (1.5, 0.5), (3.0, 0.5)])
+        extractor.extract_locations = locations
+        retrieved_locations = extractor.extract_locations
+        self.assertIsInstance(retrieved_locations, np.ndarray)
+        self.assertEqual((3, 3), retrieved_locations.shape)
+        np.testing.assert_array_equal([(0.5, 0.5, 0), (1.5, 0.5, 0), (3.0, 0.5, 0)], retrieved_locations)
+
+        cell_scalars = np.array([1.0, 2.0], dtype=np.float64)
+        extractor.set_grid_cell_scalars(cell_scalars, np.array([True, False]), 'cells')
+        values = extractor.extract_data()
+        self.assertIsInstance(values, np.ndarray)
+        self.assertEqual(np.float32, values.dtype)
+        np.testing.assert_array_equal([1.0, -999.0, -999.0], values)
+        cell_indexes = extractor.cell_indexes
+        self.assertIsInstance(cell_indexes, np.ndarray)
+        np.testing.assert_array_equal([0, -1, -1], cell_indexes)
+
+        point_scalars = np.arange(6, dtype=np.float32)
+        extractor.set_grid_point_scalars(point_scalars, np.ones(6, dtype=bool), 'points')
+        np.testing.assert_allclose([2.0, 3.0, -999.0], extractor.extract_data())
+
+    def test_python_threads(self):
+        """Test that extracting from several Python threads gives the same results as one thread."""
+        rows, cols = 60, 60
+        points = [(col, row, 0) for row in range(rows + 1) for col in range(cols + 1)]
+        cells = []
+        for row in range(rows):
+            for col in range(cols):
+                pt0 = row * (cols + 1) + col
+                pt1 = pt0 + cols + 1
+                cells.extend([UGrid.cell_type_enum.QUAD, 4, pt0, pt0 + 1, pt1 + 1, pt1])
+        ugrid = UGrid(points, cells)
+        point_scalars = np.arange(len(points), dtype=np.float32)
+        locations = np.random.default_rng(0).uniform(-1, cols + 1, (20000, 2))
+
+        num_workers = 4
+        extractors = [UGrid2dDataExtractor(ugrid) for _ in range(num_workers)]
+        for extractor in extractors:
+            extractor.set_grid_point_scalars(point_scalars, [], 'points')
+            extractor.extract_locations = locations
+        expected = extractors[0].extract_data()
+
+        # each thread using its own extractor
+        with ThreadPoolExecutor(max_workers=num_workers) as pool:
+            results = list(pool.map(lambda extractor: extractor.extract_data(), extractors))
+        for result in results:
+            np.testing.assert_array_equal(expected, result)
+
+        # several threads using one extractor
+        extractor = extractors[0]
+        with ThreadPoolExecutor(max_workers=num_workers) as pool:
+            values = list(pool.map(lambda location: extractor.extract_at_location((*location, 0)), locations[:1000]))
+            results = list(pool.map(lambda _: extractor.extract_data(), range(num_workers)))
+        np.testing.assert_array_equal(expected[:1000], values)
+        for result in results:
+            np.testing.assert_array_equal(expected, result)
+
+        # threads setting scalars while others extract see either the old or the new scalars
+        extractors[1].set_grid_point_scalars(2 * point_scalars, [], 'points')
+        doubled = extractors[1].extract_data()
+
+        def set_or_extract(step):
+            if step % 2 == 0:
+                extractor.set_grid_point_scalars(point_scalars * (1 + step % 4 // 2), [], 'points')
+                return None
+            return extractor.extract_data()
+
+        with ThreadPoolExecutor(max_workers=num_workers) as pool:
+            results = [result for result in pool.map(set_or_extract, range(16)) if result is not None]
+        for result in results:
+            if not np.array_equal(expected, result):
+                np.testing.assert_array_equal(doubled, result)
+
+    @unittest.skipIf((os.cpu_count() or 1) < 2, 'requires at least two CPUs')
+    def test_python_threads_speedup(self):
+        """Test that extracting from several Python threads runs in parallel."""
+        rows, cols = 150, 150
+        points = [(col, row, 0) for row in range(rows + 1) for col in range(cols + 1)]
+        cells = []
+        for row in range(rows):
+            for col in range(cols):
+                pt0 = row * (cols + 1) + col
+                pt1 = pt0 + cols + 1
+                cells.extend([UGrid.cell_type_enum.QUAD, 4, pt0, pt0 + 1, pt1 + 1, pt1])
+        ugrid = UGrid(points, cells)
+        point_scalars = np.arange(len(points), dtype=np.float32)
+        locations = np.random.default_rng(0).uniform(-1, cols + 1, (200000, 2))
+
+        num_workers = min(4, os.cpu_count())
+        extractors = [UGrid2dDataExtractor(ugrid) for _ in range(num_workers)]
+        for extractor in extractors:
+            extractor.set_grid_point_scalars(point_scalars, [], 'points')
+            extractor.extract_locations = locations
+        expected = extractors[0].extract_data()
+
+        start = time.perf_counter()
+        for extractor in extractors:
+            extractor.extract_data()
+        serial_time = time.perf_counter() - start
+
+        with ThreadPoolExecutor(max_workers=num_workers) as pool:
+            start = time.perf_counter()
+            results = list(pool.map(lambda extractor: extractor.extract_data(), extractors))
+            parallel_time = time.perf_counter() - start
+        for result in results:
+            np.testing.assert_array_equal(expected, result)
+        self.assertLess(parallel_time, serial_time)
+
     def test_tutorial(self):
         """Test UGrid2dDataExtractor for tutorial."""
         # build 2x3 grid
@@ -471,6 +471,101 @@ class TestUGrid2dPolylineDataExtractor(unittest.TestCase):
                               (0.75, 0.75, 0.0), (1., 0.75, 0.0), (1.25, 0.75, 0.0), (1.5, 0.75, 0.0)]
         np.testing.assert_array_equal(expected_locations, extracted_locations)
 
+    def test_compute_locations_and_extract_data(self):
+        """Test computing locations and extracting data in one call."""
+        points = [(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0), (2, 0, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 2, 3, UGrid.cell_type_enum.QUAD, 4, 1, 4, 5, 2]
+        ugrid = UGrid(points, cells)
+        extractor = UGrid2dPolylineDataExtractor(ugrid, "cells")
+        extractor.set_grid_scalars([1, 2], [], "cells")
+
+        polyline = [(-0.5, 0.75, 0.0), (1.5, 0.75, 0.0)]
+        extracted_data, extracted_locations = extractor.compute_locations_and_extract_data(polyline)
+        extractor.set_polyline(polyline)
+        np.testing.assert_array_equal(extractor.extract_data(), extracted_data)
+        np.testing.assert_array_equal(extractor.extract_locations, extracted_locations)
+
+    def test_extract_polylines(self):
+        """Test extracting many polylines at once."""
+        points = [(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0), (2, 0, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 2, 3, UGrid.cell_type_enum.QUAD, 4, 1, 4, 5, 2]
+        ugrid = UGrid(points, cells)
+        extractor = UGrid2dPolylineDataExtractor(ugrid, "cells")
+        extractor.set_grid_scalars([1, 2], [], "cells")
+
+        polylines = [[(-0.5, 0.75, 0.0), (1.5, 0.75, 0.0)], [(0.5, 0.25, 0.0), (1.5, 0.25, 0.0)]]
+        offsets, locations, data, cell_idxs = extractor.extract_polylines(polylines)
+        for i, polyline in enumerate(polylines):
+            expected_data, expected_locations = extractor.compute_locations_and_extract_data(polyline)
+            np.testing.assert_array_equal(expected_data, data[offsets[i]:offsets[i + 1]])
+            np.testing.assert_array_equal(expected_locations, locations[offsets[i]:offsets[i + 1]])
+            np.testing.assert_array_equal(extractor.cell_indexes, cell_idxs[offsets[i]:offsets[i + 1]])
+        self.assertEqual(len(locations), offsets[-1])
+
+    def test_cell_walking(self):
+        """Test finding polyline locations by walking cells."""
+        points = [(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0), (2, 0, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 2, 3, UGrid.cell_type_enum.QUAD, 4, 1, 4, 5, 2]
+        ugrid = UGrid(points, cells)
+        extractor = UGrid2dPolylineDataExtractor(ugrid, "points")
+        extractor.set_grid_scalars([0, 1, 2, 1, 2, 3], [], "points")
+        self.assertFalse(extractor.use_cell_walking)
+        extractor.use_cell_walking = True
+        self.assertTrue(extractor.use_cell_walking)
+
+        polyline = [(0.5, 0.25, 0.0), (1.5, 0.75, 0.0)]
+        extracted_data, extracted_locations = extractor.compute_locations_and_extract_data(polyline)
+        expected_locations = [(0.5, 0.25, 0.0), (1.0, 0.5, 0.0), (1.5, 0.75, 0.0)]
+        np.testing.assert_array_almost_equal(expected_locations, extracted_locations)
+        np.testing.assert_array_almost_equal([0.75, 1.5, 2.25], extracted_data)
+
+    def test_sample_locations(self):
+        """Test adding locations at a station spacing and per segment."""
+        points = [(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0), (2, 0, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 2, 3, UGrid.cell_type_enum.QUAD, 4, 1, 4, 5, 2]
+        ugrid = UGrid(points, cells)
+        extractor = UGrid2dPolylineDataExtractor(ugrid, "points")
+        extractor.set_grid_scalars([0, 1, 2, 1, 2, 3], [], "points")
+        extractor.use_cell_walking = True
+        self.assertEqual(0.0, extractor.sample_spacing)
+        self.assertEqual(0, extractor.samples_per_segment)
+
+        extractor.sample_spacing = 0.4
+        polyline = [(0.2, 0.5, 0.0), (1.8, 0.5, 0.0)]
+        extracted_data, extracted_locations = extractor.compute_locations_and_extract_data(polyline)
+        expected_locations = [(0.2, 0.5, 0.0), (0.6, 0.5, 0.0), (1.0, 0.5, 0.0), (1.4, 0.5, 0.0),
+                              (1.8, 0.5, 0.0)]
+        np.testing.assert_array_almost_equal(expected_locations, extracted_locations)
+        np.testing.assert_array_almost_equal([0.7, 1.1, 1.5, 1.9, 2.3], extracted_data)
+
+        extractor.sample_spacing = 0.0
+        extractor.samples_per_segment = 3
+        self.assertEqual(3, extractor.samples_per_segment)
+        extracted_data, extracted_locations = extractor.compute_locations_and_extract_data(polyline)
+        expected_locations = [(0.2, 0.5, 0.0), (0.6, 0.5, 0.0), (1.0, 0.5, 0.0), (1.4, 0.5, 0.0),
+                              (1.8, 0.5, 0.0)]
+        np.testing.assert_array_almost_equal(expected_locations, extracted_locations)
+
+    def test_stations(self):
+        """Test the station and segment of each location."""
+        points = [(0, 0, 0), (1, 0, 0), (1, 1, 0), (0, 1, 0), (2, 0, 0), (2, 1, 0)]
+        cells = [UGrid.cell_type_enum.QUAD, 4, 0, 1, 2, 3, UGrid.cell_type_enum.QUAD, 4, 1, 4, 5, 2]
+        ugrid = UGrid(points, cells)
+        extractor = UGrid2dPolylineDataExtractor(ugrid, "points")
+        extractor.set_grid_scalars([0, 1, 2, 1, 2, 3], [], "points")
+        extractor.use_cell_walking = True
+
+        polyline = [(0.5, 0.25, 0.0), (1.5, 0.25, 0.0), (1.5, 0.75, 0.0)]
+        extractor.set_polyline(polyline)
+        expected_locations = [(0.5, 0.25, 0.0), (1.0, 0.25, 0.0), (1.5, 0.25, 0.0), (1.5, 0.75, 0.0)]
+        np.testing.assert_array_almost_equal(expected_locations, extractor.extract_locations)
+        np.testing.assert_array_almost_equal([0.0, 0.5, 1.0, 1.5], extractor.extract_stations)
+        np.testing.assert_array_equal([0, 0, 0, 1], extractor.extract_segment_indexes)
+
+        extractor.extract_polylines([polyline, [(0.5, 0.5, 0.0), (1.5, 0.5, 0.0)]])
+        np.testing.assert_array_almost_equal([0.0, 0.5, 1.0, 1.5, 0.0, 0.5, 1.0], extractor.extract_stations)
+        np.testing.assert_array_equal([0, 0, 0, 1, 0, 0, 0], extractor.extract_segment_indexes)
+
     def test_transient_tutorial(self):
         """Test UGrid2dPolylineDataExtractor for tutorial with transient data."""
         # build 2x3 grid
@@ -1,4 +1,6 @@
 """Extract data from a UGrid2d at specified locations."""
+import numpy as np
+
 from ._xmsextractor import extractor
 
 
@@ -39,7 +41,7 @@ class UGrid2dDataExtractor(object):
         """Setup point scalars to be used to extract interpolated data.
 
         Args:
-            point_scalars (iterable): The point scalars.
+            point_scalars (iterable): The point scalars. NumPy arrays are read without copying element by element.
             activity (iterable): The activity of the cells.
             activity_type (string): The location at which the data is currently stored. One of 'points', 'cells',
                 or 'unknown'
@@ -52,7 +54,7 @@ class UGrid2dDataExtractor(object):
         """Setup cell scalars to be used to extract interpolated data.
 
         Args:
-            cell_scalars (iterable): The cell scalars.
+            cell_scalars (iterable): The cell scalars. NumPy arrays are read without copying element by element.
             activity (iterable): The activity of the cells.
             activity_type (string): The location at which the data is currently stored. One of 'points', 'cells',
                 or 'unknown'
@@ -61,16 +63,37 @@ class UGrid2dDataExtractor(object):
         data_location = self.data_locations[activity_type]
         self._instance.SetGridCellScalars(cell_scalars, activity, data_location)
 
+    def update_grid_activity(self, changed_idxs, activity, activity_type):
+        """Change the activity of a few cells or points without setting the scalars again.
+
+        Args:
+            changed_idxs (iterable): The cells or points whose activity changed.
+            activity (iterable): The new activity of every cell or point. Empty for all active.
+            activity_type (string): The location of the activity. One of 'points' or 'cells'.
+        """
+        self._check_data_locations(activity_type)
+        data_location = self.data_locations[activity_type]
+        self._instance.UpdateGridActivity(changed_idxs, activity, data_location)
+
+    def update_grid_scalars(self, idxs, values):
+        """Change some of the point or cell scalars without setting all of them again.
+
+        Args:
+            idxs (iterable): The points or cells (matching the current scalars) of the changed values.
+            values (iterable): The new value for each index.
+        """
+        self._instance.UpdateGridScalars(idxs, values)
+
     def extract_data(self):
         """Extract interpolated data for the previously set locations.
 
         Returns:
-            The interpolated scalars.
+            The interpolated scalars as a NumPy array.
         """
         return self._instance.ExtractData()
 
     def extract_at_location(self, location):
-        """Extract interpolated data for the previously set locations.
+        """Extract interpolated data at a single location without changing the extract locations.
 
         Args:
             location: The location to get the interpolated scalar.
@@ -80,9 +103,34 @@ class UGrid2dDataExtractor(object):
         """
         return self._instance.ExtractAtLocation(location)
 
+    def extract_timesteps(self, scalars, scalar_location, activity=None, activity_type='cells'):
+        """Extract interpolated data at the extract locations for several time steps.
+
+        Gives the same values as setting the scalars and extracting for each time step, but locates each extract
+        location only once.
+
+        Args:
+            scalars (iterable): The scalars for each time step ([time steps x values]).
+            scalar_location (string): The location of the scalars. One of 'points' or 'cells'.
+            activity (iterable): Optional activity for each time step. Each time step's activity may be empty.
+            activity_type (string): The location of the activity. One of 'points', 'cells', or 'unknown'
+
+        Returns:
+            The interpolated scalars as a [time steps x locations] array.
+        """
+        self._check_data_locations(scalar_location)
+        self._check_data_locations(activity_type)
+        scalars = np.asarray(scalars, dtype=np.float32)
+        num_timesteps = scalars.shape[0] if scalars.ndim > 1 else 1
+        values = self._instance.ExtractTimesteps(
+            scalars.ravel(), self.data_locations[scalar_location],
+            [] if activity is None else activity, self.data_locations[activity_type]
+        )
+        return np.asarray(values).reshape(num_timesteps, -1)
+
     @property
     def extract_locations(self):
-        """Locations of points to extract interpolated scalar data from."""
+        """Locations of points to extract interpolated scalar data from as an (n, 3) NumPy array."""
         return self._instance.GetExtractLocations()
 
     @extract_locations.setter
@@ -114,3 +162,36 @@ class UGrid2dDataExtractor(object):
     def no_data_value(self, value):
         """Set value to use when extracted value is in inactive cell or doesn't intersect with the grid."""
         self._instance.SetNoDataValue(value)
+
+    @property
+    def thread_count(self):
+        """Number of threads used to extract data. One extracts serially; zero or less uses all hardware threads."""
+        return self._instance.GetThreadCount()
+
+    @thread_count.setter
+    def thread_count(self, value):
+        """Set the number of threads used to extract data."""
+        self._instance.SetThreadCount(value)
+
+    @property
+    def use_prepared_locations(self):
+        """Locate the extract locations once and reuse the interpolation weights until they change."""
+        return self._instance.GetUsePreparedLocations()
+
+    @use_prepared_locations.setter
+    def use_prepared_locations(self, value):
+        """Set whether to reuse the interpolation weights for the extract locations."""
+        self._instance.SetUsePreparedLocations(value)
+
+    @property
+    def triangles_cache_file(self):
+        """Base name of the files the triangles are kept in between runs; empty to always build them.
+
+        Triangles for cell scalars are kept in the name with '.cells' added and for point scalars with '.points'.
+        """
+        return self._instance.GetTrianglesCacheFile()
+
+    @triangles_cache_file.setter
+    def triangles_cache_file(self, value):
+        """Set the file the triangles are read from and written to between runs."""
+        self._instance.SetTrianglesCacheFile(value)
@@ -91,13 +91,43 @@ class UGrid2dPolylineDataExtractor(object):
         Returns:
             A tuple of the extracted data and their locations
         """
-        return self._instance.ComputeLocationsAndExtractLocations(polyline)
+        return self._instance.ComputeLocationsAndExtractData(polyline)
+
+    def extract_polylines(self, polylines):
+        """Extract data along many polylines at once using the data extractor's threads.
+
+        The locations of all polylines become the extract locations.
+
+        Args:
+            polylines (iterable): The polylines, each an iterable of points.
+
+        Returns:
+            A tuple of the offset of each polyline's first location (followed by the
+            number of locations), the locations, the extracted data and the cell index
+            of each location.
+        """
+        offsets = [0]
+        points = []
+        for polyline in polylines:
+            points.extend(polyline)
+            offsets.append(len(points))
+        return self._instance.ExtractPolylines(offsets, points)
 
     @property
     def extract_locations(self):
         """Locations of points to extract interpolated scalar data from."""
         return self._instance.GetExtractLocations()
 
+    @property
+    def extract_stations(self):
+        """Plan view distance along its polyline to each extract location."""
+        return self._instance.GetExtractStations()
+
+    @property
+    def extract_segment_indexes(self):
+        """Polyline segment of each extract location."""
+        return self._instance.GetExtractSegmentIndexes()
+
     @property
     def cell_indexes(self):
         """Cell indexes for the extract location."""
@@ -122,3 +152,33 @@ class UGrid2dPolylineDataExtractor(object):
     def no_data_value(self, value):
         """Set value to use when extracted value is in inactive cell or doesn't intersect with the grid."""
         self._instance.SetNoDataValue(value)
+
+    @property
+    def use_cell_walking(self):
+        """Find polyline locations by walking across cell edges instead of intersecting triangles."""
+        return self._instance.GetUseCellWalking()
+
+    @use_cell_walking.setter
+    def use_cell_walking(self, value):
+        """Set whether to find polyline locations by walking across cell edges."""
+        self._instance.SetUseCellWalking(value)
+
+    @property
+    def sample_spacing(self):
+        """Station spacing at which locations are added along the polyline, or zero for none."""
+        return self._instance.GetSampleSpacing()
+
+    @sample_spacing.setter
+    def sample_spacing(self, value):
+        """Set the station spacing at which locations are added along the polyline."""
+        self._instance.SetSampleSpacing(value)
+
+    @property
+    def samples_per_segment(self):
+        """Number of locations added evenly spaced inside each polyline segment."""
+        return self._instance.GetSamplesPerSegment()
+
+    @samples_per_segment.setter
+    def samples_per_segment(self, value):
+        """Set the number of locations added evenly spaced inside each polyline segment."""
+        self._instance.SetSamplesPerSegment(value)
@@ -0,0 +1,254 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup extractor
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsextractor/extractor/XmCellToPointOperator.h>
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmsextractor/ugrid/XmUGridTriangles2d.h>
+#include <xmsgrid/ugrid/XmUGrid.h>
+#include <xmsinterp/interpolate/InterpUtil.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+/// XMS Namespace
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmCellToPointOperator
+/// \brief A sparse operator, stored in compressed rows, that calculates each
+///        UGrid point scalar from the scalars of the cells around it by
+///        average or IDW. The adjacency, centroid distances and all active IDW
+///        weights only depend on the mesh so they are found once rather than
+///        each time the scalars change.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Constructor.
+//------------------------------------------------------------------------------
+XmCellToPointOperator::XmCellToPointOperator()
+: useIdw(false)
+{
+} // XmCellToPointOperator::XmCellToPointOperator
+//------------------------------------------------------------------------------
+/// \brief Build the operator for a UGrid.
+/// \param[in] a_ugrid The UGrid.
+/// \param[in] a_triangles The triangles for cell scalars, which have the cell
+///            centroids used for IDW.
+/// \param[in] a_useIdw Whether to build IDW weights.
+//------------------------------------------------------------------------------
+void XmCellToPointOperator::Build(const XmUGrid& a_ugrid,
+                                  const XmUGridTriangles2d& a_triangles,
+                                  bool a_useIdw)
+{
+  Clear();
+  useIdw = a_useIdw;
+  int numPoints = a_ugrid.GetPointCount();
+  offsets.reserve(numPoints + 1);
+  offsets.push_back(0);
+  if (useIdw)
+  {
+    idwOffsets.reserve(numPoints + 1);
+    idwOffsets.push_back(0);
+  }
+
+  VecInt adjacentCells;
+  VecInt centroids;
+  VecDbl d2;
+  VecDbl weights;
+  for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+  {
+    a_ugrid.GetPointAdjacentCells(pointIdx, adjacentCells);
+    cellIdxs.insert(cellIdxs.end(), adjacentCells.begin(), adjacentCells.end());
+    offsets.push_back(static_cast<int>(cellIdxs.size()));
+    if (!useIdw)
+      continue;
+
+    centroids.clear();
+    for (auto cellIdx : adjacentCells)
+    {
+      int centroidIdx = a_triangles.GetCellCentroid(cellIdx);
+      if (centroidIdx >= 0)
+      {
+        idwCellIdxs.push_back(cellIdx);
+        centroids.push_back(centroidIdx);
+      }
+    }
+    if (!centroids.empty())
+    {
+      inDistanceSquared(a_ugrid.GetPointLocation(pointIdx), centroids, a_triangles.GetPoints(),
+                        true, d2);
+      inIdwWeights(d2, 2, false, weights);
+      idwDistances2.insert(idwDistances2.end(), d2.begin(), d2.end());
+      idwWeights.insert(idwWeights.end(), weights.begin(), weights.end());
+    }
+    idwOffsets.push_back(static_cast<int>(idwCellIdxs.size()));
+  }
+} // XmCellToPointOperator::Build
+//------------------------------------------------------------------------------
+/// \brief Remove the operator and free its memory.
+//------------------------------------------------------------------------------
+void XmCellToPointOperator::Clear()
+{
+  *this = XmCellToPointOperator();
+} // XmCellToPointOperator::Clear
+//------------------------------------------------------------------------------
+/// \brief Check whether the operator has been built for an averaging mode.
+/// \param[in] a_useIdw Whether IDW is used.
+/// \return True if built for the mode.
+//------------------------------------------------------------------------------
+bool XmCellToPointOperator::IsBuilt(bool a_useIdw) const
+{
+  return !offsets.empty() && useIdw == a_useIdw;
+} // XmCellToPointOperator::IsBuilt
+//------------------------------------------------------------------------------
+/// \brief Calculate point scalars for a range of UGrid points.
+/// \param[in] a_cellScalars The cell scalars.
+/// \param[in] a_numCellScalars The number of cell scalars.
+/// \param[in] a_cellActivity The cell activity. Empty for all active.
+/// \param[in] a_noDataValue The value for points without active cells.
+/// \param[in] a_begin The first point.
+/// \param[in] a_end One past the last point.
+/// \param[out] a_pointScalars The point scalars indexed by point.
+//------------------------------------------------------------------------------
+void XmCellToPointOperator::Apply(const float* a_cellScalars,
+                                  size_t a_numCellScalars,
+                                  const DynBitset& a_cellActivity,
+                                  float a_noDataValue,
+                                  size_t a_begin,
+                                  size_t a_end,
+                                  float* a_pointScalars) const
+{
+  VecInt activeCells;
+  VecDbl d2;
+  VecDbl weights;
+  for (size_t pointIdx = a_begin; pointIdx < a_end; ++pointIdx)
+  {
+    a_pointScalars[pointIdx] = ApplyAtPoint(static_cast<int>(pointIdx), a_cellScalars,
+                                            a_numCellScalars, a_cellActivity, a_noDataValue,
+                                            activeCells, d2, weights);
+  }
+} // XmCellToPointOperator::Apply
+//------------------------------------------------------------------------------
+/// \brief Calculate the scalar for a UGrid point. Inactive cells are skipped.
+///        Sums are accumulated in adjacency order so values match calculating
+///        them from the UGrid directly.
+/// \param[in] a_pointIdx The point.
+/// \param[in] a_cellScalars The cell scalars.
+/// \param[in] a_numCellScalars The number of cell scalars.
+/// \param[in] a_cellActivity The cell activity. Empty for all active.
+/// \param[in] a_noDataValue The value for a point without active cells.
+/// \param[out] a_activeCells Storage for the cells of active centroids.
+/// \param[out] a_d2 Storage for squared distances to active centroids.
+/// \param[out] a_weights Storage for IDW weights of active centroids.
+/// \return The point scalar.
+//------------------------------------------------------------------------------
+float XmCellToPointOperator::ApplyAtPoint(int a_pointIdx,
+                                          const float* a_cellScalars,
+                                          size_t a_numCellScalars,
+                                          const DynBitset& a_cellActivity,
+                                          float a_noDataValue,
+                                          VecInt& a_activeCells,
+                                          VecDbl& a_d2,
+                                          VecDbl& a_weights) const
+{
+  bool allActive = a_cellActivity.empty();
+  if (useIdw)
+  {
+    int begin = idwOffsets[a_pointIdx];
+    int end = idwOffsets[a_pointIdx + 1];
+    const int* cells = idwCellIdxs.data() + begin;
+    const double* weights = idwWeights.data() + begin;
+    int numActive = end - begin;
+    if (!allActive)
+    {
+      a_activeCells.clear();
+      a_d2.clear();
+      for (int i = begin; i < end; ++i)
+      {
+        size_t cellIdx = idwCellIdxs[i];
+        if (cellIdx >= a_cellActivity.size() || a_cellActivity[cellIdx])
+        {
+          a_activeCells.push_back(idwCellIdxs[i]);
+          a_d2.push_back(idwDistances2[i]);
+        }
+      }
+      numActive = static_cast<int>(a_d2.size());
+      if (numActive != end - begin && numActive > 0)
+      {
+        inIdwWeights(a_d2, 2, false, a_weights);
+        cells = a_activeCells.data();
+        weights = a_weights.data();
+      }
+    }
+    if (numActive > 0)
+    {
+      double interpValue = 0.0;
+      for (int i = 0; i < numActive; ++i)
+      {
+        size_t cellIdx = cells[i];
+        interpValue += (cellIdx >= a_numCellScalars ? 0.0 : a_cellScalars[cellIdx]) * weights[i];
+      }
+      return static_cast<float>(interpValue);
+    }
+  }
+
+  int begin = offsets[a_pointIdx];
+  int end = offsets[a_pointIdx + 1];
+  double sum = 0.0;
+  int sumCount = 0;
+  if (allActive)
+  {
+    for (int i = begin; i < end; ++i)
+    {
+      size_t cellIdx = cellIdxs[i];
+      sum += cellIdx >= a_numCellScalars ? 0.0 : a_cellScalars[cellIdx];
+    }
+    sumCount = end - begin;
+  }
+  else
+  {
+    for (int i = begin; i < end; ++i)
+    {
+      size_t cellIdx = cellIdxs[i];
+      if (cellIdx >= a_cellActivity.size() || a_cellActivity[cellIdx])
+      {
+        sum += cellIdx >= a_numCellScalars ? 0.0 : a_cellScalars[cellIdx];
+        ++sumCount;
+      }
+    }
+  }
+  double average;
+  if (sumCount)
+    average = sum / sumCount;
+  else
+    average = a_noDataValue;
+  return static_cast<float>(average);
+} // XmCellToPointOperator::ApplyAtPoint
+
+} // namespace xms
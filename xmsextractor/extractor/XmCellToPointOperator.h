@@ -0,0 +1,70 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Contains the XmCellToPointOperator struct used to calculate UGrid
+///        point scalars from cell scalars.
+/// \ingroup extractor
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/misc/DynBitset.h>
+#include <xmscore/stl/vector.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+/// XMS Namespace
+namespace xms
+{
+//----- Forward declarations ---------------------------------------------------
+class XmUGrid;
+class XmUGridTriangles2d;
+
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////
+struct XmCellToPointOperator
+{
+  XmCellToPointOperator();
+
+  void Build(const XmUGrid& a_ugrid, const XmUGridTriangles2d& a_triangles, bool a_useIdw);
+  void Clear();
+  bool IsBuilt(bool a_useIdw) const;
+  void Apply(const float* a_cellScalars,
+             size_t a_numCellScalars,
+             const DynBitset& a_cellActivity,
+             float a_noDataValue,
+             size_t a_begin,
+             size_t a_end,
+             float* a_pointScalars) const;
+  float ApplyAtPoint(int a_pointIdx,
+                     const float* a_cellScalars,
+                     size_t a_numCellScalars,
+                     const DynBitset& a_cellActivity,
+                     float a_noDataValue,
+                     VecInt& a_activeCells,
+                     VecDbl& a_d2,
+                     VecDbl& a_weights) const;
+
+  bool useIdw;           ///< whether IDW weights were built
+  VecInt offsets;        ///< start of each point's cells (number of points + 1)
+  VecInt cellIdxs;       ///< cells adjacent to each point
+  VecInt idwOffsets;     ///< start of each point's IDW cells (number of points + 1)
+  VecInt idwCellIdxs;    ///< cells with a centroid adjacent to each point
+  VecDbl idwDistances2;  ///< squared distance from the point to each centroid
+  VecDbl idwWeights;     ///< IDW weight of each centroid when all are active
+};
+
+//----- Function prototypes ----------------------------------------------------
+
+} // namespace xms
@@ -0,0 +1,163 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup extractor
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsextractor/extractor/XmInterpStencils.h>
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/misc/XmError.h>
+
+// 6. Non-shared code headers
+#include <xmsextractor/extractor/XmScalarSource.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+/// XMS Namespace
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Interpolate scalars for a range of locations.
+/// \param[in] a_stencils The stencils.
+/// \param[in] a_scalars The triangle point scalars (anything indexable).
+/// \param[in] a_noDataValue The value for locations outside the UGrid.
+/// \param[in] a_begin The first location.
+/// \param[in] a_end One past the last location.
+/// \param[out] a_outData The interpolated values indexed by location.
+//------------------------------------------------------------------------------
+template <typename Scalars>
+void iGather(const XmInterpStencils& a_stencils,
+             const Scalars& a_scalars,
+             float a_noDataValue,
+             size_t a_begin,
+             size_t a_end,
+             float* a_outData)
+{
+  for (size_t i = a_begin; i < a_end; ++i)
+  {
+    if (a_stencils.cellIdxs[i] >= 0)
+    {
+      double interpValue = 0.0;
+      interpValue += a_scalars[a_stencils.idx0[i]] * a_stencils.weight0[i];
+      interpValue += a_scalars[a_stencils.idx1[i]] * a_stencils.weight1[i];
+      interpValue += a_scalars[a_stencils.idx2[i]] * a_stencils.weight2[i];
+      a_outData[i] = static_cast<float>(interpValue);
+    }
+    else
+    {
+      a_outData[i] = a_noDataValue;
+    }
+  }
+} // iGather
+
+} // namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmInterpStencils
+/// \brief Interpolation triangle points, weights and cell for a set of extract
+///        locations stored as parallel arrays. Allows values to be extracted
+///        repeatedly at the same locations without searching for the triangle
+///        containing each location.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Resize the stencils. New locations are outside of the UGrid.
+/// \param[in] a_size The number of locations.
+//------------------------------------------------------------------------------
+void XmInterpStencils::Resize(size_t a_size)
+{
+  idx0.resize(a_size, 0);
+  idx1.resize(a_size, 0);
+  idx2.resize(a_size, 0);
+  weight0.resize(a_size, 0.0);
+  weight1.resize(a_size, 0.0);
+  weight2.resize(a_size, 0.0);
+  cellIdxs.resize(a_size, -1);
+} // XmInterpStencils::Resize
+//------------------------------------------------------------------------------
+/// \brief Remove all locations and free their memory.
+//------------------------------------------------------------------------------
+void XmInterpStencils::Clear()
+{
+  *this = XmInterpStencils();
+} // XmInterpStencils::Clear
+//------------------------------------------------------------------------------
+/// \brief Get the number of locations.
+/// \return The number of locations.
+//------------------------------------------------------------------------------
+size_t XmInterpStencils::Size() const
+{
+  return cellIdxs.size();
+} // XmInterpStencils::Size
+//------------------------------------------------------------------------------
+/// \brief Set the stencil for a location.
+/// \param[in] a_locationIdx The location index.
+/// \param[in] a_cellIdx The cell containing the location or -1 if outside.
+/// \param[in] a_idxs The three triangle points used to interpolate.
+/// \param[in] a_weights The weights of the three triangle points.
+//------------------------------------------------------------------------------
+void XmInterpStencils::Set(size_t a_locationIdx,
+                           int a_cellIdx,
+                           const VecInt& a_idxs,
+                           const VecDbl& a_weights)
+{
+  cellIdxs[a_locationIdx] = a_cellIdx;
+  if (a_cellIdx < 0)
+    return;
+
+  XM_ASSERT(a_idxs.size() == 3 && a_weights.size() == 3);
+  idx0[a_locationIdx] = a_idxs[0];
+  idx1[a_locationIdx] = a_idxs[1];
+  idx2[a_locationIdx] = a_idxs[2];
+  weight0[a_locationIdx] = a_weights[0];
+  weight1[a_locationIdx] = a_weights[1];
+  weight2[a_locationIdx] = a_weights[2];
+} // XmInterpStencils::Set
+//------------------------------------------------------------------------------
+/// \brief Interpolate scalars for a range of locations. The weighted sum is
+///        accumulated in the same order as XmUGrid2dDataExtractor so values
+///        match those from searching for each location. When there are no
+///        overlay scalars the source values are read directly.
+/// \param[in] a_scalars The triangle point scalars.
+/// \param[in] a_noDataValue The value for locations outside the UGrid.
+/// \param[in] a_begin The first location.
+/// \param[in] a_end One past the last location.
+/// \param[out] a_outData The interpolated values indexed by location.
+//------------------------------------------------------------------------------
+void XmInterpStencils::Gather(const XmScalarSource& a_scalars,
+                              float a_noDataValue,
+                              size_t a_begin,
+                              size_t a_end,
+                              float* a_outData) const
+{
+  if (a_scalars.GetOverlay().empty())
+    iGather(*this, a_scalars.GetValues(), a_noDataValue, a_begin, a_end, a_outData);
+  else
+    iGather(*this, a_scalars, a_noDataValue, a_begin, a_end, a_outData);
+} // XmInterpStencils::Gather
+
+} // namespace xms
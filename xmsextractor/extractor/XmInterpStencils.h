@@ -0,0 +1,57 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Contains the XmInterpStencils struct used to store the interpolation
+///        points and weights for a set of extract locations.
+/// \ingroup extractor
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/stl/vector.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+/// XMS Namespace
+namespace xms
+{
+//----- Forward declarations ---------------------------------------------------
+class XmScalarSource;
+
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////
+struct XmInterpStencils
+{
+  void Resize(size_t a_size);
+  void Clear();
+  size_t Size() const;
+  void Set(size_t a_locationIdx, int a_cellIdx, const VecInt& a_idxs, const VecDbl& a_weights);
+  void Gather(const XmScalarSource& a_scalars,
+              float a_noDataValue,
+              size_t a_begin,
+              size_t a_end,
+              float* a_outData) const;
+
+  VecInt idx0;     ///< first triangle point index for each location
+  VecInt idx1;     ///< second triangle point index for each location
+  VecInt idx2;     ///< third triangle point index for each location
+  VecDbl weight0;  ///< interpolation weight of the first point
+  VecDbl weight1;  ///< interpolation weight of the second point
+  VecDbl weight2;  ///< interpolation weight of the third point
+  VecInt cellIdxs; ///< UGrid cell index for each location or -1 if outside
+};
+
+//----- Function prototypes ----------------------------------------------------
+
+} // namespace xms
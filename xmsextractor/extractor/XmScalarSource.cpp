@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup extractor
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsextractor/extractor/XmScalarSource.h>
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+/// XMS Namespace
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmScalarSource
+/// \brief Scalars at the triangle points. The source values at the start are
+///        either owned here or read in place from memory owned by the caller,
+///        such as a memory mapped dataset file. Values derived for points
+///        added to the triangles (like centroids) are kept in a small overlay
+///        after the source values.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Constructor.
+//------------------------------------------------------------------------------
+XmScalarSource::XmScalarSource()
+: m_values(nullptr)
+, m_numValues(0)
+, m_ownedValues()
+, m_overlay()
+{
+} // XmScalarSource::XmScalarSource
+//------------------------------------------------------------------------------
+/// \brief Copy the source values. Clears the overlay.
+/// \param[in] a_values The values.
+//------------------------------------------------------------------------------
+void XmScalarSource::Assign(const VecFlt& a_values)
+{
+  m_ownedValues = a_values;
+  m_values = m_ownedValues.empty() ? nullptr : &m_ownedValues[0];
+  m_numValues = m_ownedValues.size();
+  m_overlay.clear();
+} // XmScalarSource::Assign
+//------------------------------------------------------------------------------
+/// \brief Read source values in place without copying them. Clears the
+///        overlay.
+/// \param[in] a_values The values, which must stay valid and unchanged while
+///            they are used.
+/// \param[in] a_numValues The number of values.
+//------------------------------------------------------------------------------
+void XmScalarSource::Refer(const float* a_values, size_t a_numValues)
+{
+  m_ownedValues.clear();
+  m_values = a_numValues ? a_values : nullptr;
+  m_numValues = a_numValues;
+  m_overlay.clear();
+} // XmScalarSource::Refer
+//------------------------------------------------------------------------------
+/// \brief Size owned source values to be filled in by the caller. Existing
+///        owned memory is reused. Clears the overlay.
+/// \param[in] a_numValues The number of values.
+/// \return The owned values.
+//------------------------------------------------------------------------------
+VecFlt& XmScalarSource::Allocate(size_t a_numValues)
+{
+  if (m_ownedValues.empty() || m_values != &m_ownedValues[0])
+    m_ownedValues.clear();
+  m_ownedValues.resize(a_numValues);
+  m_values = m_ownedValues.empty() ? nullptr : &m_ownedValues[0];
+  m_numValues = a_numValues;
+  m_overlay.clear();
+  return m_ownedValues;
+} // XmScalarSource::Allocate
+//------------------------------------------------------------------------------
+/// \brief Copy source values read in place so they no longer depend on the
+///        caller's memory.
+//------------------------------------------------------------------------------
+void XmScalarSource::MakeOwned()
+{
+  if (!m_values || (!m_ownedValues.empty() && m_values == &m_ownedValues[0]))
+    return;
+  m_ownedValues.assign(m_values, m_values + m_numValues);
+  m_values = &m_ownedValues[0];
+} // XmScalarSource::MakeOwned
+//------------------------------------------------------------------------------
+/// \brief Take over the vector the source values are read from in place.
+///        Its memory moves with it, so nothing is copied. Values read from
+///        other memory are copied.
+/// \param[in] a_values The vector the source values were referred to in.
+//------------------------------------------------------------------------------
+void XmScalarSource::MakeOwned(VecFlt&& a_values)
+{
+  if (!m_values || a_values.empty() || m_values != &a_values[0])
+  {
+    MakeOwned();
+    return;
+  }
+  m_ownedValues = std::move(a_values);
+} // XmScalarSource::MakeOwned
+//------------------------------------------------------------------------------
+/// \brief Remove all values.
+//------------------------------------------------------------------------------
+void XmScalarSource::Clear()
+{
+  m_values = nullptr;
+  m_numValues = 0;
+  m_ownedValues.clear();
+  m_overlay.clear();
+} // XmScalarSource::Clear
+//------------------------------------------------------------------------------
+/// \brief Size the overlay so there are a_size values in total and set every
+///        overlay value.
+/// \param[in] a_size The total number of values.
+/// \param[in] a_value The value for the overlay.
+//------------------------------------------------------------------------------
+void XmScalarSource::ResizeOverlay(size_t a_size, float a_value)
+{
+  m_overlay.assign(a_size > m_numValues ? a_size - m_numValues : 0, a_value);
+} // XmScalarSource::ResizeOverlay
+//------------------------------------------------------------------------------
+/// \brief Set an overlay value.
+/// \param[in] a_idx The index of the value, counting the source values.
+/// \param[in] a_value The value.
+//------------------------------------------------------------------------------
+void XmScalarSource::SetOverlay(size_t a_idx, float a_value)
+{
+  m_overlay[a_idx - m_numValues] = a_value;
+} // XmScalarSource::SetOverlay
+//------------------------------------------------------------------------------
+/// \brief Set a source or overlay value. Source values read in place are
+///        copied first so the caller's memory isn't changed.
+/// \param[in] a_idx The index of the value (less than Size()).
+/// \param[in] a_value The value.
+//------------------------------------------------------------------------------
+void XmScalarSource::SetValue(size_t a_idx, float a_value)
+{
+  if (a_idx >= m_numValues)
+  {
+    SetOverlay(a_idx, a_value);
+    return;
+  }
+  MakeOwned();
+  m_ownedValues[a_idx] = a_value;
+} // XmScalarSource::SetValue
+//------------------------------------------------------------------------------
+/// \brief Copy the source and overlay values into a vector.
+/// \param[out] a_values The values.
+//------------------------------------------------------------------------------
+void XmScalarSource::CopyTo(VecFlt& a_values) const
+{
+  a_values.assign(m_values, m_values + m_numValues);
+  a_values.insert(a_values.end(), m_overlay.begin(), m_overlay.end());
+} // XmScalarSource::CopyTo
+
+} // namespace xms
@@ -0,0 +1,82 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Contains the XmScalarSource class used to store the scalars at the
+///        triangle points without copying scalars owned by the caller.
+/// \ingroup extractor
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/misc/base_macros.h>
+#include <xmscore/stl/vector.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+/// XMS Namespace
+namespace xms
+{
+//----- Forward declarations ---------------------------------------------------
+
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////
+class XmScalarSource
+{
+public:
+  XmScalarSource();
+
+  void Assign(const VecFlt& a_values);
+  void Refer(const float* a_values, size_t a_numValues);
+  VecFlt& Allocate(size_t a_numValues);
+  void MakeOwned();
+  void MakeOwned(VecFlt&& a_values);
+  void Clear();
+
+  void ResizeOverlay(size_t a_size, float a_value);
+  void SetOverlay(size_t a_idx, float a_value);
+  void SetValue(size_t a_idx, float a_value);
+  void CopyTo(VecFlt& a_values) const;
+
+  /// \brief Get the source values, which come before the overlay values.
+  /// \return The first source value.
+  const float* GetValues() const { return m_values; }
+  /// \brief Get the number of source values.
+  /// \return The number of source values.
+  size_t GetNumValues() const { return m_numValues; }
+  /// \brief Get the values after the source values.
+  /// \return The overlay values.
+  const VecFlt& GetOverlay() const { return m_overlay; }
+  /// \brief Get the total number of values.
+  /// \return The number of source and overlay values.
+  size_t Size() const { return m_numValues + m_overlay.size(); }
+  /// \brief Get a value.
+  /// \param[in] a_idx The index of the value (less than Size()).
+  /// \return The value.
+  float operator[](size_t a_idx) const
+  {
+    return a_idx < m_numValues ? m_values[a_idx] : m_overlay[a_idx - m_numValues];
+  }
+
+private:
+  XM_DISALLOW_COPY_AND_ASSIGN(XmScalarSource)
+
+  const float* m_values; ///< source values owned here or by the caller
+  size_t m_numValues;    ///< number of source values
+  VecFlt m_ownedValues;  ///< source values when owned here
+  VecFlt m_overlay;      ///< derived values after the source values
+};
+
+//----- Function prototypes ----------------------------------------------------
+
+} // namespace xms
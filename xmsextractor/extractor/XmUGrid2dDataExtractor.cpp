@@ -13,6 +13,7 @@
 #include <xmsextractor/extractor/XmUGrid2dDataExtractor.h>
 
 // 3. Standard library headers
+#include <algorithm>
 #include <sstream>
 #include <stdexcept>
 
@@ -22,6 +23,7 @@
 #include <xmscore/misc/XmError.h>
 #include <xmscore/misc/XmLog.h>
 #include <xmscore/misc/xmstype.h>
+#include <xmsextractor/misc/XmParallel.h>
 #include <xmsextractor/ugrid/XmUGridTriangles2d.h>
 #include <xmsgrid/ugrid/XmUGrid.h>
 #include <xmsgrid/geometry/geoms.h>
@@ -29,6 +31,9 @@
 #include <xmsinterp/interpolate/InterpUtil.h>
 
 // 6. Non-shared code headers
+#include <xmsextractor/extractor/XmCellToPointOperator.h>
+#include <xmsextractor/extractor/XmInterpStencils.h>
+#include <xmsextractor/extractor/XmScalarSource.h>
 #include <xmsextractor/extractor/XmUGrid2dPolylineDataExtractor.h>
 
 //----- Forward declarations ---------------------------------------------------
@@ -42,6 +47,14 @@ namespace xms
 {
 //----- Constants / Enumerations -----------------------------------------------
 
+namespace
+{
+/// Smallest number of locations given to an extraction thread.
+const size_t MIN_LOCATIONS_PER_THREAD = 256;
+/// Smallest number of UGrid points given to a cell to point thread.
+const size_t MIN_POINTS_PER_THREAD = 1024;
+} // namespace
+
 //----- Classes / Structs ------------------------------------------------------
 
 //----- Internal functions -----------------------------------------------------
@@ -59,23 +72,46 @@ public:
   virtual void SetGridPointScalars(const VecFlt& a_pointScalars,
                                    const DynBitset& a_activity,
                                    DataLocationEnum a_activityLocation) override;
+  virtual void SetGridPointScalars(VecFlt&& a_pointScalars,
+                                   const DynBitset& a_activity,
+                                   DataLocationEnum a_activityLocation) override;
   virtual void SetGridCellScalars(const VecFlt& a_cellScalars,
                                   const DynBitset& a_activity,
                                   DataLocationEnum a_activityLocation) override;
+  virtual void SetGridPointScalars(const float* a_pointScalars,
+                                   size_t a_numScalars,
+                                   const DynBitset& a_activity,
+                                   DataLocationEnum a_activityLocation) override;
+  virtual void SetGridCellScalars(const float* a_cellScalars,
+                                  size_t a_numScalars,
+                                  const DynBitset& a_activity,
+                                  DataLocationEnum a_activityLocation) override;
+  virtual void UpdateGridActivity(const VecInt& a_changedIdxs,
+                                  const DynBitset& a_activity,
+                                  DataLocationEnum a_activityLocation) override;
+  virtual void UpdateGridScalars(const VecInt& a_idxs, const VecFlt& a_values) override;
 
   virtual void SetExtractLocations(const VecPt3d& a_locations) override;
+  virtual void SetExtractLocations(const VecPt3d& a_locations,
+                                   const VecInt& a_triangleIdxs) override;
   virtual void ExtractData(VecFlt& a_outData) override;
-  virtual float ExtractAtLocation(const Pt3d& a_location) override;
+  virtual float ExtractAtLocation(const Pt3d& a_location) const override;
+  virtual void ExtractTimesteps(const VecFlt& a_scalars,
+                                DataLocationEnum a_scalarLocation,
+                                const std::vector<DynBitset>& a_activity,
+                                DataLocationEnum a_activityLocation,
+                                VecFlt& a_outData) override;
 
   virtual void SetUseIdwForPointData(bool a_) override;
   virtual void SetNoDataValue(float a_value) override;
+  virtual void SetThreadCount(int a_numThreads) override;
+  virtual void SetUsePreparedLocations(bool a_usePrepared) override;
+  virtual void SetTrianglesCacheFile(const std::string& a_fileName) override;
 
   virtual void BuildTriangles(DataLocationEnum a_location) override;
   virtual const BSHP<XmUGridTriangles2d> GetUGridTriangles() const override;
 
-  /// \brief Gets the scalars
-  /// \return The scalars.
-  virtual const VecFlt& GetScalars() const override { return m_pointScalars; }
+  virtual VecFlt GetScalars() const override;
   /// \brief Gets the location of the scalars (points or cells)
   /// \return The location of the scalars.
   virtual DataLocationEnum GetScalarLocation() const override { return m_triangleType; }
@@ -91,32 +127,70 @@ public:
   /// \brief Gets the no data value
   /// \return The no data value.
   virtual float GetNoDataValue() const override { return m_noDataValue; }
+  /// \brief Gets the number of threads used to extract data.
+  /// \return The thread count.
+  virtual int GetThreadCount() const override { return m_numThreads; }
+  /// \brief Gets the option for using prepared locations.
+  /// \return The option.
+  virtual bool GetUsePreparedLocations() const override { return m_usePreparedLocations; }
+  /// \brief Gets the file used to keep the triangles in between runs.
+  /// \return The file name or empty if not used.
+  virtual const std::string& GetTrianglesCacheFile() const override
+  {
+    return m_trianglesCacheFile;
+  }
 
 private:
+  void ExtractRange(size_t a_begin, size_t a_end, VecFlt& a_outData);
+  void ExtractStencilRange(const XmInterpStencils& a_stencils,
+                           const DynBitset& a_cellActivity,
+                           size_t a_begin,
+                           size_t a_end,
+                           float* a_outData,
+                           VecInt* a_cellIdxs);
+  float InterpolateValue(const VecInt& a_idxs, const VecDbl& a_weights) const;
+  void PrepareLocations();
+  void LocateAll(const DynBitset& a_cellActivity, XmInterpStencils& a_stencils);
+  void RelocateChangedCells(const VecInt& a_changedCells);
+  void LocateRange(const DynBitset& a_cellActivity,
+                   XmInterpStencils& a_stencils,
+                   size_t a_begin,
+                   size_t a_end);
+  void UpdateCellActivity(const DynBitset& a_cellActivity);
   void ApplyActivity(const DynBitset& a_activity,
                      DataLocationEnum a_location,
                      DynBitset& a_cellActivity);
   void SetGridPointActivity(const DynBitset& a_pointActivity, DynBitset& a_cellActivity);
   void SetGridCellActivity(const DynBitset& a_cellActivity);
+  void SetCellActive(int a_cellIdx, bool a_active, VecInt& a_changedCells);
+  void UpdateDerivedScalars(const VecInt& a_changedCells);
+  float AverageCellPoints(int a_cellIdx, VecInt& a_cellPoints) const;
   void PushPointDataToCentroids(const DynBitset& a_cellActivity);
-  void PushCellDataToTrianglePoints(const VecFlt& a_cellScalars, const DynBitset& a_cellActivity);
-  float CalculatePointByAverage(const VecInt& a_cellIdxs,
-                                const VecFlt& a_cellScalars,
-                                const DynBitset& a_cellActivity);
-  float CalculatePointByIdw(int a_pointIdx,
-                            const VecInt& a_cellIdxs,
-                            const VecFlt& a_cellScalars,
-                            const DynBitset& a_cellActivity);
+  void PushCellDataToTrianglePoints(const float* a_cellScalars,
+                                    size_t a_numCellScalars,
+                                    const DynBitset& a_cellActivity);
+  void GatherCellScalars();
+  void BuildCellToPointOperator();
 
   std::shared_ptr<XmUGrid> m_ugrid; ///< UGrid for dataset
   DataLocationEnum m_triangleType;  ///< if triangles been generated for points or cells
   BSHP<XmUGridTriangles2d>
     m_triangles;              ///< triangles generated from UGrid to use for data extraction
   VecPt3d m_extractLocations; ///< output locations for interpolated values
-  VecFlt m_pointScalars;      ///< scalars to interpolate from
+  VecInt m_extractTriangleIdxs; ///< triangle expected to contain each location
+  XmScalarSource m_scalars;   ///< triangle point scalars to interpolate from
   VecInt m_cellIdxs;          ///< ugrid cell indexes
   bool m_useIdwForPointData;  ///< use IDW to calculate point data from cell data
   float m_noDataValue;        ///< value to use for inactive result
+  int m_numThreads;           ///< number of threads used to extract data
+  bool m_usePreparedLocations; ///< reuse interpolation stencils between extractions
+  bool m_stencilsValid;        ///< are the stencils current for the locations
+  XmInterpStencils m_stencils; ///< interpolation stencils for the extract locations
+  DynBitset m_cellActivity;    ///< cell activity of the scalars
+  VecFlt m_cellScalars;        ///< cell scalars gathered when an update needs them
+  VecFlt m_noCentroidScalars;  ///< scalars of cells without a centroid in cell order
+  BSHP<const XmCellToPointOperator> m_cellToPoint; ///< cell to point scalars, from triangles
+  std::string m_trianglesCacheFile; ///< file to read and write triangles
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -133,10 +207,20 @@ XmUGrid2dDataExtractorImpl::XmUGrid2dDataExtractorImpl(std::shared_ptr<XmUGrid>
 , m_triangleType(LOC_UNKNOWN)
 , m_triangles(XmUGridTriangles2d::New())
 , m_extractLocations()
-, m_pointScalars()
+, m_extractTriangleIdxs()
+, m_scalars()
 , m_cellIdxs()
 , m_useIdwForPointData(false)
 , m_noDataValue(XM_NODATA)
+, m_numThreads(1)
+, m_usePreparedLocations(false)
+, m_stencilsValid(false)
+, m_stencils()
+, m_cellActivity()
+, m_cellScalars()
+, m_noCentroidScalars()
+, m_cellToPoint()
+, m_trianglesCacheFile()
 {
 } // XmUGrid2dDataExtractorImpl::XmUGrid2dDataExtractorImpl
 //------------------------------------------------------------------------------
@@ -150,10 +234,20 @@ XmUGrid2dDataExtractorImpl::XmUGrid2dDataExtractorImpl(BSHP<XmUGrid2dDataExtract
 , m_triangleType(a_extractor->m_triangleType)
 , m_triangles(a_extractor->m_triangles)
 , m_extractLocations()
-, m_pointScalars()
+, m_extractTriangleIdxs()
+, m_scalars()
 , m_cellIdxs()
 , m_useIdwForPointData(a_extractor->m_useIdwForPointData)
 , m_noDataValue(a_extractor->m_noDataValue)
+, m_numThreads(a_extractor->m_numThreads)
+, m_usePreparedLocations(a_extractor->m_usePreparedLocations)
+, m_stencilsValid(false)
+, m_stencils()
+, m_cellActivity()
+, m_cellScalars()
+, m_noCentroidScalars()
+, m_cellToPoint(a_extractor->m_cellToPoint)
+, m_trianglesCacheFile(a_extractor->m_trianglesCacheFile)
 {
 } // XmUGrid2dDataExtractorImpl::XmUGrid2dDataExtractorImpl
 //------------------------------------------------------------------------------
@@ -167,7 +261,53 @@ void XmUGrid2dDataExtractorImpl::SetGridPointScalars(const VecFlt& a_pointScalar
                                                      const DynBitset& a_activity,
                                                      DataLocationEnum a_activityLocation)
 {
-  if (a_pointScalars.size() != m_ugrid->GetPointCount())
+  SetGridPointScalars(a_pointScalars.data(), a_pointScalars.size(), a_activity,
+                      a_activityLocation);
+  m_scalars.MakeOwned();
+} // XmUGrid2dDataExtractorImpl::SetGridPointScalars
+//------------------------------------------------------------------------------
+/// \brief Setup point scalars taking over the vector instead of copying it.
+/// \param[in] a_pointScalars The point scalars.
+/// \param[in] a_activity The activity of the cells.
+/// \param[in] a_activityLocation The location at which the data is currently
+///            stored.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::SetGridPointScalars(VecFlt&& a_pointScalars,
+                                                     const DynBitset& a_activity,
+                                                     DataLocationEnum a_activityLocation)
+{
+  SetGridPointScalars(a_pointScalars.data(), a_pointScalars.size(), a_activity,
+                      a_activityLocation);
+  m_scalars.MakeOwned(std::move(a_pointScalars));
+} // XmUGrid2dDataExtractorImpl::SetGridPointScalars
+//------------------------------------------------------------------------------
+/// \brief Setup cell scalars to be used to extract interpolated data.
+/// \param[in] a_cellScalars The point scalars.
+/// \param[in] a_activity The activity of the cells.
+/// \param[in] a_activityLocation The location at which the data is currently
+///            stored.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::SetGridCellScalars(const VecFlt& a_cellScalars,
+                                                    const DynBitset& a_activity,
+                                                    DataLocationEnum a_activityLocation)
+{
+  SetGridCellScalars(a_cellScalars.data(), a_cellScalars.size(), a_activity, a_activityLocation);
+} // XmUGrid2dDataExtractorImpl::SetGridCellScalars
+//------------------------------------------------------------------------------
+/// \brief Setup point scalars that are read in place rather than copied.
+/// \param[in] a_pointScalars The point scalars. They must stay valid and
+///            unchanged until other scalars are set.
+/// \param[in] a_numScalars The number of point scalars.
+/// \param[in] a_activity The activity of the cells.
+/// \param[in] a_activityLocation The location at which the data is currently
+///            stored.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::SetGridPointScalars(const float* a_pointScalars,
+                                                     size_t a_numScalars,
+                                                     const DynBitset& a_activity,
+                                                     DataLocationEnum a_activityLocation)
+{
+  if (a_numScalars != m_ugrid->GetPointCount())
   {
     throw std::invalid_argument("Invalid point scalar size in 2D data extractor.");
   }
@@ -176,22 +316,27 @@ void XmUGrid2dDataExtractorImpl::SetGridPointScalars(const VecFlt& a_pointScalar
 
   DynBitset cellActivity;
   ApplyActivity(a_activity, a_activityLocation, cellActivity);
+  UpdateCellActivity(cellActivity);
 
-  m_pointScalars = a_pointScalars;
+  m_scalars.Refer(a_pointScalars, a_numScalars);
+  m_cellScalars.clear();
+  m_noCentroidScalars.clear();
   PushPointDataToCentroids(cellActivity);
 } // XmUGrid2dDataExtractorImpl::SetGridPointScalars
 //------------------------------------------------------------------------------
-/// \brief Setup cell scalars to be used to extract interpolated data.
-/// \param[in] a_cellScalars The point scalars.
+/// \brief Setup cell scalars without copying them into a vector.
+/// \param[in] a_cellScalars The cell scalars.
+/// \param[in] a_numScalars The number of cell scalars.
 /// \param[in] a_activity The activity of the cells.
 /// \param[in] a_activityLocation The location at which the data is currently
 ///            stored.
 //------------------------------------------------------------------------------
-void XmUGrid2dDataExtractorImpl::SetGridCellScalars(const VecFlt& a_cellScalars,
+void XmUGrid2dDataExtractorImpl::SetGridCellScalars(const float* a_cellScalars,
+                                                    size_t a_numScalars,
                                                     const DynBitset& a_activity,
                                                     DataLocationEnum a_activityLocation)
 {
-  if ((int)a_cellScalars.size() != m_ugrid->GetCellCount())
+  if ((int)a_numScalars != m_ugrid->GetCellCount())
   {
     throw std::invalid_argument("Invalid cell scalar size in 2D data extractor.");
   }
@@ -200,16 +345,164 @@ void XmUGrid2dDataExtractorImpl::SetGridCellScalars(const VecFlt& a_cellScalars,
 
   DynBitset cellActivity;
   ApplyActivity(a_activity, a_activityLocation, cellActivity);
+  UpdateCellActivity(cellActivity);
 
-  PushCellDataToTrianglePoints(a_cellScalars, cellActivity);
+  PushCellDataToTrianglePoints(a_cellScalars, a_numScalars, cellActivity);
 } // XmUGrid2dDataExtractorImpl::SetGridCellScalars
 //------------------------------------------------------------------------------
+/// \brief Change the activity of a few cells or points without setting the
+///        scalars again. Only the cells touching the changed ids and the
+///        scalars derived from them are updated.
+/// \param[in] a_changedIdxs The cells or points whose activity changed.
+/// \param[in] a_activity The new activity of every cell or point. Empty for
+///            all active.
+/// \param[in] a_activityLocation The location of the activity (points or
+///            cells).
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::UpdateGridActivity(const VecInt& a_changedIdxs,
+                                                    const DynBitset& a_activity,
+                                                    DataLocationEnum a_activityLocation)
+{
+  VecInt changedCells;
+  if (a_activityLocation == LOC_POINTS)
+  {
+    int numPoints = m_ugrid->GetPointCount();
+    if (a_activity.size() != numPoints && !a_activity.empty())
+    {
+      throw std::invalid_argument("Invalid point activity size in 2D data extractor.");
+    }
+
+    // a cell is active when all of its points are active
+    VecInt attachedCells;
+    VecInt cellPoints;
+    for (auto pointIdx : a_changedIdxs)
+    {
+      if (pointIdx < 0 || pointIdx >= numPoints)
+      {
+        throw std::invalid_argument("Invalid point index in 2D data extractor.");
+      }
+      m_ugrid->GetPointAdjacentCells(pointIdx, attachedCells);
+      for (auto cellIdx : attachedCells)
+      {
+        bool active = true;
+        if (!a_activity.empty())
+        {
+          m_ugrid->GetCellPoints(cellIdx, cellPoints);
+          for (size_t i = 0; active && i < cellPoints.size(); ++i)
+            active = a_activity[cellPoints[i]];
+        }
+        SetCellActive(cellIdx, active, changedCells);
+      }
+    }
+  }
+  else if (a_activityLocation == LOC_CELLS)
+  {
+    SetGridCellActivity(a_activity);
+    int numCells = m_ugrid->GetCellCount();
+    for (auto cellIdx : a_changedIdxs)
+    {
+      if (cellIdx < 0 || cellIdx >= numCells)
+      {
+        throw std::invalid_argument("Invalid cell index in 2D data extractor.");
+      }
+      SetCellActive(cellIdx, a_activity.empty() || a_activity[cellIdx], changedCells);
+    }
+  }
+  else
+  {
+    throw std::invalid_argument("Invalid activity location in 2D data extractor.");
+  }
+
+  if (!changedCells.empty())
+  {
+    RelocateChangedCells(changedCells);
+    UpdateDerivedScalars(changedCells);
+  }
+} // XmUGrid2dDataExtractorImpl::UpdateGridActivity
+//------------------------------------------------------------------------------
+/// \brief Change some of the scalars without setting all of them again. Only
+///        the centroids of cells attached to changed points or the points of
+///        changed cells are updated.
+/// \param[in] a_idxs The points or cells (matching the current scalars) of the
+///            changed values.
+/// \param[in] a_values The new value for each index.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::UpdateGridScalars(const VecInt& a_idxs, const VecFlt& a_values)
+{
+  if (a_idxs.size() != a_values.size())
+  {
+    throw std::invalid_argument("Invalid scalar size in 2D data extractor.");
+  }
+  if (m_scalars.Size() == 0)
+  {
+    throw std::invalid_argument("No scalars to update in 2D data extractor.");
+  }
+
+  VecInt changedCells;
+  if (m_triangleType == LOC_POINTS)
+  {
+    int numPoints = m_ugrid->GetPointCount();
+    VecInt attachedCells;
+    for (size_t i = 0; i < a_idxs.size(); ++i)
+    {
+      int pointIdx = a_idxs[i];
+      if (pointIdx < 0 || pointIdx >= numPoints)
+      {
+        throw std::invalid_argument("Invalid point index in 2D data extractor.");
+      }
+      m_scalars.SetValue(pointIdx, a_values[i]);
+      m_ugrid->GetPointAdjacentCells(pointIdx, attachedCells);
+      changedCells.insert(changedCells.end(), attachedCells.begin(), attachedCells.end());
+    }
+  }
+  else
+  {
+    int numCells = m_ugrid->GetCellCount();
+    GatherCellScalars();
+    for (size_t i = 0; i < a_idxs.size(); ++i)
+    {
+      int cellIdx = a_idxs[i];
+      if (cellIdx < 0 || cellIdx >= numCells)
+      {
+        throw std::invalid_argument("Invalid cell index in 2D data extractor.");
+      }
+      m_cellScalars[cellIdx] = a_values[i];
+      int centroidIdx = m_triangles->GetCellCentroid(cellIdx);
+      if (centroidIdx >= 0)
+        m_scalars.SetValue(centroidIdx, a_values[i]);
+      changedCells.push_back(cellIdx);
+    }
+  }
+  std::sort(changedCells.begin(), changedCells.end());
+  changedCells.erase(std::unique(changedCells.begin(), changedCells.end()), changedCells.end());
+  UpdateDerivedScalars(changedCells);
+} // XmUGrid2dDataExtractorImpl::UpdateGridScalars
+//------------------------------------------------------------------------------
 /// \brief Sets locations of points to extract interpolated scalar data from.
 /// \param[in] a_locations The locations.
 //------------------------------------------------------------------------------
 void XmUGrid2dDataExtractorImpl::SetExtractLocations(const VecPt3d& a_locations)
 {
   m_extractLocations = a_locations;
+  m_extractTriangleIdxs.clear();
+  m_stencilsValid = false;
+} // XmUGrid2dDataExtractorImpl::SetExtractLocations
+//------------------------------------------------------------------------------
+/// \brief Sets locations to extract interpolated scalar data from along with
+///        a triangle expected to contain each one.
+/// \param[in] a_locations The locations.
+/// \param[in] a_triangleIdxs The triangle of each location or -1 to search.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::SetExtractLocations(const VecPt3d& a_locations,
+                                                     const VecInt& a_triangleIdxs)
+{
+  if (a_triangleIdxs.size() != a_locations.size())
+  {
+    throw std::invalid_argument("Number of triangles doesn't match locations in 2D data extractor.");
+  }
+  m_extractLocations = a_locations;
+  m_extractTriangleIdxs = a_triangleIdxs;
+  m_stencilsValid = false;
 } // XmUGrid2dDataExtractorImpl::SetExtractLocations
 //------------------------------------------------------------------------------
 /// \brief Extract interpolated data for the previously set locations.
@@ -217,50 +510,344 @@ void XmUGrid2dDataExtractorImpl::SetExtractLocations(const VecPt3d& a_locations)
 //------------------------------------------------------------------------------
 void XmUGrid2dDataExtractorImpl::ExtractData(VecFlt& a_outData)
 {
-  a_outData.clear();
+  size_t numLocations = m_extractLocations.size();
+  a_outData.assign(numLocations, m_noDataValue);
+  m_cellIdxs.assign(numLocations, -1);
+  if (numLocations == 0)
+    return;
 
-  a_outData.reserve(m_extractLocations.size());
-  m_cellIdxs.assign(m_extractLocations.size(), -1);
-  int cnt(0);
+  if (m_usePreparedLocations)
+  {
+    PrepareLocations();
+    xmParallelFor(numLocations, m_numThreads, MIN_LOCATIONS_PER_THREAD,
+                  [&](size_t a_begin, size_t a_end) {
+                    m_stencils.Gather(m_scalars, m_noDataValue, a_begin, a_end,
+                                      &a_outData[0]);
+                  });
+    m_cellIdxs = m_stencils.cellIdxs;
+    return;
+  }
+
+  xmParallelFor(numLocations, m_numThreads, MIN_LOCATIONS_PER_THREAD,
+                [&](size_t a_begin, size_t a_end) { ExtractRange(a_begin, a_end, a_outData); });
+} // XmUGrid2dDataExtractorImpl::ExtractData
+//------------------------------------------------------------------------------
+/// \brief Extract interpolated data for a range of the extract locations. Each
+///        location only writes to its own entry so ranges can be extracted on
+///        separate threads.
+/// \param[in] a_begin The index of the first location to extract.
+/// \param[in] a_end One past the index of the last location to extract.
+/// \param[out] a_outData The interpolated scalars. Must be sized to the number
+///             of extract locations.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::ExtractRange(size_t a_begin, size_t a_end, VecFlt& a_outData)
+{
   VecInt interpIdxs;
   VecDbl interpWeights;
-  for (const auto& pt : m_extractLocations)
+  for (size_t locationIdx = a_begin; locationIdx < a_end; ++locationIdx)
   {
-    int cellIdx = m_triangles->GetIntersectedCell(pt, interpIdxs, interpWeights);
-    m_cellIdxs[cnt] = cellIdx;
-    cnt++;
+    const Pt3d& pt = m_extractLocations[locationIdx];
+    int triangleIdx = m_extractTriangleIdxs.empty() ? -1 : m_extractTriangleIdxs[locationIdx];
+    int cellIdx =
+      m_triangles->GetIntersectedCell(pt, triangleIdx, m_cellActivity, interpIdxs, interpWeights);
+    m_cellIdxs[locationIdx] = cellIdx;
     if (cellIdx >= 0)
+      a_outData[locationIdx] = InterpolateValue(interpIdxs, interpWeights);
+  }
+} // XmUGrid2dDataExtractorImpl::ExtractRange
+//------------------------------------------------------------------------------
+/// \brief Extract interpolated data for a range of locations using stencils
+///        located with all cells active. Locations in cells that are inactive
+///        are located again using the cell activity.
+/// \param[in] a_stencils The stencils located with all cells active.
+/// \param[in] a_cellActivity The cell activity of the scalars.
+/// \param[in] a_begin The index of the first location to extract.
+/// \param[in] a_end One past the index of the last location to extract.
+/// \param[out] a_outData The interpolated scalars indexed by location.
+/// \param[out] a_cellIdxs If not null, the cell index for each location.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::ExtractStencilRange(const XmInterpStencils& a_stencils,
+                                                     const DynBitset& a_cellActivity,
+                                                     size_t a_begin,
+                                                     size_t a_end,
+                                                     float* a_outData,
+                                                     VecInt* a_cellIdxs)
+{
+  a_stencils.Gather(m_scalars, m_noDataValue, a_begin, a_end, a_outData);
+  if (a_cellActivity.empty() && !a_cellIdxs)
+    return;
+
+  VecInt interpIdxs;
+  VecDbl interpWeights;
+  for (size_t locationIdx = a_begin; locationIdx < a_end; ++locationIdx)
+  {
+    int cellIdx = a_stencils.cellIdxs[locationIdx];
+    if (cellIdx >= 0 && cellIdx < a_cellActivity.size() && !a_cellActivity[cellIdx])
     {
-      double interpValue = 0.0;
-      for (size_t i = 0; i < interpIdxs.size(); ++i)
-      {
-        int ptIdx = interpIdxs[i];
-        double weight = interpWeights[i];
-        float scalar = m_pointScalars[ptIdx];
-        interpValue += scalar * weight;
-      }
-      a_outData.push_back(static_cast<float>(interpValue));
+      const Pt3d& pt = m_extractLocations[locationIdx];
+      cellIdx = m_triangles->GetIntersectedCell(pt, a_cellActivity, interpIdxs, interpWeights);
+      a_outData[locationIdx] =
+        cellIdx >= 0 ? InterpolateValue(interpIdxs, interpWeights) : m_noDataValue;
     }
-    else
+    if (a_cellIdxs)
+      (*a_cellIdxs)[locationIdx] = cellIdx;
+  }
+} // XmUGrid2dDataExtractorImpl::ExtractStencilRange
+//------------------------------------------------------------------------------
+/// \brief Interpolate the triangle point scalars.
+/// \param[in] a_idxs The triangle points to interpolate from.
+/// \param[in] a_weights The weight of each point.
+/// \return The interpolated value.
+//------------------------------------------------------------------------------
+float XmUGrid2dDataExtractorImpl::InterpolateValue(const VecInt& a_idxs,
+                                                   const VecDbl& a_weights) const
+{
+  double interpValue = 0.0;
+  for (size_t i = 0; i < a_idxs.size(); ++i)
+  {
+    int ptIdx = a_idxs[i];
+    double weight = a_weights[i];
+    float scalar = m_scalars[ptIdx];
+    interpValue += scalar * weight;
+  }
+  return static_cast<float>(interpValue);
+} // XmUGrid2dDataExtractorImpl::InterpolateValue
+//------------------------------------------------------------------------------
+/// \brief Locate the extract locations in the triangles and store the
+///        interpolation stencils if they aren't current.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::PrepareLocations()
+{
+  if (m_stencilsValid)
+    return;
+
+  LocateAll(m_cellActivity, m_stencils);
+  m_stencilsValid = true;
+} // XmUGrid2dDataExtractorImpl::PrepareLocations
+//------------------------------------------------------------------------------
+/// \brief Locate all of the extract locations and store their stencils.
+/// \param[in] a_cellActivity The cell activity. Empty for all active.
+/// \param[out] a_stencils The stencils for the extract locations.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::LocateAll(const DynBitset& a_cellActivity,
+                                           XmInterpStencils& a_stencils)
+{
+  size_t numLocations = m_extractLocations.size();
+  a_stencils.Resize(numLocations);
+  xmParallelFor(numLocations, m_numThreads, MIN_LOCATIONS_PER_THREAD,
+                [&](size_t a_begin, size_t a_end) {
+                  LocateRange(a_cellActivity, a_stencils, a_begin, a_end);
+                });
+} // XmUGrid2dDataExtractorImpl::LocateAll
+//------------------------------------------------------------------------------
+/// \brief Locate a range of the extract locations and store their stencils.
+/// \param[in] a_cellActivity The cell activity. Empty for all active.
+/// \param[out] a_stencils The stencils for the extract locations.
+/// \param[in] a_begin The index of the first location.
+/// \param[in] a_end One past the index of the last location.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::LocateRange(const DynBitset& a_cellActivity,
+                                             XmInterpStencils& a_stencils,
+                                             size_t a_begin,
+                                             size_t a_end)
+{
+  VecInt interpIdxs;
+  VecDbl interpWeights;
+  for (size_t locationIdx = a_begin; locationIdx < a_end; ++locationIdx)
+  {
+    const Pt3d& pt = m_extractLocations[locationIdx];
+    int triangleIdx = m_extractTriangleIdxs.empty() ? -1 : m_extractTriangleIdxs[locationIdx];
+    int cellIdx =
+      m_triangles->GetIntersectedCell(pt, triangleIdx, a_cellActivity, interpIdxs, interpWeights);
+    a_stencils.Set(locationIdx, cellIdx, interpIdxs, interpWeights);
+  }
+} // XmUGrid2dDataExtractorImpl::LocateRange
+//------------------------------------------------------------------------------
+/// \brief Locate again the prepared locations that a change in the activity
+///        of a few cells can move, rather than all of them. Only triangles of
+///        the changed cells or cells sharing a point with them can contain
+///        the same points as those cells, so those are the locations in such
+///        cells and the locations outside the active cells that are within
+///        the extents of a cell that became active.
+/// \param[in] a_changedCells The cells whose activity changed.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::RelocateChangedCells(const VecInt& a_changedCells)
+{
+  if (!m_stencilsValid)
+    return;
+
+  DynBitset affectedCells;
+  affectedCells.resize(m_ugrid->GetCellCount(), false);
+  bool anyActivated = false;
+  Pt3d activatedMin;
+  Pt3d activatedMax;
+  VecInt cellPoints;
+  VecInt adjacentCells;
+  for (auto cellIdx : a_changedCells)
+  {
+    m_ugrid->GetCellPoints(cellIdx, cellPoints);
+    bool activated = m_cellActivity.empty() || m_cellActivity[cellIdx];
+    for (auto pointIdx : cellPoints)
     {
-      a_outData.push_back(m_noDataValue);
+      m_ugrid->GetPointAdjacentCells(pointIdx, adjacentCells);
+      for (auto adjacentIdx : adjacentCells)
+        affectedCells[adjacentIdx] = true;
+      if (activated)
+      {
+        Pt3d pt = m_ugrid->GetPointLocation(pointIdx);
+        if (!anyActivated)
+          activatedMin = activatedMax = pt;
+        activatedMin.x = std::min(activatedMin.x, pt.x);
+        activatedMin.y = std::min(activatedMin.y, pt.y);
+        activatedMax.x = std::max(activatedMax.x, pt.x);
+        activatedMax.y = std::max(activatedMax.y, pt.y);
+        anyActivated = true;
+      }
     }
+    affectedCells[cellIdx] = true;
   }
-} // XmUGrid2dDataExtractorImpl::ExtractData
-//------------------------------------------------------------------------------
-/// \brief Extract interpolated data for the previously set locations.
+  // the search accepts points slightly outside of triangles
+  double tolerance = 1.0e-6 * std::max(activatedMax.x - activatedMin.x,
+                                       activatedMax.y - activatedMin.y);
+  activatedMin.x -= tolerance;
+  activatedMin.y -= tolerance;
+  activatedMax.x += tolerance;
+  activatedMax.y += tolerance;
+
+  const DynBitset& affected = affectedCells;
+  xmParallelFor(m_extractLocations.size(), m_numThreads, MIN_LOCATIONS_PER_THREAD,
+                [&](size_t a_begin, size_t a_end) {
+                  VecInt interpIdxs;
+                  VecDbl interpWeights;
+                  for (size_t locationIdx = a_begin; locationIdx < a_end; ++locationIdx)
+                  {
+                    const Pt3d& pt = m_extractLocations[locationIdx];
+                    int cellIdx = m_stencils.cellIdxs[locationIdx];
+                    bool relocate = cellIdx >= 0 ? affected[cellIdx]
+                                                 : anyActivated && pt.x >= activatedMin.x &&
+                                                     pt.y >= activatedMin.y &&
+                                                     pt.x <= activatedMax.x &&
+                                                     pt.y <= activatedMax.y;
+                    if (!relocate)
+                      continue;
+                    int triangleIdx =
+                      m_extractTriangleIdxs.empty() ? -1 : m_extractTriangleIdxs[locationIdx];
+                    cellIdx = m_triangles->GetIntersectedCell(pt, triangleIdx, m_cellActivity,
+                                                              interpIdxs, interpWeights);
+                    m_stencils.Set(locationIdx, cellIdx, interpIdxs, interpWeights);
+                  }
+                });
+} // XmUGrid2dDataExtractorImpl::RelocateChangedCells
+//------------------------------------------------------------------------------
+/// \brief Extract interpolated data at a single location. Doesn't change the
+///        extract locations or cell indexes. Uses scratch buffers kept for
+///        each thread so repeated calls don't allocate and several threads can
+///        query the same extractor.
 /// \param[in] a_location The location to get the interpolated scalar.
 /// \return The interpolated value.
 //------------------------------------------------------------------------------
-float XmUGrid2dDataExtractorImpl::ExtractAtLocation(const Pt3d& a_location)
+float XmUGrid2dDataExtractorImpl::ExtractAtLocation(const Pt3d& a_location) const
 {
-  VecPt3d locations(1, a_location);
-  SetExtractLocations(locations);
-  VecFlt values;
-  ExtractData(values);
-  return values[0];
+  thread_local VecInt interpIdxs;
+  thread_local VecDbl interpWeights;
+  int cellIdx =
+    m_triangles->GetIntersectedCell(a_location, m_cellActivity, interpIdxs, interpWeights);
+  if (cellIdx < 0)
+    return m_noDataValue;
+  return InterpolateValue(interpIdxs, interpWeights);
 } // XmUGrid2dDataExtractorImpl::ExtractAtLocation
 //------------------------------------------------------------------------------
+/// \brief Extract interpolated data at the extract locations for several time
+///        steps of point or cell scalars. Each location is located once with
+///        all cells active and is only located again for time steps in which
+///        its cell is inactive. The extractor is left with the scalars and
+///        activity of the last time step.
+/// \param[in] a_scalars The scalars for every time step stored one time step
+///            after another ([time steps x values]).
+/// \param[in] a_scalarLocation Whether the scalars are at points or cells.
+/// \param[in] a_activity The activity for each time step. Empty for all active,
+///            otherwise one (possibly empty) activity per time step.
+/// \param[in] a_activityLocation The location of the activity.
+/// \param[out] a_outData The interpolated scalars stored one time step after
+///             another ([time steps x locations]).
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::ExtractTimesteps(const VecFlt& a_scalars,
+                                                  DataLocationEnum a_scalarLocation,
+                                                  const std::vector<DynBitset>& a_activity,
+                                                  DataLocationEnum a_activityLocation,
+                                                  VecFlt& a_outData)
+{
+  size_t numValues;
+  if (a_scalarLocation == LOC_POINTS)
+    numValues = m_ugrid->GetPointCount();
+  else if (a_scalarLocation == LOC_CELLS)
+    numValues = m_ugrid->GetCellCount();
+  else
+    throw std::invalid_argument("Invalid scalar location in 2D data extractor.");
+
+  if (numValues == 0 ? !a_scalars.empty() : a_scalars.size() % numValues != 0)
+  {
+    throw std::invalid_argument("Invalid scalar size in 2D data extractor.");
+  }
+  size_t numTimesteps = numValues == 0 ? 0 : a_scalars.size() / numValues;
+  if (!a_activity.empty() && a_activity.size() != numTimesteps)
+  {
+    throw std::invalid_argument("Invalid activity count in 2D data extractor.");
+  }
+
+  size_t numLocations = m_extractLocations.size();
+  a_outData.assign(numTimesteps * numLocations, m_noDataValue);
+  if (numTimesteps == 0)
+    return;
+
+  BuildTriangles(a_scalarLocation);
+  XmInterpStencils stencils;
+  LocateAll(DynBitset(), stencils);
+
+  m_cellIdxs.assign(numLocations, -1);
+  DynBitset emptyActivity;
+  DynBitset cellActivity;
+  const DynBitset* previousActivity = nullptr;
+  for (size_t stepIdx = 0; stepIdx < numTimesteps; ++stepIdx)
+  {
+    const DynBitset& activity = a_activity.empty() ? emptyActivity : a_activity[stepIdx];
+    if (!previousActivity || activity != *previousActivity)
+    {
+      cellActivity = DynBitset();
+      ApplyActivity(activity, a_activityLocation, cellActivity);
+      UpdateCellActivity(cellActivity);
+    }
+    previousActivity = &activity;
+
+    // each time step is read in place rather than copied
+    const float* stepScalars = &a_scalars[stepIdx * numValues];
+    if (a_scalarLocation == LOC_POINTS)
+    {
+      m_scalars.Refer(stepScalars, numValues);
+      PushPointDataToCentroids(cellActivity);
+    }
+    else
+    {
+      PushCellDataToTrianglePoints(stepScalars, numValues, cellActivity);
+    }
+
+    float* stepOut = numLocations ? &a_outData[stepIdx * numLocations] : nullptr;
+    VecInt* cellIdxs = stepIdx + 1 == numTimesteps ? &m_cellIdxs : nullptr;
+    xmParallelFor(numLocations, m_numThreads, MIN_LOCATIONS_PER_THREAD,
+                  [&](size_t a_begin, size_t a_end) {
+                    ExtractStencilRange(stencils, cellActivity, a_begin, a_end, stepOut,
+                                        cellIdxs);
+                  });
+  }
+  // keep the last time step after the caller's scalars go away
+  m_scalars.MakeOwned();
+  if (a_scalarLocation == LOC_POINTS)
+  {
+    m_cellScalars.clear();
+    m_noCentroidScalars.clear();
+  }
+} // XmUGrid2dDataExtractorImpl::ExtractTimesteps
+//------------------------------------------------------------------------------
 /// \brief Set to use IDW to calculate point scalar values from cell scalars.
 /// \param a_useIdw Whether to turn IDW on or off.
 //------------------------------------------------------------------------------
@@ -278,7 +865,40 @@ void XmUGrid2dDataExtractorImpl::SetNoDataValue(float a_value)
   m_noDataValue = a_value;
 } // XmUGrid2dDataExtractorImpl::SetNoDataValue
 //------------------------------------------------------------------------------
-/// \brief Apply point or cell activity to triangles.
+/// \brief Set the number of threads used to build triangles and extract data.
+/// \param[in] a_numThreads The number of threads. One extracts serially. Zero
+///            or less uses the number of hardware threads.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::SetThreadCount(int a_numThreads)
+{
+  m_numThreads = a_numThreads;
+} // XmUGrid2dDataExtractorImpl::SetThreadCount
+//------------------------------------------------------------------------------
+/// \brief Set to locate the extract locations once and reuse the interpolation
+///        points and weights until the locations, triangles or activity change.
+/// \param[in] a_usePrepared Whether to turn prepared locations on or off.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::SetUsePreparedLocations(bool a_usePrepared)
+{
+  m_usePreparedLocations = a_usePrepared;
+  if (!m_usePreparedLocations)
+  {
+    m_stencils.Clear();
+    m_stencilsValid = false;
+  }
+} // XmUGrid2dDataExtractorImpl::SetUsePreparedLocations
+//------------------------------------------------------------------------------
+/// \brief Set a file to keep the triangles in between runs.
+/// \param[in] a_fileName The file name. Empty to always build triangles.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::SetTrianglesCacheFile(const std::string& a_fileName)
+{
+  m_trianglesCacheFile = a_fileName;
+} // XmUGrid2dDataExtractorImpl::SetTrianglesCacheFile
+//------------------------------------------------------------------------------
+/// \brief Get the cell activity from point or cell activity. The activity is
+///        kept by the extractor rather than set on the triangles so extractors
+///        sharing the triangles can use different activity.
 /// \param[in] a_activity The activity of the scalar values.
 /// \param[in] a_location The location of the activity (cells or points).
 /// \param[out] a_cellActivity The cell activity of the scalar values.
@@ -291,7 +911,6 @@ void XmUGrid2dDataExtractorImpl::ApplyActivity(const DynBitset& a_activity,
   {
     // when empty, everything gets enabled on the cells
     a_cellActivity = a_activity;
-    SetGridCellActivity(a_cellActivity);
   }
   else
   {
@@ -323,7 +942,6 @@ void XmUGrid2dDataExtractorImpl::SetGridPointActivity(const DynBitset& a_pointAc
   if (a_pointActivity.empty())
   {
     a_cellActivity = a_pointActivity;
-    m_triangles->SetCellActivity(a_cellActivity);
     return;
   }
 
@@ -342,10 +960,9 @@ void XmUGrid2dDataExtractorImpl::SetGridPointActivity(const DynBitset& a_pointAc
       }
     }
   }
-  m_triangles->SetCellActivity(a_cellActivity);
 } // XmUGrid2dDataExtractorImpl::SetGridPointActivity
 //------------------------------------------------------------------------------
-/// \brief Set activity on cells
+/// \brief Check the size of cell activity.
 /// \param[in] a_cellActivity The cell activity of the scalar values.
 //------------------------------------------------------------------------------
 void XmUGrid2dDataExtractorImpl::SetGridCellActivity(const DynBitset& a_cellActivity)
@@ -354,16 +971,117 @@ void XmUGrid2dDataExtractorImpl::SetGridCellActivity(const DynBitset& a_cellActi
   {
     throw std::invalid_argument("Invalid cell activity size in 2D data extractor.");
   }
-  m_triangles->SetCellActivity(a_cellActivity);
 } // XmUGrid2dDataExtractorImpl::SetGridCellActivity
 //------------------------------------------------------------------------------
+/// \brief Store the cell activity used to locate points. Prepared locations
+///        are located again when the activity changes.
+/// \param[in] a_cellActivity The cell activity of the scalar values.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::UpdateCellActivity(const DynBitset& a_cellActivity)
+{
+  if (a_cellActivity != m_cellActivity)
+  {
+    m_cellActivity = a_cellActivity;
+    m_stencilsValid = false;
+  }
+} // XmUGrid2dDataExtractorImpl::UpdateCellActivity
+//------------------------------------------------------------------------------
+/// \brief Set the activity of one cell.
+/// \param[in] a_cellIdx The cell.
+/// \param[in] a_active Whether the cell is active.
+/// \param[in,out] a_changedCells The cells whose activity changed. The cell
+///                is added if its activity changes.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::SetCellActive(int a_cellIdx,
+                                               bool a_active,
+                                               VecInt& a_changedCells)
+{
+  if (m_cellActivity.empty())
+  {
+    if (a_active)
+      return;
+    m_cellActivity.resize(m_ugrid->GetCellCount(), true);
+  }
+  if (m_cellActivity[a_cellIdx] != a_active)
+  {
+    m_cellActivity[a_cellIdx] = a_active;
+    a_changedCells.push_back(a_cellIdx);
+  }
+} // XmUGrid2dDataExtractorImpl::SetCellActive
+//------------------------------------------------------------------------------
+/// \brief Update the triangle point scalars that depend on the scalars or
+///        activity of the changed cells. For point scalars that is the
+///        centroid of each changed cell. For cell scalars it is the UGrid
+///        points of each changed cell.
+/// \param[in] a_changedCells The cells whose scalars or activity changed.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorImpl::UpdateDerivedScalars(const VecInt& a_changedCells)
+{
+  if (m_scalars.Size() == 0)
+    return;
+
+  VecInt cellPoints;
+  if (m_triangleType == LOC_POINTS)
+  {
+    for (auto cellIdx : a_changedCells)
+    {
+      int centroidIdx = m_triangles->GetCellCentroid(cellIdx);
+      if (centroidIdx >= 0)
+      {
+        bool active = m_cellActivity.empty() || m_cellActivity[cellIdx];
+        float value = active ? AverageCellPoints(cellIdx, cellPoints) : 0.0f;
+        m_scalars.SetValue(centroidIdx, value);
+      }
+    }
+  }
+  else if (m_triangleType == LOC_CELLS)
+  {
+    VecInt pointIdxs;
+    for (auto cellIdx : a_changedCells)
+    {
+      m_ugrid->GetCellPoints(cellIdx, cellPoints);
+      pointIdxs.insert(pointIdxs.end(), cellPoints.begin(), cellPoints.end());
+    }
+    std::sort(pointIdxs.begin(), pointIdxs.end());
+    pointIdxs.erase(std::unique(pointIdxs.begin(), pointIdxs.end()), pointIdxs.end());
+
+    BuildCellToPointOperator();
+    GatherCellScalars();
+    VecInt activeCells;
+    VecDbl d2;
+    VecDbl weights;
+    for (auto pointIdx : pointIdxs)
+    {
+      float value =
+        m_cellToPoint->ApplyAtPoint(pointIdx, m_cellScalars.data(), m_cellScalars.size(),
+                                    m_cellActivity, m_noDataValue, activeCells, d2, weights);
+      m_scalars.SetValue(pointIdx, value);
+    }
+  }
+} // XmUGrid2dDataExtractorImpl::UpdateDerivedScalars
+//------------------------------------------------------------------------------
+/// \brief Average the point scalars of a cell.
+/// \param[in] a_cellIdx The cell.
+/// \param[out] a_cellPoints Storage for the cell points.
+/// \return The average.
+//------------------------------------------------------------------------------
+float XmUGrid2dDataExtractorImpl::AverageCellPoints(int a_cellIdx, VecInt& a_cellPoints) const
+{
+  m_ugrid->GetCellPoints(a_cellIdx, a_cellPoints);
+  double sum = 0.0;
+  for (auto ptIdx : a_cellPoints)
+    sum += m_scalars[ptIdx];
+  double average = sum / a_cellPoints.size();
+  return static_cast<float>(average);
+} // XmUGrid2dDataExtractorImpl::AverageCellPoints
+//------------------------------------------------------------------------------
 /// \brief Push point scalar data to cell centroids using average.
 /// \param[in] a_cellActivity The cell activity of the scalar values.
 //------------------------------------------------------------------------------
 void XmUGrid2dDataExtractorImpl::PushPointDataToCentroids(const DynBitset& a_cellActivity)
 {
   // default any missing scalar values to zero
-  m_pointScalars.resize(m_triangles->GetPoints().size(), 0.0);
+  m_scalars.ResizeOverlay(m_triangles->GetPoints().size(), 0.0f);
 
   VecInt cellPoints;
   int numCells = m_ugrid->GetCellCount();
@@ -373,125 +1091,83 @@ void XmUGrid2dDataExtractorImpl::PushPointDataToCentroids(const DynBitset& a_cel
     {
       int centroidIdx = m_triangles->GetCellCentroid(cellIdx);
       if (centroidIdx >= 0)
-      {
-        m_ugrid->GetCellPoints(cellIdx, cellPoints);
-        double sum = 0.0;
-        for (auto ptIdx : cellPoints)
-          sum += m_pointScalars[ptIdx];
-        double average = sum / cellPoints.size();
-        m_pointScalars[centroidIdx] = static_cast<float>(average);
-      }
+        m_scalars.SetOverlay(centroidIdx, AverageCellPoints(cellIdx, cellPoints));
     }
   }
 } // XmUGrid2dDataExtractorImpl::PushPointDataToCentroids
 //------------------------------------------------------------------------------
 /// \brief Push cell scalar data to triangle points using cells connected to
-///        a point with average or IDW.
+///        a point with average or IDW. The cell to point operator is built
+///        once for the triangles and averaging mode.
 /// \param[in] a_cellScalars the cell scalar values.
+/// \param[in] a_numCellScalars the number of cell scalar values.
 /// \param[in] a_cellActivity the cell activity vector.
 //------------------------------------------------------------------------------
-void XmUGrid2dDataExtractorImpl::PushCellDataToTrianglePoints(const VecFlt& a_cellScalars,
+void XmUGrid2dDataExtractorImpl::PushCellDataToTrianglePoints(const float* a_cellScalars,
+                                                              size_t a_numCellScalars,
                                                               const DynBitset& a_cellActivity)
 {
-  m_pointScalars.resize(m_triangles->GetPoints().size());
-  VecInt cellIdxs;
-  int numPoints = m_ugrid->GetPointCount();
-  for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
-  {
-    m_ugrid->GetPointAdjacentCells(pointIdx, cellIdxs);
-    if (m_useIdwForPointData)
-    {
-      m_pointScalars[pointIdx] =
-        CalculatePointByIdw(pointIdx, cellIdxs, a_cellScalars, a_cellActivity);
-    }
-    else
-    {
-      m_pointScalars[pointIdx] = CalculatePointByAverage(cellIdxs, a_cellScalars, a_cellActivity);
-    }
-  }
-
+  VecFlt& pointScalars = m_scalars.Allocate(m_triangles->GetPoints().size());
+  BuildCellToPointOperator();
+  size_t numPoints = m_ugrid->GetPointCount();
+  xmParallelFor(numPoints, m_numThreads, MIN_POINTS_PER_THREAD,
+                [&](size_t a_begin, size_t a_end) {
+                  m_cellToPoint->Apply(a_cellScalars, a_numCellScalars, a_cellActivity,
+                                       m_noDataValue, a_begin, a_end, pointScalars.data());
+                });
+
+  // the cell scalars are kept in the centroids, and for the few cells without
+  // one on their own, rather than copied in case they are updated
+  m_cellScalars.clear();
+  m_noCentroidScalars.clear();
   int numCells = m_ugrid->GetCellCount();
   for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
   {
+    float value = cellIdx >= a_numCellScalars ? 0.0f : a_cellScalars[cellIdx];
     int pointIdx = m_triangles->GetCellCentroid(cellIdx);
     if (pointIdx >= 0)
-      m_pointScalars[pointIdx] = cellIdx >= a_cellScalars.size() ? 0.0f : a_cellScalars[cellIdx];
+      pointScalars[pointIdx] = value;
+    else
+      m_noCentroidScalars.push_back(value);
   }
 } // XmUGrid2dDataExtractorImpl::PushCellDataToTrianglePoints
 //------------------------------------------------------------------------------
-/// \brief Calculate the average of the cell values connected to a point.
-/// \param[in] a_cellIdxs the cells surrounding the point.
-/// \param[in] a_cellScalars the cell scalar values.
-/// \param[in] a_cellActivity the cell activity vector.
-/// \return Average of active surrounding cell scalars.
-//------------------------------------------------------------------------------
-float XmUGrid2dDataExtractorImpl::CalculatePointByAverage(const VecInt& a_cellIdxs,
-                                                          const VecFlt& a_cellScalars,
-                                                          const DynBitset& a_cellActivity)
-{
-  double sum = 0.0;
-  int sumCount = 0;
-  for (auto cellIdx : a_cellIdxs)
-  {
-    if (cellIdx >= a_cellActivity.size() || a_cellActivity[cellIdx])
-    {
-      sum += cellIdx >= a_cellScalars.size() ? 0.0 : a_cellScalars[cellIdx];
-      ++sumCount;
-    }
-  }
-  double average;
-  if (sumCount)
-    average = sum / sumCount;
-  else
-    average = m_noDataValue;
-  return static_cast<float>(average);
-} // XmUGrid2dDataExtractorImpl::CalculatePointByAverage
-//------------------------------------------------------------------------------
-/// \brief Calculate the point value by IDW method from surrounding cells.
-/// \param[in] a_pointIdx the point to calculate the value for.
-/// \param[in] a_cellIdxs the cells surrounding the point.
-/// \param[in] a_cellScalars the cell scalar values.
-/// \param[in] a_cellActivity the cell activity vector.
-/// \return IDW interpolated value of active surrounding cell scalars.
+/// \brief Gather the cell scalars from the cell centroids and the cells
+///        without a centroid the first time an update needs them after the
+///        cell scalars are set.
 //------------------------------------------------------------------------------
-float XmUGrid2dDataExtractorImpl::CalculatePointByIdw(int a_pointIdx,
-                                                      const VecInt& a_cellIdxs,
-                                                      const VecFlt& a_cellScalars,
-                                                      const DynBitset& a_cellActivity)
+void XmUGrid2dDataExtractorImpl::GatherCellScalars()
 {
-  Pt3d pt = m_ugrid->GetPointLocation(a_pointIdx);
-  VecInt cellCentroids;
-  for (auto cellIdx : a_cellIdxs)
-  {
-    int centroidIdx = m_triangles->GetCellCentroid(cellIdx);
-    if (0 <= centroidIdx && a_cellActivity[cellIdx])
-    {
-      cellCentroids.push_back(centroidIdx);
-    }
-  }
-  if (!cellCentroids.empty())
-  {
-    VecDbl d2;
-    VecDbl weights;
-    inDistanceSquared(pt, cellCentroids, m_triangles->GetPoints(), true, d2);
-    inIdwWeights(d2, 2, false, weights);
+  int numCells = m_ugrid->GetCellCount();
+  if (m_triangleType != LOC_CELLS || (int)m_cellScalars.size() == numCells)
+    return;
 
-    double interpValue = 0.0;
-    for (size_t cellIdx = 0; cellIdx < cellCentroids.size(); ++cellIdx)
-    {
-      int ptIdx = cellCentroids[cellIdx];
-      double weight = weights[cellIdx];
-      interpValue += a_cellScalars[cellIdx] * weight;
-    }
-    return static_cast<float>(interpValue);
-  }
-  else
+  m_cellScalars.resize(numCells);
+  size_t noCentroidIdx = 0;
+  for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
   {
-    return CalculatePointByAverage(a_cellIdxs, a_cellScalars, a_cellActivity);
+    int pointIdx = m_triangles->GetCellCentroid(cellIdx);
+    m_cellScalars[cellIdx] =
+      pointIdx >= 0 ? m_scalars[pointIdx] : m_noCentroidScalars[noCentroidIdx++];
   }
-} // XmUGrid2dDataExtractorImpl::CalculatePointByIdw
+} // XmUGrid2dDataExtractorImpl::GatherCellScalars
+//------------------------------------------------------------------------------
+/// \brief Get the operator that calculates point scalars from cell scalars
+///        from the triangles if it isn't current for the averaging mode. The
+///        triangles build it once for every extractor sharing them.
 //------------------------------------------------------------------------------
-/// \brief Build triangles for UGrid for either point or cell scalars.
+void XmUGrid2dDataExtractorImpl::BuildCellToPointOperator()
+{
+  if (!m_cellToPoint || !m_cellToPoint->IsBuilt(m_useIdwForPointData))
+    m_cellToPoint = m_triangles->GetCellToPointOperator(*m_ugrid, m_useIdwForPointData);
+} // XmUGrid2dDataExtractorImpl::BuildCellToPointOperator
+//------------------------------------------------------------------------------
+/// \brief Build triangles for UGrid for either point or cell scalars. New
+///        triangles are built rather than rebuilding the current ones, which
+///        may be shared with copied extractors. When a triangles cache file
+///        is set the triangles are read from it if possible, otherwise they
+///        are built and written to it. Point and cell scalar triangles are
+///        kept in separate files so switching between them reads both.
 /// \param[in] a_location Location to build on (points or cells).
 //------------------------------------------------------------------------------
 void XmUGrid2dDataExtractorImpl::BuildTriangles(DataLocationEnum a_location)
@@ -501,8 +1177,21 @@ void XmUGrid2dDataExtractorImpl::BuildTriangles(DataLocationEnum a_location)
     XmUGridTriangles2d::PointOptionEnum option = a_location == LOC_CELLS
                                                    ? XmUGridTriangles2d::PO_CENTROIDS_ONLY
                                                    : XmUGridTriangles2d::PO_NO_POINTS;
-    m_triangles->BuildTriangles(*m_ugrid, option);
+    BSHP<XmUGridTriangles2d> triangles = XmUGridTriangles2d::New();
+    bool useCache = !m_trianglesCacheFile.empty();
+    std::string cacheFile =
+      m_trianglesCacheFile + (a_location == LOC_CELLS ? ".cells" : ".points");
+    if (!useCache || !triangles->ReadFromFile(cacheFile, *m_ugrid, option))
+    {
+      triangles->SetThreadCount(m_numThreads);
+      triangles->BuildTriangles(*m_ugrid, option);
+      if (useCache && !triangles->WriteToFile(cacheFile, *m_ugrid))
+        XM_LOG(xmlog::warning, "Unable to write triangles cache file " + cacheFile);
+    }
+    m_triangles = triangles;
     m_triangleType = a_location;
+    m_stencilsValid = false;
+    m_cellToPoint.reset();
   }
 } // XmUGrid2dDataExtractorImpl::BuildTriangles
 //------------------------------------------------------------------------------
@@ -513,11 +1202,23 @@ const BSHP<XmUGridTriangles2d> XmUGrid2dDataExtractorImpl::GetUGridTriangles() c
 {
   return m_triangles;
 } // XmUGrid2dDataExtractorImpl::GetUGridTriangles
+//------------------------------------------------------------------------------
+/// \brief Gets a copy of the scalars at the triangle points, which may be
+///        read in place and have derived values kept separately.
+/// \return The scalars.
+//------------------------------------------------------------------------------
+VecFlt XmUGrid2dDataExtractorImpl::GetScalars() const
+{
+  VecFlt scalars;
+  m_scalars.CopyTo(scalars);
+  return scalars;
+} // XmUGrid2dDataExtractorImpl::GetScalars
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \class XmUGrid2dDataExtractor
 /// \brief Provides ability to interpolate and extract the scalar values  points and along arcs
-///        for an unstructured grid.
+///        for an unstructured grid. The interface is only implemented here
+///        and created with New, so its methods are all pure virtual.
 ////////////////////////////////////////////////////////////////////////////////
 //------------------------------------------------------------------------------
 /// \brief Create a new XmUGrid2dDataExtractor.
@@ -531,7 +1232,9 @@ BSHP<XmUGrid2dDataExtractor> XmUGrid2dDataExtractor::New(std::shared_ptr<XmUGrid
 } // XmUGrid2dDataExtractor::New
 //------------------------------------------------------------------------------
 /// \brief Create a new XmUGrid2dDataExtractor using shallow copy from existing
-///        extractor.
+///        extractor. The copy shares the triangles and triangle search but has
+///        its own scalars, activity and extract locations, so copies can
+///        extract on separate threads at once.
 /// \param[in] a_extractor The extractor to shallow copy
 /// \return the new XmUGrid2dDataExtractor.
 //------------------------------------------------------------------------------
@@ -569,7 +1272,62 @@ XmUGrid2dDataExtractor::~XmUGrid2dDataExtractor()
 using namespace xms;
 #include <xmsextractor/extractor/XmUGrid2dDataExtractor.t.h>
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
 #include <xmscore/testing/TestTools.h>
+#include <xmsextractor/misc/XmMappedFile.h>
+
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Build a UGrid of unit quads with the given number of rows and columns.
+/// \param[in] a_rows The number of rows of cells.
+/// \param[in] a_cols The number of columns of cells.
+/// \return The UGrid.
+//------------------------------------------------------------------------------
+std::shared_ptr<XmUGrid> iBuildQuadUGrid(int a_rows, int a_cols)
+{
+  VecPt3d points;
+  for (int row = 0; row <= a_rows; ++row)
+  {
+    for (int col = 0; col <= a_cols; ++col)
+      points.push_back(Pt3d(col, row, 0.0));
+  }
+  VecInt cells;
+  for (int row = 0; row < a_rows; ++row)
+  {
+    for (int col = 0; col < a_cols; ++col)
+    {
+      int pt0 = row * (a_cols + 1) + col;
+      int pt1 = pt0 + a_cols + 1;
+      cells.insert(cells.end(), {XMU_QUAD, 4, pt0, pt0 + 1, pt1 + 1, pt1});
+    }
+  }
+  return XmUGrid::New(points, cells);
+} // iBuildQuadUGrid
+//------------------------------------------------------------------------------
+/// \brief Build extract locations spread over a grid and a margin around it.
+/// \param[in] a_rows The number of rows of cells in the grid.
+/// \param[in] a_cols The number of columns of cells in the grid.
+/// \param[in] a_count The number of locations.
+/// \return The locations.
+//------------------------------------------------------------------------------
+VecPt3d iBuildExtractLocations(int a_rows, int a_cols, int a_count)
+{
+  VecPt3d locations;
+  locations.reserve(a_count);
+  for (int i = 0; i < a_count; ++i)
+  {
+    double x = -1.0 + (a_cols + 2.0) * ((i * 7919) % a_count) / a_count;
+    double y = -1.0 + (a_rows + 2.0) * ((i * 104729) % a_count) / a_count;
+    locations.push_back(Pt3d(x, y, 0.0));
+  }
+  return locations;
+} // iBuildExtractLocations
+} // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \class XmUGrid2dDataExtractorUnitTests
@@ -972,8 +1730,8 @@ void XmUGrid2dDataExtractorUnitTests::testCellScalarCellActivityIdw()
 
   // expected results with point 4 inactive
   VecFlt expectedPerCell = {
-    2.0f, 3.4444f, XM_NODATA, 6.75f, // row 1 cells
-    3.5f, 5.7303f, 5.4652f, 8.25f    // row 2 cells
+    2.0f, 3.4444f, XM_NODATA, 8.25f, // row 1 cells
+    4.0f, 5.9289f, 6.7888f, 9.75f    // row 2 cells
   };
   // clang-format on
 
@@ -1254,6 +2012,824 @@ void XmUGrid2dDataExtractorUnitTests::testCopiedExtractor()
   TS_ASSERT_EQUALS(expected, interpValues);
 } // XmUGrid2dDataExtractorUnitTests::testCopiedExtractor
 //------------------------------------------------------------------------------
+/// \brief Test copied extractors that share triangles but have their own
+///        scalars and activity extracting on several threads at once.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testCopiedExtractorsWithDifferentActivity()
+{
+  const int rows = 12;
+  const int cols = 15;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, 2000);
+  int numPoints = ugrid->GetPointCount();
+  int numCells = ugrid->GetCellCount();
+
+  BSHP<XmUGrid2dDataExtractor> extractor = XmUGrid2dDataExtractor::New(ugrid);
+  extractor->SetNoDataValue(-999.0);
+  extractor->SetGridPointScalars(VecFlt(numPoints, 0.0f), DynBitset(), LOC_POINTS);
+
+  // each copy gets its own scalars, activity and options
+  const int numExtractors = 6;
+  std::vector<BSHP<XmUGrid2dDataExtractor>> copies;
+  std::vector<VecFlt> expected(numExtractors);
+  std::vector<VecInt> expectedCellIdxs(numExtractors);
+  for (int extractorIdx = 0; extractorIdx < numExtractors; ++extractorIdx)
+  {
+    VecFlt scalars(numPoints);
+    for (int i = 0; i < numPoints; ++i)
+      scalars[i] = static_cast<float>((i * (extractorIdx + 3)) % 17);
+    DynBitset activity;
+    activity.resize(numCells, true);
+    for (int cellIdx = extractorIdx; cellIdx < numCells; cellIdx += extractorIdx + 2)
+      activity[cellIdx] = false;
+
+    // results from an extractor with its own triangles
+    BSHP<XmUGrid2dDataExtractor> single = XmUGrid2dDataExtractor::New(ugrid);
+    single->SetNoDataValue(-999.0);
+    single->SetGridPointScalars(scalars, activity, LOC_CELLS);
+    single->SetExtractLocations(locations);
+    single->ExtractData(expected[extractorIdx]);
+    expectedCellIdxs[extractorIdx] = single->GetCellIndexes();
+
+    BSHP<XmUGrid2dDataExtractor> copy = XmUGrid2dDataExtractor::New(extractor);
+    copy->SetGridPointScalars(scalars, activity, LOC_CELLS);
+    copy->SetExtractLocations(locations);
+    copy->SetUsePreparedLocations(extractorIdx % 2 == 0);
+    TS_ASSERT_EQUALS(extractor->GetUGridTriangles(), copy->GetUGridTriangles());
+    copies.push_back(copy);
+  }
+
+  std::vector<VecFlt> values(numExtractors);
+  std::vector<VecFlt> locationValues(numExtractors, VecFlt(locations.size()));
+  std::vector<std::thread> threads;
+  for (int extractorIdx = 0; extractorIdx < numExtractors; ++extractorIdx)
+  {
+    threads.emplace_back([&, extractorIdx]() {
+      BSHP<XmUGrid2dDataExtractor> copy = copies[extractorIdx];
+      copy->ExtractData(values[extractorIdx]);
+      for (size_t i = 0; i < locations.size(); ++i)
+        locationValues[extractorIdx][i] = copy->ExtractAtLocation(locations[i]);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  for (int extractorIdx = 0; extractorIdx < numExtractors; ++extractorIdx)
+  {
+    TS_ASSERT_EQUALS(expected[extractorIdx], values[extractorIdx]);
+    TS_ASSERT_EQUALS(expected[extractorIdx], locationValues[extractorIdx]);
+    TS_ASSERT_EQUALS(expectedCellIdxs[extractorIdx], copies[extractorIdx]->GetCellIndexes());
+  }
+
+  // building triangles for cell scalars doesn't change the shared triangles
+  BSHP<XmUGridTriangles2d> sharedTriangles = extractor->GetUGridTriangles();
+  copies[0]->SetGridCellScalars(VecFlt(numCells, 1.0f), DynBitset(), LOC_CELLS);
+  TS_ASSERT(copies[0]->GetUGridTriangles() != sharedTriangles);
+  TS_ASSERT_EQUALS(sharedTriangles, copies[1]->GetUGridTriangles());
+  VecFlt afterValues;
+  copies[1]->ExtractData(afterValues);
+  TS_ASSERT_EQUALS(expected[1], afterValues);
+} // XmUGrid2dDataExtractorUnitTests::testCopiedExtractorsWithDifferentActivity
+//------------------------------------------------------------------------------
+/// \brief Test that extracting with several threads gives the same results as
+///        extracting serially.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testMultithreadedExtraction()
+{
+  const int rows = 30;
+  const int cols = 40;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  BSHP<XmUGrid2dDataExtractor> extractor = XmUGrid2dDataExtractor::New(ugrid);
+  TS_ASSERT_EQUALS(1, extractor->GetThreadCount());
+  extractor->SetNoDataValue(-999.0);
+  extractor->SetExtractLocations(iBuildExtractLocations(rows, cols, 5000));
+
+  VecFlt pointScalars(ugrid->GetPointCount());
+  for (size_t i = 0; i < pointScalars.size(); ++i)
+    pointScalars[i] = static_cast<float>((i * 37) % 101) / 7.0f;
+  DynBitset pointActivity;
+  pointActivity.resize(ugrid->GetPointCount(), true);
+  pointActivity[45] = false;
+  extractor->SetGridPointScalars(pointScalars, pointActivity, LOC_POINTS);
+
+  VecFlt serialValues;
+  extractor->ExtractData(serialValues);
+  VecInt serialCellIdxs = extractor->GetCellIndexes();
+
+  extractor->SetThreadCount(4);
+  TS_ASSERT_EQUALS(4, extractor->GetThreadCount());
+  VecFlt threadedValues;
+  extractor->ExtractData(threadedValues);
+  TS_ASSERT_EQUALS(serialValues, threadedValues);
+  TS_ASSERT_EQUALS(serialCellIdxs, extractor->GetCellIndexes());
+
+  // cell scalars
+  VecFlt cellScalars(ugrid->GetCellCount());
+  for (size_t i = 0; i < cellScalars.size(); ++i)
+    cellScalars[i] = static_cast<float>((i * 13) % 29);
+  extractor->SetThreadCount(1);
+  extractor->SetGridCellScalars(cellScalars, DynBitset(), LOC_CELLS);
+  extractor->ExtractData(serialValues);
+  serialCellIdxs = extractor->GetCellIndexes();
+
+  extractor->SetThreadCount(0);
+  extractor->ExtractData(threadedValues);
+  TS_ASSERT_EQUALS(serialValues, threadedValues);
+  TS_ASSERT_EQUALS(serialCellIdxs, extractor->GetCellIndexes());
+} // XmUGrid2dDataExtractorUnitTests::testMultithreadedExtraction
+//------------------------------------------------------------------------------
+/// \brief Test that prepared locations give the same results as searching for
+///        each location as scalars, activity and locations change.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testPreparedLocations()
+{
+  const int rows = 20;
+  const int cols = 25;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, 2000);
+  BSHP<XmUGrid2dDataExtractor> searched = XmUGrid2dDataExtractor::New(ugrid);
+  BSHP<XmUGrid2dDataExtractor> prepared = XmUGrid2dDataExtractor::New(ugrid);
+  TS_ASSERT(!prepared->GetUsePreparedLocations());
+  prepared->SetUsePreparedLocations(true);
+  TS_ASSERT(prepared->GetUsePreparedLocations());
+  searched->SetExtractLocations(locations);
+  prepared->SetExtractLocations(locations);
+
+  VecFlt pointScalars(ugrid->GetPointCount());
+  VecFlt cellScalars(ugrid->GetCellCount());
+  DynBitset pointActivity;
+  VecFlt expected;
+  VecFlt values;
+  for (int step = 0; step < 4; ++step)
+  {
+    for (size_t i = 0; i < pointScalars.size(); ++i)
+      pointScalars[i] = static_cast<float>((i * (step + 3)) % 17) / 3.0f;
+    if (step == 2)
+    {
+      pointActivity.resize(ugrid->GetPointCount(), true);
+      pointActivity[30] = false;
+    }
+    searched->SetGridPointScalars(pointScalars, pointActivity, LOC_POINTS);
+    prepared->SetGridPointScalars(pointScalars, pointActivity, LOC_POINTS);
+    searched->ExtractData(expected);
+    prepared->ExtractData(values);
+    TS_ASSERT_EQUALS(expected, values);
+    TS_ASSERT_EQUALS(searched->GetCellIndexes(), prepared->GetCellIndexes());
+  }
+
+  // switch to cell scalars and new locations
+  locations = iBuildExtractLocations(rows, cols, 1500);
+  searched->SetExtractLocations(locations);
+  prepared->SetExtractLocations(locations);
+  DynBitset cellActivity;
+  for (int step = 0; step < 3; ++step)
+  {
+    for (size_t i = 0; i < cellScalars.size(); ++i)
+      cellScalars[i] = static_cast<float>((i * (step + 5)) % 23);
+    if (step == 1)
+    {
+      cellActivity.resize(ugrid->GetCellCount(), true);
+      cellActivity[7] = false;
+    }
+    searched->SetGridCellScalars(cellScalars, cellActivity, LOC_CELLS);
+    prepared->SetGridCellScalars(cellScalars, cellActivity, LOC_CELLS);
+    searched->ExtractData(expected);
+    prepared->ExtractData(values);
+    TS_ASSERT_EQUALS(expected, values);
+    TS_ASSERT_EQUALS(searched->GetCellIndexes(), prepared->GetCellIndexes());
+  }
+
+  prepared->SetThreadCount(3);
+  prepared->SetExtractLocations(iBuildExtractLocations(rows, cols, 1500));
+  prepared->ExtractData(values);
+  TS_ASSERT_EQUALS(expected, values);
+
+  // triangles given with the locations that don't contain them are ignored
+  prepared->SetExtractLocations(locations, VecInt(locations.size(), 0));
+  prepared->ExtractData(values);
+  TS_ASSERT_EQUALS(expected, values);
+  TS_ASSERT_EQUALS(searched->GetCellIndexes(), prepared->GetCellIndexes());
+} // XmUGrid2dDataExtractorUnitTests::testPreparedLocations
+//------------------------------------------------------------------------------
+/// \brief Test extracting several time steps at once gives the same results as
+///        setting scalars and extracting for each time step.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testExtractTimesteps()
+{
+  const int rows = 15;
+  const int cols = 20;
+  const size_t numTimesteps = 5;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, 1000);
+  locations.push_back(Pt3d(3.0, 4.0, 0.0)); // on a point shared by four cells
+  locations.push_back(Pt3d(3.0, 4.5, 0.0)); // on an edge shared by two cells
+  BSHP<XmUGrid2dDataExtractor> extractor = XmUGrid2dDataExtractor::New(ugrid);
+  BSHP<XmUGrid2dDataExtractor> batch = XmUGrid2dDataExtractor::New(ugrid);
+  extractor->SetExtractLocations(locations);
+  batch->SetExtractLocations(locations);
+  batch->SetThreadCount(2);
+
+  for (DataLocationEnum scalarLocation : {LOC_POINTS, LOC_CELLS})
+  {
+    size_t numValues = scalarLocation == LOC_POINTS ? ugrid->GetPointCount()
+                                                    : ugrid->GetCellCount();
+    VecFlt scalars(numTimesteps * numValues);
+    for (size_t i = 0; i < scalars.size(); ++i)
+      scalars[i] = static_cast<float>((i * 31) % 97) / 5.0f;
+
+    std::vector<DynBitset> activity(numTimesteps);
+    activity[1].resize(ugrid->GetCellCount(), true);
+    activity[1][2 * cols + 3] = false;
+    activity[2] = activity[1];
+    activity[3].resize(ugrid->GetCellCount(), true);
+    activity[3][3 * cols + 2] = false;
+    activity[3][4 * cols + 3] = false;
+
+    VecFlt expected;
+    VecFlt stepValues;
+    for (size_t stepIdx = 0; stepIdx < numTimesteps; ++stepIdx)
+    {
+      VecFlt stepScalars(scalars.begin() + stepIdx * numValues,
+                         scalars.begin() + (stepIdx + 1) * numValues);
+      if (scalarLocation == LOC_POINTS)
+        extractor->SetGridPointScalars(stepScalars, activity[stepIdx], LOC_CELLS);
+      else
+        extractor->SetGridCellScalars(stepScalars, activity[stepIdx], LOC_CELLS);
+      extractor->ExtractData(stepValues);
+      expected.insert(expected.end(), stepValues.begin(), stepValues.end());
+    }
+
+    VecFlt values;
+    batch->ExtractTimesteps(scalars, scalarLocation, activity, LOC_CELLS, values);
+    TS_ASSERT_EQUALS(expected, values);
+    TS_ASSERT_EQUALS(extractor->GetCellIndexes(), batch->GetCellIndexes());
+
+    // without activity
+    expected.clear();
+    for (size_t stepIdx = 0; stepIdx < numTimesteps; ++stepIdx)
+    {
+      VecFlt stepScalars(scalars.begin() + stepIdx * numValues,
+                         scalars.begin() + (stepIdx + 1) * numValues);
+      if (scalarLocation == LOC_POINTS)
+        extractor->SetGridPointScalars(stepScalars, DynBitset(), LOC_POINTS);
+      else
+        extractor->SetGridCellScalars(stepScalars, DynBitset(), LOC_CELLS);
+      extractor->ExtractData(stepValues);
+      expected.insert(expected.end(), stepValues.begin(), stepValues.end());
+    }
+    batch->ExtractTimesteps(scalars, scalarLocation, std::vector<DynBitset>(), LOC_CELLS,
+                            values);
+    TS_ASSERT_EQUALS(expected, values);
+  }
+
+  // point activity
+  VecFlt scalars(2 * ugrid->GetPointCount(), 1.5f);
+  std::vector<DynBitset> activity(2);
+  activity[0].resize(ugrid->GetPointCount(), true);
+  activity[0][4 * (cols + 1) + 3] = false;
+  VecFlt expected;
+  VecFlt stepValues;
+  for (size_t stepIdx = 0; stepIdx < 2; ++stepIdx)
+  {
+    VecFlt stepScalars(ugrid->GetPointCount(), 1.5f);
+    extractor->SetGridPointScalars(stepScalars, activity[stepIdx], LOC_POINTS);
+    extractor->ExtractData(stepValues);
+    expected.insert(expected.end(), stepValues.begin(), stepValues.end());
+  }
+  VecFlt values;
+  batch->ExtractTimesteps(scalars, LOC_POINTS, activity, LOC_POINTS, values);
+  TS_ASSERT_EQUALS(expected, values);
+
+  // scalars not a multiple of the point count
+  scalars.push_back(1.0f);
+  bool threw = false;
+  try
+  {
+    batch->ExtractTimesteps(scalars, LOC_POINTS, activity, LOC_POINTS, values);
+  }
+  catch (const std::invalid_argument&)
+  {
+    threw = true;
+  }
+  TS_ASSERT(threw);
+
+  // 3 time steps with activity for 2
+  scalars.resize(3 * ugrid->GetPointCount());
+  threw = false;
+  try
+  {
+    batch->ExtractTimesteps(scalars, LOC_POINTS, activity, LOC_POINTS, values);
+  }
+  catch (const std::invalid_argument&)
+  {
+    threw = true;
+  }
+  TS_ASSERT(threw);
+} // XmUGrid2dDataExtractorUnitTests::testExtractTimesteps
+//------------------------------------------------------------------------------
+/// \brief Test extracting at single locations from several threads leaves the
+///        extract locations alone and matches extracting at all locations.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testExtractAtLocation()
+{
+  const int rows = 10;
+  const int cols = 12;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  BSHP<XmUGrid2dDataExtractor> extractor = XmUGrid2dDataExtractor::New(ugrid);
+  VecFlt cellScalars(ugrid->GetCellCount());
+  for (size_t i = 0; i < cellScalars.size(); ++i)
+    cellScalars[i] = static_cast<float>(i % 11);
+  extractor->SetGridCellScalars(cellScalars, DynBitset(), LOC_CELLS);
+
+  VecPt3d locations = iBuildExtractLocations(rows, cols, 400);
+  extractor->SetExtractLocations(locations);
+  VecFlt expected;
+  extractor->ExtractData(expected);
+  VecInt expectedCellIdxs = extractor->GetCellIndexes();
+
+  const int numThreads = 4;
+  std::vector<VecFlt> threadValues(numThreads, VecFlt(locations.size()));
+  std::vector<std::thread> threads;
+  for (int threadIdx = 0; threadIdx < numThreads; ++threadIdx)
+  {
+    threads.emplace_back([&, threadIdx]() {
+      const XmUGrid2dDataExtractor& constExtractor = *extractor;
+      for (size_t i = 0; i < locations.size(); ++i)
+        threadValues[threadIdx][i] = constExtractor.ExtractAtLocation(locations[i]);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  for (int threadIdx = 0; threadIdx < numThreads; ++threadIdx)
+    TS_ASSERT_EQUALS(expected, threadValues[threadIdx]);
+  TS_ASSERT_EQUALS(locations, extractor->GetExtractLocations());
+  TS_ASSERT_EQUALS(expectedCellIdxs, extractor->GetCellIndexes());
+} // XmUGrid2dDataExtractorUnitTests::testExtractAtLocation
+//------------------------------------------------------------------------------
+/// \brief Test reading triangles from a cache file written by another
+///        extractor.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testTrianglesCacheFile()
+{
+  const std::string fileName = "XmUGrid2dDataExtractor_testTrianglesCacheFile.bin";
+  const std::string cellsFileName = fileName + ".cells";
+  const std::string pointsFileName = fileName + ".points";
+  std::remove(cellsFileName.c_str());
+  std::remove(pointsFileName.c_str());
+  const int rows = 8;
+  const int cols = 9;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, 300);
+  VecFlt cellScalars(ugrid->GetCellCount());
+  for (size_t i = 0; i < cellScalars.size(); ++i)
+    cellScalars[i] = static_cast<float>(i % 7);
+
+  BSHP<XmUGrid2dDataExtractor> built = XmUGrid2dDataExtractor::New(ugrid);
+  TS_ASSERT(built->GetTrianglesCacheFile().empty());
+  built->SetTrianglesCacheFile(fileName);
+  TS_ASSERT_EQUALS(fileName, built->GetTrianglesCacheFile());
+  built->SetGridCellScalars(cellScalars, DynBitset(), LOC_CELLS);
+  built->SetExtractLocations(locations);
+  VecFlt expected;
+  built->ExtractData(expected);
+  TS_ASSERT(std::ifstream(cellsFileName).good());
+  TS_ASSERT(!std::ifstream(pointsFileName).good());
+
+  BSHP<XmUGrid2dDataExtractor> read = XmUGrid2dDataExtractor::New(ugrid);
+  read->SetTrianglesCacheFile(fileName);
+  read->SetGridCellScalars(cellScalars, DynBitset(), LOC_CELLS);
+  read->SetExtractLocations(locations);
+  VecFlt values;
+  read->ExtractData(values);
+  TS_ASSERT_EQUALS(expected, values);
+  TS_ASSERT_EQUALS(built->GetUGridTriangles()->GetTriangles(),
+                   read->GetUGridTriangles()->GetTriangles());
+  TS_ASSERT_EQUALS(built->GetUGridTriangles()->GetPoints(),
+                   read->GetUGridTriangles()->GetPoints());
+
+  // point scalars need other triangles which are written to their own file
+  // leaving the cell scalar triangles to be read again
+  read->SetGridPointScalars(VecFlt(ugrid->GetPointCount(), 1.0f), DynBitset(), LOC_POINTS);
+  TS_ASSERT(XmUGridTriangles2d::New()->ReadFromFile(pointsFileName, *ugrid,
+                                                    XmUGridTriangles2d::PO_NO_POINTS));
+  TS_ASSERT(XmUGridTriangles2d::New()->ReadFromFile(cellsFileName, *ugrid,
+                                                    XmUGridTriangles2d::PO_CENTROIDS_ONLY));
+
+  // the cache is replaced rather than rewritten in place so a mapping of the
+  // old file is unchanged
+  {
+    XmMappedFile mappedFile;
+    TS_ASSERT(mappedFile.Open(cellsFileName));
+    std::string before(mappedFile.GetData(), mappedFile.GetSize());
+    BSHP<XmUGridTriangles2d> earcut = XmUGridTriangles2d::New();
+    earcut->BuildEarcutTriangles(*ugrid);
+    TS_ASSERT(earcut->WriteToFile(cellsFileName, *ugrid));
+    TS_ASSERT_EQUALS(before, std::string(mappedFile.GetData(), mappedFile.GetSize()));
+    TS_ASSERT(!XmUGridTriangles2d::New()->ReadFromFile(cellsFileName, *ugrid,
+                                                       XmUGridTriangles2d::PO_CENTROIDS_ONLY));
+  }
+  std::remove(cellsFileName.c_str());
+  std::remove(pointsFileName.c_str());
+} // XmUGrid2dDataExtractorUnitTests::testTrianglesCacheFile
+//------------------------------------------------------------------------------
+/// \brief Test setting scalars read in place from a memory mapped file.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testMappedScalars()
+{
+  const std::string fileName = "XmUGrid2dDataExtractor_testMappedScalars.bin";
+  const int rows = 6;
+  const int cols = 7;
+  const size_t numTimesteps = 3;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, 200);
+  DynBitset activity;
+  activity.resize(ugrid->GetCellCount(), true);
+  activity[cols + 2] = false;
+
+  for (DataLocationEnum scalarLocation : {LOC_POINTS, LOC_CELLS})
+  {
+    size_t numValues = scalarLocation == LOC_POINTS ? ugrid->GetPointCount()
+                                                    : ugrid->GetCellCount();
+    VecFlt scalars(numTimesteps * numValues);
+    for (size_t i = 0; i < scalars.size(); ++i)
+      scalars[i] = static_cast<float>((i * 17) % 23) / 3.0f;
+    {
+      std::ofstream file(fileName, std::ios::binary);
+      file.write(reinterpret_cast<const char*>(&scalars[0]), scalars.size() * sizeof(float));
+    }
+
+    XmMappedFile mappedFile;
+    TS_ASSERT(mappedFile.Open(fileName));
+    TS_ASSERT_EQUALS(scalars.size() * sizeof(float), mappedFile.GetSize());
+    const float* mappedScalars = reinterpret_cast<const float*>(mappedFile.GetData());
+
+    BSHP<XmUGrid2dDataExtractor> copied = XmUGrid2dDataExtractor::New(ugrid);
+    BSHP<XmUGrid2dDataExtractor> mapped = XmUGrid2dDataExtractor::New(ugrid);
+    copied->SetExtractLocations(locations);
+    mapped->SetExtractLocations(locations);
+    VecFlt expected;
+    VecFlt values;
+    for (size_t stepIdx = 0; stepIdx < numTimesteps; ++stepIdx)
+    {
+      VecFlt stepScalars(scalars.begin() + stepIdx * numValues,
+                         scalars.begin() + (stepIdx + 1) * numValues);
+      const float* stepMapped = mappedScalars + stepIdx * numValues;
+      if (scalarLocation == LOC_POINTS)
+      {
+        copied->SetGridPointScalars(stepScalars, activity, LOC_CELLS);
+        mapped->SetGridPointScalars(stepMapped, numValues, activity, LOC_CELLS);
+      }
+      else
+      {
+        copied->SetGridCellScalars(stepScalars, activity, LOC_CELLS);
+        mapped->SetGridCellScalars(stepMapped, numValues, activity, LOC_CELLS);
+      }
+      copied->ExtractData(expected);
+      mapped->ExtractData(values);
+      TS_ASSERT_EQUALS(expected, values);
+      TS_ASSERT_EQUALS(copied->GetScalars(), mapped->GetScalars());
+      TS_ASSERT_EQUALS(expected[0], mapped->ExtractAtLocation(locations[0]));
+    }
+
+    // wrong size
+    bool threw = false;
+    try
+    {
+      mapped->SetGridCellScalars(mappedScalars, numValues + 1, activity, LOC_CELLS);
+    }
+    catch (std::invalid_argument&)
+    {
+      threw = true;
+    }
+    TS_ASSERT(threw);
+  }
+  std::remove(fileName.c_str());
+} // XmUGrid2dDataExtractorUnitTests::testMappedScalars
+//------------------------------------------------------------------------------
+/// \brief Test setting point scalars from a vector that is taken over.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testMovedPointScalars()
+{
+  const int rows = 5;
+  const int cols = 6;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, 50);
+  VecFlt scalars(ugrid->GetPointCount());
+  for (size_t i = 0; i < scalars.size(); ++i)
+    scalars[i] = static_cast<float>((i * 7) % 11);
+  DynBitset activity;
+  activity.resize(ugrid->GetCellCount(), true);
+  activity[cols] = false;
+
+  BSHP<XmUGrid2dDataExtractor> copied = XmUGrid2dDataExtractor::New(ugrid);
+  copied->SetExtractLocations(locations);
+  copied->SetGridPointScalars(scalars, activity, LOC_CELLS);
+  VecFlt expected;
+  copied->ExtractData(expected);
+
+  BSHP<XmUGrid2dDataExtractor> moved = XmUGrid2dDataExtractor::New(ugrid);
+  moved->SetExtractLocations(locations);
+  VecFlt movedScalars = scalars;
+  moved->SetGridPointScalars(std::move(movedScalars), activity, LOC_CELLS);
+  TS_ASSERT(movedScalars.empty());
+  VecFlt values;
+  moved->ExtractData(values);
+  TS_ASSERT_EQUALS(expected, values);
+  TS_ASSERT_EQUALS(copied->GetScalars(), moved->GetScalars());
+
+  // the polyline extractor takes point scalars over too
+  BSHP<XmUGrid2dPolylineDataExtractor> polyline =
+    XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  movedScalars = scalars;
+  polyline->SetGridScalars(std::move(movedScalars), activity, LOC_CELLS);
+  TS_ASSERT(movedScalars.empty());
+  TS_ASSERT_EQUALS(copied->GetScalars(), polyline->GetScalars());
+} // XmUGrid2dDataExtractorUnitTests::testMovedPointScalars
+//------------------------------------------------------------------------------
+/// \brief Test changing the activity of a few cells or points.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testUpdateGridActivity()
+{
+  const int rows = 7;
+  const int cols = 8;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, 300);
+  VecFlt pointScalars(ugrid->GetPointCount());
+  for (size_t i = 0; i < pointScalars.size(); ++i)
+    pointScalars[i] = static_cast<float>((i * 13) % 11);
+  VecFlt cellScalars(ugrid->GetCellCount());
+  for (size_t i = 0; i < cellScalars.size(); ++i)
+    cellScalars[i] = static_cast<float>((i * 7) % 5);
+
+  for (DataLocationEnum activityLocation : {LOC_CELLS, LOC_POINTS})
+  {
+    size_t numActivity = activityLocation == LOC_CELLS ? ugrid->GetCellCount()
+                                                       : ugrid->GetPointCount();
+    DynBitset before;
+    before.resize(numActivity, true);
+    before[cols + 1] = false;
+    before[2 * cols + 4] = false;
+    DynBitset after = before;
+    after[cols + 1] = true;
+    after[3 * cols + 2] = false;
+    after[4 * cols + 5] = false;
+    VecInt changedIdxs = {cols + 1, 3 * cols + 2, 4 * cols + 5};
+
+    for (int scalarCase = 0; scalarCase < 3; ++scalarCase)
+    {
+      BSHP<XmUGrid2dDataExtractor> updated = XmUGrid2dDataExtractor::New(ugrid);
+      BSHP<XmUGrid2dDataExtractor> expected = XmUGrid2dDataExtractor::New(ugrid);
+      updated->SetExtractLocations(locations);
+      expected->SetExtractLocations(locations);
+      updated->SetUsePreparedLocations(true);
+      updated->SetUseIdwForPointData(scalarCase == 2);
+      expected->SetUseIdwForPointData(scalarCase == 2);
+      VecFlt values;
+      if (scalarCase == 0)
+      {
+        updated->SetGridPointScalars(pointScalars, before, activityLocation);
+        updated->ExtractData(values);
+        updated->UpdateGridActivity(changedIdxs, after, activityLocation);
+        expected->SetGridPointScalars(pointScalars, after, activityLocation);
+      }
+      else
+      {
+        updated->SetGridCellScalars(cellScalars, before, activityLocation);
+        updated->ExtractData(values);
+        updated->UpdateGridActivity(changedIdxs, after, activityLocation);
+        expected->SetGridCellScalars(cellScalars, after, activityLocation);
+      }
+      VecFlt expectedValues;
+      expected->ExtractData(expectedValues);
+      updated->ExtractData(values);
+      TS_ASSERT_EQUALS(expectedValues, values);
+      TS_ASSERT_EQUALS(expected->GetScalars(), updated->GetScalars());
+      TS_ASSERT_EQUALS(expected->GetCellIndexes(), updated->GetCellIndexes());
+    }
+  }
+
+  // bad index
+  BSHP<XmUGrid2dDataExtractor> extractor = XmUGrid2dDataExtractor::New(ugrid);
+  extractor->SetGridCellScalars(cellScalars, DynBitset(), LOC_CELLS);
+  bool threw = false;
+  try
+  {
+    extractor->UpdateGridActivity({ugrid->GetCellCount()}, DynBitset(), LOC_CELLS);
+  }
+  catch (std::invalid_argument&)
+  {
+    threw = true;
+  }
+  TS_ASSERT(threw);
+} // XmUGrid2dDataExtractorUnitTests::testUpdateGridActivity
+//------------------------------------------------------------------------------
+/// \brief Test changing some of the point or cell scalars.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testUpdateGridScalars()
+{
+  const int rows = 6;
+  const int cols = 9;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, 300);
+  DynBitset activity;
+  activity.resize(ugrid->GetCellCount(), true);
+  activity[2 * cols + 3] = false;
+  VecInt idxs = {cols + 1, 2 * cols + 3, 3 * cols + 4, 4 * cols + 6};
+  VecFlt updates = {9.5f, -2.0f, 7.25f, 4.0f};
+
+  for (int scalarCase = 0; scalarCase < 3; ++scalarCase)
+  {
+    DataLocationEnum scalarLocation = scalarCase == 0 ? LOC_POINTS : LOC_CELLS;
+    size_t numValues = scalarLocation == LOC_POINTS ? ugrid->GetPointCount()
+                                                    : ugrid->GetCellCount();
+    VecFlt scalars(numValues);
+    for (size_t i = 0; i < scalars.size(); ++i)
+      scalars[i] = static_cast<float>((i * 11) % 13);
+    VecFlt updatedScalars = scalars;
+    for (size_t i = 0; i < idxs.size(); ++i)
+      updatedScalars[idxs[i]] = updates[i];
+
+    BSHP<XmUGrid2dDataExtractor> updated = XmUGrid2dDataExtractor::New(ugrid);
+    BSHP<XmUGrid2dDataExtractor> expected = XmUGrid2dDataExtractor::New(ugrid);
+    updated->SetExtractLocations(locations);
+    expected->SetExtractLocations(locations);
+    updated->SetUsePreparedLocations(true);
+    updated->SetUseIdwForPointData(scalarCase == 2);
+    expected->SetUseIdwForPointData(scalarCase == 2);
+    VecFlt values;
+    if (scalarLocation == LOC_POINTS)
+    {
+      // scalars read in place are copied rather than changed
+      updated->SetGridPointScalars(scalars.data(), scalars.size(), activity, LOC_CELLS);
+      expected->SetGridPointScalars(updatedScalars, activity, LOC_CELLS);
+    }
+    else
+    {
+      updated->SetGridCellScalars(scalars, activity, LOC_CELLS);
+      expected->SetGridCellScalars(updatedScalars, activity, LOC_CELLS);
+    }
+    updated->ExtractData(values);
+    updated->UpdateGridScalars(idxs, updates);
+    updated->ExtractData(values);
+    VecFlt expectedValues;
+    expected->ExtractData(expectedValues);
+    TS_ASSERT_EQUALS(expectedValues, values);
+    TS_ASSERT_EQUALS(expected->GetScalars(), updated->GetScalars());
+    TS_ASSERT_EQUALS(static_cast<float>((idxs[0] * 11) % 13), scalars[idxs[0]]);
+  }
+
+  // the centroid of the C shaped cell 0 is outside of it so it has no centroid
+  // point to keep its scalar in
+  {
+    VecPt3d points = {{0, 0, 0}, {3, 0, 0}, {3, 1, 0}, {1, 1, 0},
+                      {1, 2, 0}, {3, 2, 0}, {3, 3, 0}, {0, 3, 0}};
+    VecInt cells = {XMU_POLYGON, 8, 0, 1, 2, 3, 4, 5, 6, 7, XMU_QUAD, 4, 3, 2, 5, 4};
+    std::shared_ptr<XmUGrid> cShape = XmUGrid::New(points, cells);
+    BSHP<XmUGrid2dDataExtractor> updated = XmUGrid2dDataExtractor::New(cShape);
+    updated->SetGridCellScalars({2, 6}, DynBitset(), LOC_CELLS);
+    TS_ASSERT_EQUALS(-1, updated->GetUGridTriangles()->GetCellCentroid(0));
+    updated->UpdateGridScalars({1}, {10});
+    updated->UpdateGridScalars({0}, {4});
+    BSHP<XmUGrid2dDataExtractor> expected = XmUGrid2dDataExtractor::New(cShape);
+    expected->SetGridCellScalars({4, 10}, DynBitset(), LOC_CELLS);
+    TS_ASSERT_EQUALS(expected->GetScalars(), updated->GetScalars());
+  }
+
+  // mismatched sizes
+  BSHP<XmUGrid2dDataExtractor> extractor = XmUGrid2dDataExtractor::New(ugrid);
+  extractor->SetGridCellScalars(VecFlt(ugrid->GetCellCount(), 1.0f), DynBitset(), LOC_CELLS);
+  bool threw = false;
+  try
+  {
+    extractor->UpdateGridScalars({0, 1}, {2.0f});
+  }
+  catch (std::invalid_argument&)
+  {
+    threw = true;
+  }
+  TS_ASSERT(threw);
+} // XmUGrid2dDataExtractorUnitTests::testUpdateGridScalars
+//------------------------------------------------------------------------------
+/// \brief Test calculating point scalars from cell scalars with the cell to
+///        point operator when the averaging mode and thread count change.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testCellToPointOperator()
+{
+  const int rows = 40;
+  const int cols = 50;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  int numCells = ugrid->GetCellCount();
+  int numPoints = ugrid->GetPointCount();
+  VecFlt cellScalars(numCells);
+  for (int i = 0; i < numCells; ++i)
+    cellScalars[i] = static_cast<float>((i * 19) % 23) / 4.0f;
+  DynBitset activity;
+  activity.resize(numCells, true);
+  for (int i = 0; i < numCells; i += 7)
+    activity[i] = false;
+
+  BSHP<XmUGrid2dDataExtractor> extractor = XmUGrid2dDataExtractor::New(ugrid);
+  extractor->SetNoDataValue(-9.0f);
+  extractor->SetGridCellScalars(cellScalars, activity, LOC_CELLS);
+  VecFlt averaged = extractor->GetScalars();
+
+  // average of the active cells around each point
+  VecFlt expected(numPoints);
+  VecInt cellIdxs;
+  for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+  {
+    ugrid->GetPointAdjacentCells(pointIdx, cellIdxs);
+    double sum = 0.0;
+    int count = 0;
+    for (auto cellIdx : cellIdxs)
+    {
+      if (activity[cellIdx])
+      {
+        sum += cellScalars[cellIdx];
+        ++count;
+      }
+    }
+    expected[pointIdx] = count ? static_cast<float>(sum / count) : -9.0f;
+  }
+  TS_ASSERT_EQUALS(expected, VecFlt(averaged.begin(), averaged.begin() + numPoints));
+
+  // switching to IDW rebuilds the operator, centroids are the same distance
+  // from each point of a uniform grid so IDW gives the average
+  extractor->SetUseIdwForPointData(true);
+  extractor->SetGridCellScalars(cellScalars, activity, LOC_CELLS);
+  VecFlt idw = extractor->GetScalars();
+  TS_ASSERT_DELTA_VEC(averaged, idw, 1.0e-5);
+
+  for (bool useIdw : {false, true})
+  {
+    BSHP<XmUGrid2dDataExtractor> threaded = XmUGrid2dDataExtractor::New(ugrid);
+    threaded->SetNoDataValue(-9.0f);
+    threaded->SetUseIdwForPointData(useIdw);
+    threaded->SetThreadCount(4);
+    threaded->SetGridCellScalars(cellScalars, activity, LOC_CELLS);
+    TS_ASSERT_EQUALS(useIdw ? idw : averaged, threaded->GetScalars());
+  }
+} // XmUGrid2dDataExtractorUnitTests::testCellToPointOperator
+//------------------------------------------------------------------------------
+/// \brief Test IDW point scalars from cell scalars against values computed
+///        by hand, and that copied extractors share the cell to point
+///        operator of their triangles.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorUnitTests::testCellToPointOperatorIdw()
+{
+  // clang-format off
+  //  3----4---------5
+  //  |    |         |
+  //  | 0  |    1    |
+  //  |    |         |
+  //  0----1---------2
+  //
+  // centroid of cell 0 is (0.5, 0.5) and of cell 1 is (2.0, 0.5). Points 1 and
+  // 4 are 0.5 squared from centroid 0 and 1.25 squared from centroid 1 so
+  // their weights are 2/2.8 and 0.8/2.8 and their value is
+  // (1 * 2 + 8 * 0.8) / 2.8 = 3.
+  VecPt3d points = {{0, 0, 0}, {1, 0, 0}, {3, 0, 0},
+                    {0, 1, 0}, {1, 1, 0}, {3, 1, 0}};
+  VecInt cells = {XMU_QUAD, 4, 0, 1, 4, 3,
+                  XMU_QUAD, 4, 1, 2, 5, 4};
+  // clang-format on
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  BSHP<XmUGrid2dDataExtractor> extractor = XmUGrid2dDataExtractor::New(ugrid);
+  extractor->SetNoDataValue(-9.0f);
+  extractor->SetUseIdwForPointData(true);
+  extractor->SetGridCellScalars({1, 8}, DynBitset(), LOC_CELLS);
+  VecFlt scalars = extractor->GetScalars();
+  VecFlt expected = {1, 3, 8, 1, 3, 8};
+  TS_ASSERT_DELTA_VEC(expected, VecFlt(scalars.begin(), scalars.begin() + 6), 1.0e-5);
+
+  // cell 0 inactive leaves only cell 1 for points 1 and 4
+  DynBitset activity;
+  activity.resize(2, true);
+  activity[0] = false;
+  extractor->SetGridCellScalars({1, 8}, activity, LOC_CELLS);
+  scalars = extractor->GetScalars();
+  expected = {-9, 8, 8, -9, 8, 8};
+  TS_ASSERT_DELTA_VEC(expected, VecFlt(scalars.begin(), scalars.begin() + 6), 1.0e-5);
+
+  // updating the activity gives the same values at the points of the cell
+  extractor->SetGridCellScalars({1, 8}, DynBitset(), LOC_CELLS);
+  extractor->UpdateGridActivity({0}, activity, LOC_CELLS);
+  scalars = extractor->GetScalars();
+  TS_ASSERT_DELTA_VEC(expected, VecFlt(scalars.begin(), scalars.begin() + 6), 1.0e-5);
+
+  // a copy shares the triangles and the operator built for them
+  BSHP<XmUGrid2dDataExtractor> copy = XmUGrid2dDataExtractor::New(extractor);
+  copy->SetGridCellScalars({1, 8}, DynBitset(), LOC_CELLS);
+  BSHP<XmUGridTriangles2d> triangles = extractor->GetUGridTriangles();
+  TS_ASSERT_EQUALS(triangles, copy->GetUGridTriangles());
+  TS_ASSERT_EQUALS(triangles->GetCellToPointOperator(*ugrid, true),
+                   triangles->GetCellToPointOperator(*ugrid, true));
+  scalars = copy->GetScalars();
+  expected = {1, 3, 8, 1, 3, 8};
+  TS_ASSERT_DELTA_VEC(expected, VecFlt(scalars.begin(), scalars.begin() + 6), 1.0e-5);
+} // XmUGrid2dDataExtractorUnitTests::testCellToPointOperatorIdw
+//------------------------------------------------------------------------------
 /// \brief Test XmUGrid2dDataExtractor for tutorial.
 //------------------------------------------------------------------------------
 //! [snip_test_Example_TransientLocationExtractor]
@@ -1310,4 +2886,113 @@ void XmUGrid2dDataExtractorUnitTests::testTutorial()
 } // XmUGrid2dDataExtractorUnitTests::testTutorial
 //! [snip_test_Example_TransientLocationExtractor]
 
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmUGrid2dDataExtractorIntermediateTests
+/// \brief Longer running tests of XmUGrid2dDataExtractor on large grids.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Benchmark interpolating at prepared locations against searching for
+///        each location.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorIntermediateTests::testGatherThroughput()
+{
+  const int rows = 500;
+  const int cols = 500;
+  const int numLocations = 1000003;
+  const int numRepeats = 20;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, numLocations);
+  VecFlt pointScalars(ugrid->GetPointCount());
+  for (size_t i = 0; i < pointScalars.size(); ++i)
+    pointScalars[i] = static_cast<float>((i * 37) % 101) / 7.0f;
+
+  BSHP<XmUGrid2dDataExtractor> searched = XmUGrid2dDataExtractor::New(ugrid);
+  searched->SetExtractLocations(locations);
+  searched->SetGridPointScalars(pointScalars, DynBitset(), LOC_POINTS);
+  VecFlt expected;
+  auto start = std::chrono::steady_clock::now();
+  searched->ExtractData(expected);
+  std::chrono::duration<double> searchTime = std::chrono::steady_clock::now() - start;
+
+  BSHP<XmUGrid2dDataExtractor> prepared = XmUGrid2dDataExtractor::New(ugrid);
+  prepared->SetUsePreparedLocations(true);
+  prepared->SetExtractLocations(locations);
+  prepared->SetGridPointScalars(pointScalars, DynBitset(), LOC_POINTS);
+  VecFlt values;
+  prepared->ExtractData(values);
+  TS_ASSERT_EQUALS(expected, values);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < numRepeats; ++i)
+    prepared->ExtractData(values);
+  std::chrono::duration<double> gatherTime = std::chrono::steady_clock::now() - start;
+  TS_ASSERT_EQUALS(expected, values);
+
+  std::ostringstream msg;
+  msg << "searched: " << numLocations / searchTime.count() << " points/sec, prepared: "
+      << numRepeats * numLocations / gatherTime.count() << " points/sec";
+  TS_TRACE(msg.str());
+} // XmUGrid2dDataExtractorIntermediateTests::testGatherThroughput
+//------------------------------------------------------------------------------
+/// \brief Benchmark changing the activity of a few cells with prepared
+///        locations, which only locates the locations near the cells again,
+///        against setting the activity, which locates every location again.
+//------------------------------------------------------------------------------
+void XmUGrid2dDataExtractorIntermediateTests::testUpdateGridActivityLargeGrid()
+{
+  const int rows = 500;
+  const int cols = 500;
+  const int numLocations = 1000003;
+  const int numRepeats = 10;
+  std::shared_ptr<XmUGrid> ugrid = iBuildQuadUGrid(rows, cols);
+  VecPt3d locations = iBuildExtractLocations(rows, cols, numLocations);
+  int numCells = ugrid->GetCellCount();
+  VecFlt cellScalars(numCells);
+  for (int i = 0; i < numCells; ++i)
+    cellScalars[i] = static_cast<float>((i * 37) % 101) / 7.0f;
+
+  BSHP<XmUGrid2dDataExtractor> updated = XmUGrid2dDataExtractor::New(ugrid);
+  BSHP<XmUGrid2dDataExtractor> set = XmUGrid2dDataExtractor::New(ugrid);
+  for (auto extractor : {updated, set})
+  {
+    extractor->SetUsePreparedLocations(true);
+    extractor->SetExtractLocations(locations);
+    extractor->SetGridCellScalars(cellScalars, DynBitset(), LOC_CELLS);
+    VecFlt values;
+    extractor->ExtractData(values);
+  }
+
+  DynBitset activity;
+  activity.resize(numCells, true);
+  std::chrono::duration<double> updateTime(0);
+  std::chrono::duration<double> setTime(0);
+  VecFlt updatedValues;
+  VecFlt setValues;
+  for (int i = 0; i < numRepeats; ++i)
+  {
+    VecInt changedCells = {(i * 7919) % numCells, (i * 104729) % numCells, i * cols + i};
+    for (auto cellIdx : changedCells)
+      activity[cellIdx] = !activity[cellIdx];
+
+    auto start = std::chrono::steady_clock::now();
+    updated->UpdateGridActivity(changedCells, activity, LOC_CELLS);
+    updated->ExtractData(updatedValues);
+    updateTime += std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    set->SetGridCellScalars(cellScalars, activity, LOC_CELLS);
+    set->ExtractData(setValues);
+    setTime += std::chrono::steady_clock::now() - start;
+
+    TS_ASSERT_EQUALS(setValues, updatedValues);
+    TS_ASSERT_EQUALS(set->GetCellIndexes(), updated->GetCellIndexes());
+  }
+
+  std::ostringstream msg;
+  msg << "changing 3 cells with " << numLocations << " prepared locations: update "
+      << updateTime.count() / numRepeats << " seconds, set "
+      << setTime.count() / numRepeats << " seconds";
+  TS_TRACE(msg.str());
+} // XmUGrid2dDataExtractorIntermediateTests::testUpdateGridActivityLargeGrid
+
 #endif
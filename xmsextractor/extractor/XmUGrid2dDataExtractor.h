@@ -10,6 +10,7 @@
 //----- Included files ---------------------------------------------------------
 
 // 3. Standard library headers
+#include <string>
 
 // 4. External library headers
 
@@ -61,17 +62,87 @@ public:
   virtual void SetGridCellScalars(const VecFlt& a_cellScalars,
                                   const DynBitset& a_activity,
                                   DataLocationEnum a_activityType) = 0;
+  /// \brief Setup point scalars taking over the vector instead of copying it.
+  /// \param[in] a_pointScalars The point scalars.
+  /// \param[in] a_activity The activity of the cells.
+  /// \param[in] a_activityType The location at which the data is currently stored.
+  virtual void SetGridPointScalars(VecFlt&& a_pointScalars,
+                                   const DynBitset& a_activity,
+                                   DataLocationEnum a_activityType) = 0;
+  /// \brief Setup point scalars that are read in place rather than copied,
+  ///        such as a time step in a memory mapped dataset file.
+  /// \param[in] a_pointScalars The point scalars. They must stay valid and
+  ///            unchanged until other scalars are set.
+  /// \param[in] a_numScalars The number of point scalars.
+  /// \param[in] a_activity The activity of the cells.
+  /// \param[in] a_activityType The location at which the data is currently stored.
+  virtual void SetGridPointScalars(const float* a_pointScalars,
+                                   size_t a_numScalars,
+                                   const DynBitset& a_activity,
+                                   DataLocationEnum a_activityType) = 0;
+  /// \brief Setup cell scalars without copying them into a vector. The values
+  ///        are only read during the call.
+  /// \param[in] a_cellScalars The cell scalars.
+  /// \param[in] a_numScalars The number of cell scalars.
+  /// \param[in] a_activity The activity of the cells.
+  /// \param[in] a_activityType The location at which the data is currently stored.
+  virtual void SetGridCellScalars(const float* a_cellScalars,
+                                  size_t a_numScalars,
+                                  const DynBitset& a_activity,
+                                  DataLocationEnum a_activityType) = 0;
+  /// \brief Change the activity of a few cells or points without setting the
+  ///        scalars again. Only the cells touching the changed ids and the
+  ///        scalars derived from them are updated.
+  /// \param[in] a_changedIdxs The cells or points whose activity changed.
+  /// \param[in] a_activity The new activity of every cell or point. Empty for
+  ///            all active.
+  /// \param[in] a_activityType The location of the activity (points or cells).
+  virtual void UpdateGridActivity(const VecInt& a_changedIdxs,
+                                  const DynBitset& a_activity,
+                                  DataLocationEnum a_activityType) = 0;
+  /// \brief Change some of the scalars without setting all of them again.
+  ///        Only the values derived from the changed scalars are updated.
+  /// \param[in] a_idxs The points or cells (matching the current scalars) of
+  ///            the changed values.
+  /// \param[in] a_values The new value for each index.
+  virtual void UpdateGridScalars(const VecInt& a_idxs, const VecFlt& a_values) = 0;
 
   /// \brief Sets locations of points to extract interpolated scalar data from.
   /// \param[in] a_locations The locations.
   virtual void SetExtractLocations(const VecPt3d& a_locations) = 0;
+  /// \brief Sets locations to extract interpolated scalar data from along with
+  ///        a triangle expected to contain each one, such as one found while
+  ///        traversing a polyline. Locations in their triangle aren't searched
+  ///        for.
+  /// \param[in] a_locations The locations.
+  /// \param[in] a_triangleIdxs The triangle of each location (index of the
+  ///            triangle, not of its first point) or -1 to search.
+  virtual void SetExtractLocations(const VecPt3d& a_locations, const VecInt& a_triangleIdxs) = 0;
   /// \brief Extract interpolated data for the previously set locations.
   /// \param[out] a_outData The interpolated scalars.
   virtual void ExtractData(VecFlt& a_outData) = 0;
-  /// \brief Extract interpolated data for the previously set locations.
+  /// \brief Extract interpolated data at a single location. Doesn't change
+  ///        the extract locations and can be called from several threads at
+  ///        once.
   /// \param[in] a_location The location to get the interpolated scalar.
   /// \return The interpolated value.
-  virtual float ExtractAtLocation(const Pt3d& a_location) = 0;
+  virtual float ExtractAtLocation(const Pt3d& a_location) const = 0;
+  /// \brief Extract interpolated data at the extract locations for several
+  ///        time steps of point or cell scalars. Gives the same values as
+  ///        setting the scalars and extracting for each time step.
+  /// \param[in] a_scalars The scalars for every time step stored one time step
+  ///            after another ([time steps x values]).
+  /// \param[in] a_scalarLocation Whether the scalars are at points or cells.
+  /// \param[in] a_activity The activity for each time step. Empty for all
+  ///            active, otherwise one (possibly empty) activity per time step.
+  /// \param[in] a_activityLocation The location of the activity.
+  /// \param[out] a_outData The interpolated scalars stored one time step after
+  ///             another ([time steps x locations]).
+  virtual void ExtractTimesteps(const VecFlt& a_scalars,
+                                DataLocationEnum a_scalarLocation,
+                                const std::vector<DynBitset>& a_activity,
+                                DataLocationEnum a_activityLocation,
+                                VecFlt& a_outData) = 0;
 
   /// \brief Set to use IDW to calculate point scalar values from cell scalars.
   /// \param a_useIdw Whether to turn IDW on or off.
@@ -80,6 +151,24 @@ public:
   ///        intersect with the grid.
   /// \param[in] a_noDataValue The no data value
   virtual void SetNoDataValue(float a_noDataValue) = 0;
+  /// \brief Set the number of threads used to build triangles and extract
+  ///        data.
+  /// \param[in] a_numThreads The number of threads. One (the default) extracts
+  ///            serially. Zero or less uses the number of hardware threads.
+  virtual void SetThreadCount(int a_numThreads) = 0;
+  /// \brief Set to locate the extract locations once and reuse the
+  ///        interpolation points and weights until the locations, triangles or
+  ///        activity change.
+  /// \param[in] a_usePrepared Whether to turn prepared locations on or off.
+  virtual void SetUsePreparedLocations(bool a_usePrepared) = 0;
+  /// \brief Set a file to keep the triangles in between runs. Triangles are
+  ///        read from the file when it was written for the same UGrid,
+  ///        otherwise they are built and written to it. Triangles for cell
+  ///        scalars are kept in a_fileName + ".cells" and for point scalars in
+  ///        a_fileName + ".points". Reading only skips the triangulation; the
+  ///        triangle search is still built on the first extract.
+  /// \param[in] a_fileName The file name. Empty to always build triangles.
+  virtual void SetTrianglesCacheFile(const std::string& a_fileName) = 0;
 
   /// \brief Build triangles for UGrid for either point or cell scalars.
   /// \param[in] a_location Location to build on (points or cells).
@@ -88,9 +177,9 @@ public:
   /// \return Shared pointer to triangles.
   virtual const BSHP<XmUGridTriangles2d> GetUGridTriangles() const = 0;
 
-  /// \brief Gets the scalars
+  /// \brief Gets a copy of the scalars at the triangle points.
   /// \return The scalars.
-  virtual const VecFlt& GetScalars() const = 0;
+  virtual VecFlt GetScalars() const = 0;
   /// \brief Gets the location of the scalars (points or cells)
   /// \return The location of the scalars.
   virtual DataLocationEnum GetScalarLocation() const = 0;
@@ -106,6 +195,15 @@ public:
   /// \brief Gets the no data value
   /// \return The no data value.
   virtual float GetNoDataValue() const = 0;
+  /// \brief Gets the number of threads used to extract data.
+  /// \return The thread count.
+  virtual int GetThreadCount() const = 0;
+  /// \brief Gets the option for using prepared locations.
+  /// \return The option.
+  virtual bool GetUsePreparedLocations() const = 0;
+  /// \brief Gets the file used to keep the triangles in between runs.
+  /// \return The file name or empty if not used.
+  virtual const std::string& GetTrianglesCacheFile() const = 0;
 
 private:
   XM_DISALLOW_COPY_AND_ASSIGN(XmUGrid2dDataExtractor)
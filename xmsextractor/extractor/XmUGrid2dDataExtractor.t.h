@@ -44,8 +44,29 @@ public:
   void testChangingScalarsAndActivity();
 
   void testCopiedExtractor();
+  void testCopiedExtractorsWithDifferentActivity();
+
+  void testMultithreadedExtraction();
+  void testPreparedLocations();
+  void testExtractTimesteps();
+  void testExtractAtLocation();
+  void testTrianglesCacheFile();
+  void testMappedScalars();
+  void testMovedPointScalars();
+  void testUpdateGridActivity();
+  void testUpdateGridScalars();
+  void testCellToPointOperator();
+  void testCellToPointOperatorIdw();
 
   void testTutorial();
 }; // XmUGrid2dDataExtractorUnitTests
 
+////////////////////////////////////////////////////////////////////////////////
+class XmUGrid2dDataExtractorIntermediateTests : public CxxTest::TestSuite
+{
+public:
+  void testGatherThroughput();
+  void testUpdateGridActivityLargeGrid();
+}; // XmUGrid2dDataExtractorIntermediateTests
+
 #endif
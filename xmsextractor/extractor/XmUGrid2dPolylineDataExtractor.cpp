@@ -13,13 +13,20 @@
 #include <xmsextractor/extractor/XmUGrid2dPolylineDataExtractor.h>
 
 // 3. Standard library headers
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
 
 // 4. External library headers
 
 // 5. Shared code headers
+#include <xmscore/misc/XmError.h>
 #include <xmscore/misc/XmLog.h>
 #include <xmsextractor/extractor/XmUGrid2dDataExtractor.h>
+#include <xmsextractor/misc/XmParallel.h>
 #include <xmsextractor/ugrid/XmUGridTriangles2d.h>
 #include <xmsgrid/ugrid/XmUGrid.h>
 #include <xmsgrid/geometry/GmMultiPolyIntersector.h>
@@ -46,6 +53,58 @@ namespace xms
 
 namespace
 {
+/// Smallest number of polylines given to a thread.
+const size_t MIN_POLYLINES_PER_THREAD = 16;
+/// Smallest number of triangles given to a thread when building polygons.
+const size_t MIN_POLYGONS_PER_THREAD = 4096;
+/// Tolerance, as a fraction of the segment length, used when walking cells.
+const double WALK_TOLERANCE = 1.0e-9;
+/// Most intersectors built for one set of triangles. Each GmMultiPolyIntersector
+/// holds its own copy of the triangle points and polygons, so this caps the
+/// copies of the mesh and the number of polylines traversed at once.
+const int MAX_INTERSECTORS = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+/// The intersectors built for a set of triangles, shared by polyline extractors
+/// copied from one another. GmMultiPolyIntersector keeps traversal state
+/// between calls and xmsgrid has no way to share one tree between callers, so
+/// this is a pool of at most MAX_INTERSECTORS. Each is built once and handed
+/// from caller to caller.
+struct XmSharedIntersector
+{
+  BSHP<XmUGridTriangles2d> triangles; ///< the triangles the intersectors are for
+  std::vector<BSHP<GmMultiPolyIntersector>> idle; ///< intersectors not in use
+  int numBuilt = 0;   ///< intersectors built for the triangles
+  int totalBuilt = 0; ///< intersectors ever built, for testing
+  std::mutex mutex;   ///< held while taking or giving back an intersector,
+                      ///  never while building one or traversing
+  std::condition_variable released; ///< signaled when one is given back
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// An intersector taken from the pool by one call on one thread, which
+/// traverses without locking. It is given back to the pool when released. A
+/// thread must only hold one lease at a time since it may wait for another
+/// to be given back.
+class XmIntersectorLease
+{
+public:
+  explicit XmIntersectorLease(BSHP<XmSharedIntersector> a_shared);
+  ~XmIntersectorLease();
+
+  GmMultiPolyIntersector& Get(BSHP<XmUGridTriangles2d> a_triangles, int a_numThreads);
+  void Release();
+
+private:
+  XM_DISALLOW_COPY_AND_ASSIGN(XmIntersectorLease)
+
+  BSHP<XmSharedIntersector> m_shared;       ///< where the intersector is from
+  BSHP<XmUGridTriangles2d> m_triangles;     ///< the triangles it was built for
+  BSHP<GmMultiPolyIntersector> m_intersector; ///< the intersection tool used from
+                                              ///  xmsgrid to find the
+                                              ///  intersections with the polyline
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Implementation for XmUGrid2dPolylineDataExtractor
 class XmUGrid2dPolylineDataExtractorImpl : public XmUGrid2dPolylineDataExtractor
@@ -53,6 +112,7 @@ class XmUGrid2dPolylineDataExtractorImpl : public XmUGrid2dPolylineDataExtractor
 public:
   XmUGrid2dPolylineDataExtractorImpl(std::shared_ptr<XmUGrid> a_ugrid,
                                      DataLocationEnum a_scalarLocation);
+  XmUGrid2dPolylineDataExtractorImpl(BSHP<XmUGrid2dPolylineDataExtractorImpl> a_extractor);
   /// \brief Gets the underlying data extractor. Convenience so a user would not have to
   /// create a new if this one existed.
   /// \return shared pointer to a data extractor
@@ -60,6 +120,9 @@ public:
   virtual void SetGridScalars(const VecFlt& a_pointScalars,
                               const DynBitset& a_activity,
                               DataLocationEnum a_activityLocation) override;
+  virtual void SetGridScalars(VecFlt&& a_scalars,
+                              const DynBitset& a_activity,
+                              DataLocationEnum a_activityLocation) override;
 
   virtual void SetPolyline(const VecPt3d& a_polyline) override;
   virtual void ExtractData(VecFlt& a_extractedData) override;
@@ -67,13 +130,37 @@ public:
   virtual void ComputeLocationsAndExtractData(const VecPt3d& a_polyline,
                                               VecFlt& a_extractedData,
                                               VecPt3d& a_extractedLocations) override;
+  virtual void ExtractPolylines(const VecInt& a_polylineOffsets,
+                                const VecPt3d& a_polylinePoints,
+                                VecInt& a_locationOffsets,
+                                VecPt3d& a_locations,
+                                VecFlt& a_extractedData,
+                                VecInt& a_cellIdxs) override;
 
   virtual void SetUseIdwForPointData(bool a_useIdw) override;
   virtual void SetNoDataValue(float a_noDataValue) override;
+  /// \brief Set to walk cells to find polyline locations.
+  /// \param[in] a_useCellWalking Whether to turn cell walking on or off.
+  virtual void SetUseCellWalking(bool a_useCellWalking) override
+  {
+    m_useCellWalking = a_useCellWalking;
+  }
+  /// \brief Set a station spacing at which to add locations.
+  /// \param[in] a_spacing The spacing. Zero or less for none.
+  virtual void SetSampleSpacing(double a_spacing) override
+  {
+    m_sampleSpacing = std::max(a_spacing, 0.0);
+  }
+  /// \brief Set a number of locations to add inside each polyline segment.
+  /// \param[in] a_count The number of locations per segment. Zero for none.
+  virtual void SetSamplesPerSegment(int a_count) override
+  {
+    m_samplesPerSegment = std::max(a_count, 0);
+  }
 
   /// \brief Gets the scalars
   /// \return The scalars.
-  virtual const VecFlt& GetScalars() const override { return m_extractor->GetScalars(); }
+  virtual VecFlt GetScalars() const override { return m_extractor->GetScalars(); }
   /// \brief Gets the location of the scalars (points or cells)
   /// \return The location of the scalars.
   virtual DataLocationEnum GetScalarLocation() const override
@@ -81,6 +168,12 @@ public:
     return m_extractor->GetScalarLocation();
   }
   virtual const VecPt3d& GetExtractLocations() const override;
+  /// \brief Gets the station of each extract location.
+  /// \return The stations.
+  virtual const VecDbl& GetExtractStations() const override { return m_stations; }
+  /// \brief Gets the polyline segment of each extract location.
+  /// \return The segment indexes.
+  virtual const VecInt& GetExtractSegmentIndexes() const override { return m_segmentIdxs; }
   /// \brief Gets cell indexes associated with the extract location points.
   /// \return The cell indexes.
   virtual const VecInt& GetCellIndexes() const { return m_extractor->GetCellIndexes(); }
@@ -93,17 +186,177 @@ public:
   /// \brief Gets the no data value
   /// \return The no data value.
   virtual float GetNoDataValue() const override { return m_extractor->GetNoDataValue(); }
+  /// \brief Gets the option for walking cells to find polyline locations.
+  /// \return The option.
+  virtual bool GetUseCellWalking() const override { return m_useCellWalking; }
+  /// \brief Gets the station spacing of added locations.
+  /// \return The spacing or zero for none.
+  virtual double GetSampleSpacing() const override { return m_sampleSpacing; }
+  /// \brief Gets the number of locations added inside each polyline segment.
+  /// \return The number of locations.
+  virtual int GetSamplesPerSegment() const override { return m_samplesPerSegment; }
 
-private:
-  void ComputeExtractLocations(const VecPt3d& a_polyline, VecPt3d& a_locations);
+  int GetIntersectorBuildCount() const;
 
+private:
+  void SetZeroScalars(DataLocationEnum a_scalarLocation);
+  void TraverseLineSegment(const Pt3d& a_pt1,
+                           const Pt3d& a_pt2,
+                           XmIntersectorLease& a_intersector,
+                           VecInt& a_triangleIdxs,
+                           VecPt3d& a_points);
+  void ComputeExtractLocations(const VecPt3d& a_polyline,
+                               XmIntersectorLease& a_intersector,
+                               VecPt3d& a_locations,
+                               VecInt& a_triangleIdxs,
+                               VecDbl& a_stations,
+                               VecInt& a_segmentIdxs);
+  void AddSamples(const Pt3d& a_pt1,
+                  const Pt3d& a_pt2,
+                  double a_station,
+                  const VecInt& a_intersectIdxs,
+                  const VecPt3d& a_intersectPts,
+                  size_t a_segmentStart,
+                  VecPt3d& a_locations,
+                  VecInt& a_triangleIdxs) const;
+  void AddCellTriangles(const Pt3d& a_pt1,
+                        const Pt3d& a_pt2,
+                        const VecInt& a_cellIdxs,
+                        const VecPt3d& a_cellPts,
+                        size_t a_first,
+                        const VecPt3d& a_locations,
+                        VecInt& a_triangleIdxs) const;
+  void WalkLineSegment(const Pt3d& a_pt1,
+                       const Pt3d& a_pt2,
+                       XmIntersectorLease& a_intersector,
+                       int& a_cellIdx,
+                       VecInt& a_cellIdxs,
+                       VecPt3d& a_points);
+  int FindNextCell(int a_cellIdx, const Pt3d& a_pt1, const Pt3d& a_pt2, double a_t) const;
+  bool ClipToCell(int a_cellIdx,
+                  const Pt3d& a_pt1,
+                  const Pt3d& a_pt2,
+                  VecInt& a_cellPoints,
+                  double& a_tEnter,
+                  double& a_tExit) const;
+  void TraverseCells(const Pt3d& a_pt1,
+                     const Pt3d& a_pt2,
+                     XmIntersectorLease& a_intersector,
+                     VecInt& a_cellIdxs,
+                     VecPt3d& a_points);
+
+  std::shared_ptr<XmUGrid> m_ugrid;         ///< The UGrid.
   BSHP<XmUGrid2dDataExtractor> m_extractor; ///< The data extractor.
-  mutable BSHP<GmMultiPolyIntersector>
-    m_multiPolyIntersector; ///< The intersection tool used from
-                            ///   xmsinterp to find the intersections
-                            ///   with the polyline.
+  bool m_useCellWalking;                    ///< Walk cells to find locations.
+  double m_sampleSpacing;                   ///< Station spacing of added locations.
+  int m_samplesPerSegment;                  ///< Locations added inside each segment.
+  BSHP<XmSharedIntersector> m_intersector;  ///< The possibly shared intersectors.
+  VecDbl m_stations;                        ///< Station of each extract location.
+  VecInt m_segmentIdxs;                     ///< Polyline segment of each location.
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmIntersectorLease
+/// \brief An intersector used by one extractor or worker thread at a time.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Construct without an intersector.
+/// \param[in] a_shared The shared intersectors to take one from.
+//------------------------------------------------------------------------------
+XmIntersectorLease::XmIntersectorLease(BSHP<XmSharedIntersector> a_shared)
+: m_shared(a_shared)
+{
+} // XmIntersectorLease::XmIntersectorLease
+//------------------------------------------------------------------------------
+/// \brief Destructor. Gives the intersector back.
+//------------------------------------------------------------------------------
+XmIntersectorLease::~XmIntersectorLease()
+{
+  Release();
+} // XmIntersectorLease::~XmIntersectorLease
+//------------------------------------------------------------------------------
+/// \brief Get an intersector for triangles. Takes an idle one, builds one if
+///        fewer than MAX_INTERSECTORS have been built, or waits for one to be
+///        given back. The pool is emptied if it was for other triangles.
+/// \param[in] a_triangles The triangles.
+/// \param[in] a_numThreads The number of threads to make the polygons with.
+/// \return The intersector.
+//------------------------------------------------------------------------------
+GmMultiPolyIntersector& XmIntersectorLease::Get(BSHP<XmUGridTriangles2d> a_triangles,
+                                                int a_numThreads)
+{
+  if (m_intersector && m_triangles == a_triangles)
+    return *m_intersector;
+  Release();
+
+  {
+    std::unique_lock<std::mutex> lock(m_shared->mutex);
+    while (true)
+    {
+      if (m_shared->triangles != a_triangles)
+      {
+        m_shared->triangles = a_triangles;
+        m_shared->idle.clear();
+        m_shared->numBuilt = 0;
+      }
+      if (!m_shared->idle.empty())
+      {
+        m_intersector = m_shared->idle.back();
+        m_shared->idle.pop_back();
+        m_triangles = a_triangles;
+        return *m_intersector;
+      }
+      if (m_shared->numBuilt < MAX_INTERSECTORS)
+        break;
+      m_shared->released.wait(lock);
+    }
+    ++m_shared->numBuilt;
+    ++m_shared->totalBuilt;
+  }
+
+  try
+  {
+    // GmMultiPolyIntersector only takes a vector per polygon and copies them,
+    // so there is still an allocation per triangle. The polygons are filled
+    // from the flat triangle buffer in parallel and freed after the build.
+    const int* triangles = a_triangles->GetTriangles().data();
+    VecInt2d polygons(a_triangles->GetTriangles().size() / 3);
+    xmParallelFor(polygons.size(), a_numThreads, MIN_POLYGONS_PER_THREAD,
+                  [&](size_t a_begin, size_t a_end) {
+                    for (size_t i = a_begin; i < a_end; ++i)
+                      polygons[i].assign(triangles + 3 * i, triangles + 3 * i + 3);
+                  });
+    BSHP<GmMultiPolyIntersectionSorter> sorter(new GmMultiPolyIntersectionSorterTerse());
+    m_intersector = GmMultiPolyIntersector::New(a_triangles->GetPoints(), polygons, sorter, 0);
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(m_shared->mutex);
+    if (m_shared->triangles == a_triangles)
+      --m_shared->numBuilt;
+    m_shared->released.notify_one();
+    throw;
+  }
+  m_triangles = a_triangles;
+  return *m_intersector;
+} // XmIntersectorLease::Get
+//------------------------------------------------------------------------------
+/// \brief Give the intersector back to be used by others. It is dropped if the
+///        pool was emptied for other triangles since it was taken.
+//------------------------------------------------------------------------------
+void XmIntersectorLease::Release()
+{
+  if (m_intersector)
+  {
+    std::lock_guard<std::mutex> lock(m_shared->mutex);
+    if (m_shared->triangles == m_triangles)
+      m_shared->idle.push_back(m_intersector);
+    m_shared->released.notify_one();
+  }
+  m_intersector.reset();
+  m_triangles.reset();
+} // XmIntersectorLease::Release
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \class XmUGrid2dPolylineDataExtractorImpl
 /// \brief Implementation for XmUGrid2dDataExtractor which provides ability
@@ -117,27 +370,55 @@ private:
 XmUGrid2dPolylineDataExtractorImpl::XmUGrid2dPolylineDataExtractorImpl(
   std::shared_ptr<XmUGrid> a_ugrid,
   DataLocationEnum a_scalarLocation)
-: m_extractor(XmUGrid2dDataExtractor::New(a_ugrid))
+: m_ugrid(a_ugrid)
+, m_extractor(XmUGrid2dDataExtractor::New(a_ugrid))
+, m_useCellWalking(false)
+, m_sampleSpacing(0.0)
+, m_samplesPerSegment(0)
+, m_intersector(new XmSharedIntersector())
 {
   if (a_scalarLocation == LOC_UNKNOWN)
   {
     XM_LOG(xmlog::error, "Scalar locations are unknown in polyline extractor.");
     a_scalarLocation = LOC_POINTS;
   }
-
+  SetZeroScalars(a_scalarLocation);
+} // XmUGrid2dPolylineDataExtractorImpl::XmUGrid2dPolylineDataExtractorImpl
+//------------------------------------------------------------------------------
+/// \brief Create a new XmUGrid2dPolylineDataExtractorImpl using shallow copy
+///        from existing extractor.
+/// \param[in] a_extractor The extractor to shallow copy
+//------------------------------------------------------------------------------
+XmUGrid2dPolylineDataExtractorImpl::XmUGrid2dPolylineDataExtractorImpl(
+  BSHP<XmUGrid2dPolylineDataExtractorImpl> a_extractor)
+: m_ugrid(a_extractor->m_ugrid)
+, m_extractor(XmUGrid2dDataExtractor::New(a_extractor->m_extractor))
+, m_useCellWalking(a_extractor->m_useCellWalking)
+, m_sampleSpacing(a_extractor->m_sampleSpacing)
+, m_samplesPerSegment(a_extractor->m_samplesPerSegment)
+, m_intersector(a_extractor->m_intersector)
+{
+  SetZeroScalars(a_extractor->GetScalarLocation());
+} // XmUGrid2dPolylineDataExtractorImpl::XmUGrid2dPolylineDataExtractorImpl
+//------------------------------------------------------------------------------
+/// \brief Set scalars of zero at points or cells to fix the scalar location.
+/// \param[in] a_scalarLocation The location of the scalars (points or cells).
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorImpl::SetZeroScalars(DataLocationEnum a_scalarLocation)
+{
   if (a_scalarLocation == LOC_POINTS)
   {
-    VecFlt v(a_ugrid->GetPointCount(), 0.0);
+    VecFlt v(m_ugrid->GetPointCount(), 0.0);
     DynBitset act;
     m_extractor->SetGridPointScalars(v, act, LOC_POINTS);
   }
   else if (a_scalarLocation == LOC_CELLS)
   {
-    VecFlt v(a_ugrid->GetCellCount(), 0.0);
+    VecFlt v(m_ugrid->GetCellCount(), 0.0);
     DynBitset act;
     m_extractor->SetGridCellScalars(v, act, LOC_CELLS);
   }
-} // XmUGrid2dPolylineDataExtractorImpl::XmUGrid2dPolylineDataExtractorImpl
+} // XmUGrid2dPolylineDataExtractorImpl::SetZeroScalars
 //------------------------------------------------------------------------------
 /// \brief Setup point scalars to be used to extract interpolated data.
 /// \param[in] a_scalars The cell or point scalars.
@@ -154,6 +435,23 @@ void XmUGrid2dPolylineDataExtractorImpl::SetGridScalars(const VecFlt& a_scalars,
     m_extractor->SetGridCellScalars(a_scalars, a_activity, a_activityLocation);
 } // XmUGrid2dPolylineDataExtractorImpl::SetGridScalars
 //------------------------------------------------------------------------------
+/// \brief Setup scalars taking over the vector instead of copying point
+///        scalars. Cell scalars are only read while they are set.
+/// \param[in] a_scalars The cell or point scalars.
+/// \param[in] a_activity The activity of the cells.
+/// \param[in] a_activityLocation The location at which the data is currently
+///            stored.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorImpl::SetGridScalars(VecFlt&& a_scalars,
+                                                        const DynBitset& a_activity,
+                                                        DataLocationEnum a_activityLocation)
+{
+  if (m_extractor->GetScalarLocation() == LOC_POINTS)
+    m_extractor->SetGridPointScalars(std::move(a_scalars), a_activity, a_activityLocation);
+  else if (m_extractor->GetScalarLocation() == LOC_CELLS)
+    m_extractor->SetGridCellScalars(a_scalars, a_activity, a_activityLocation);
+} // XmUGrid2dPolylineDataExtractorImpl::SetGridScalars
+//------------------------------------------------------------------------------
 /// \brief Set the polyline along which to extract the scalar data. Locations
 ///        crossing cell boundaries are computed along the polyline.
 /// \param[in] a_polyline The polyline.
@@ -162,8 +460,13 @@ void XmUGrid2dPolylineDataExtractorImpl::SetPolyline(const VecPt3d& a_polyline)
 {
   m_extractor->BuildTriangles(m_extractor->GetScalarLocation());
   VecPt3d locations;
-  ComputeExtractLocations(a_polyline, locations);
-  m_extractor->SetExtractLocations(locations);
+  VecInt triangleIdxs;
+  {
+    XmIntersectorLease intersector(m_intersector);
+    ComputeExtractLocations(a_polyline, intersector, locations, triangleIdxs, m_stations,
+                            m_segmentIdxs);
+  }
+  m_extractor->SetExtractLocations(locations, triangleIdxs);
 } // XmUGrid2dPolylineDataExtractorImpl::SetPolyline
 //------------------------------------------------------------------------------
 /// \brief Gets computed locations along polyline to extract interpolated scalar
@@ -202,6 +505,91 @@ void XmUGrid2dPolylineDataExtractorImpl::ComputeLocationsAndExtractData(
   a_extractedLocations = GetExtractLocations();
 } // XmUGrid2dPolylineDataExtractorImpl::ComputeLocationsAndExtractData
 //------------------------------------------------------------------------------
+/// \brief Extract data along many polylines at once. The locations of each
+///        polyline are computed on the data extractor's threads, but on no
+///        more than MAX_INTERSECTORS since each thread needs its own
+///        intersector, a copy of the mesh. The data is then extracted for all
+///        locations together.
+/// \param[in] a_polylineOffsets The index of the first point of each polyline
+///            followed by the number of points (number of polylines + 1).
+/// \param[in] a_polylinePoints The points of every polyline one polyline after
+///            another.
+/// \param[out] a_locationOffsets The index of the first location of each
+///             polyline followed by the number of locations.
+/// \param[out] a_locations The locations of every polyline.
+/// \param[out] a_extractedData The interpolated scalars at the locations.
+/// \param[out] a_cellIdxs The cell index of each location or -1 if outside.
+///             The stations and segments of the locations are kept for
+///             GetExtractStations and GetExtractSegmentIndexes.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorImpl::ExtractPolylines(const VecInt& a_polylineOffsets,
+                                                          const VecPt3d& a_polylinePoints,
+                                                          VecInt& a_locationOffsets,
+                                                          VecPt3d& a_locations,
+                                                          VecFlt& a_extractedData,
+                                                          VecInt& a_cellIdxs)
+{
+  size_t numPolylines = a_polylineOffsets.empty() ? 0 : a_polylineOffsets.size() - 1;
+  bool validOffsets = a_polylineOffsets.empty() ? a_polylinePoints.empty()
+                                                : a_polylineOffsets[0] == 0 &&
+                                                    a_polylineOffsets.back() ==
+                                                      (int)a_polylinePoints.size();
+  for (size_t i = 0; validOffsets && i < numPolylines; ++i)
+    validOffsets = a_polylineOffsets[i] <= a_polylineOffsets[i + 1];
+  if (!validOffsets)
+  {
+    throw std::invalid_argument("Invalid polyline offsets in polyline extractor.");
+  }
+
+  m_extractor->BuildTriangles(m_extractor->GetScalarLocation());
+  std::vector<VecPt3d> polylineLocations(numPolylines);
+  std::vector<VecInt> polylineTriangles(numPolylines);
+  std::vector<VecDbl> polylineStations(numPolylines);
+  std::vector<VecInt> polylineSegments(numPolylines);
+  if (numPolylines && m_extractor->GetUGridTriangles())
+  {
+    int numThreads = std::min(xmResolveThreadCount(m_extractor->GetThreadCount()),
+                              MAX_INTERSECTORS);
+    xmParallelFor(numPolylines, numThreads, MIN_POLYLINES_PER_THREAD,
+                  [&](size_t a_begin, size_t a_end) {
+                    // each worker traverses with its own intersector
+                    XmIntersectorLease intersector(m_intersector);
+                    VecPt3d polyline;
+                    for (size_t i = a_begin; i < a_end; ++i)
+                    {
+                      auto first = a_polylinePoints.begin() + a_polylineOffsets[i];
+                      auto last = a_polylinePoints.begin() + a_polylineOffsets[i + 1];
+                      if (first == last)
+                        continue;
+                      polyline.assign(first, last);
+                      ComputeExtractLocations(polyline, intersector, polylineLocations[i],
+                                              polylineTriangles[i], polylineStations[i],
+                                              polylineSegments[i]);
+                    }
+                  });
+  }
+
+  a_locationOffsets.assign(1, 0);
+  a_locations.clear();
+  m_stations.clear();
+  m_segmentIdxs.clear();
+  VecInt triangleIdxs;
+  for (size_t i = 0; i < numPolylines; ++i)
+  {
+    a_locations.insert(a_locations.end(), polylineLocations[i].begin(),
+                       polylineLocations[i].end());
+    triangleIdxs.insert(triangleIdxs.end(), polylineTriangles[i].begin(),
+                        polylineTriangles[i].end());
+    m_stations.insert(m_stations.end(), polylineStations[i].begin(), polylineStations[i].end());
+    m_segmentIdxs.insert(m_segmentIdxs.end(), polylineSegments[i].begin(),
+                         polylineSegments[i].end());
+    a_locationOffsets.push_back((int)a_locations.size());
+  }
+  m_extractor->SetExtractLocations(a_locations, triangleIdxs);
+  m_extractor->ExtractData(a_extractedData);
+  a_cellIdxs = m_extractor->GetCellIndexes();
+} // XmUGrid2dPolylineDataExtractorImpl::ExtractPolylines
+//------------------------------------------------------------------------------
 /// \brief Set to use IDW to calculate point scalar values from cell scalars.
 /// \param a_useIdw Whether to turn IDW on or off.
 //------------------------------------------------------------------------------
@@ -219,14 +607,58 @@ void XmUGrid2dPolylineDataExtractorImpl::SetNoDataValue(float a_value)
   m_extractor->SetNoDataValue(a_value);
 } // XmUGrid2dPolylineDataExtractorImpl::SetNoDataValue
 //------------------------------------------------------------------------------
+/// \brief Get the number of intersectors built by the pool shared with the
+///        extractors this was copied from or to.
+/// \return The number of intersectors built.
+//------------------------------------------------------------------------------
+int XmUGrid2dPolylineDataExtractorImpl::GetIntersectorBuildCount() const
+{
+  std::lock_guard<std::mutex> lock(m_intersector->mutex);
+  return m_intersector->totalBuilt;
+} // XmUGrid2dPolylineDataExtractorImpl::GetIntersectorBuildCount
+//------------------------------------------------------------------------------
+/// \brief Find the triangles crossed by a line segment with the intersector,
+///        taking one first if needed.
+/// \param[in] a_pt1 The start of the segment.
+/// \param[in] a_pt2 The end of the segment.
+/// \param[in,out] a_intersector The intersector used by the calling thread.
+/// \param[out] a_triangleIdxs The triangles crossed followed by -1.
+/// \param[out] a_points The point at which each triangle is entered and the
+///             point the segment leaves the triangles or ends.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorImpl::TraverseLineSegment(const Pt3d& a_pt1,
+                                                             const Pt3d& a_pt2,
+                                                             XmIntersectorLease& a_intersector,
+                                                             VecInt& a_triangleIdxs,
+                                                             VecPt3d& a_points)
+{
+  GmMultiPolyIntersector& intersector =
+    a_intersector.Get(m_extractor->GetUGridTriangles(), m_extractor->GetThreadCount());
+  intersector.TraverseLineSegment(a_pt1.x, a_pt1.y, a_pt2.x, a_pt2.y, a_triangleIdxs, a_points);
+} // XmUGrid2dPolylineDataExtractorImpl::TraverseLineSegment
+//------------------------------------------------------------------------------
 /// \brief Compute locations to extract scalar values from across a polyline.
 /// \param[in] a_polyline The line used to calculate the extraction points.
+/// \param[in,out] a_intersector The intersector used by the calling thread.
 /// \param[out] a_locations The points at which will the data will be extracted.
+/// \param[out] a_triangleIdxs The triangle known to contain each location or
+///             -1 if it must be searched for.
+/// \param[out] a_stations The plan view distance along the polyline to each
+///             location.
+/// \param[out] a_segmentIdxs The polyline segment each location is on. A
+///             location at a polyline point is on the segment ending there.
 //------------------------------------------------------------------------------
 void XmUGrid2dPolylineDataExtractorImpl::ComputeExtractLocations(const VecPt3d& a_polyline,
-                                                                 VecPt3d& a_locations)
+                                                                 XmIntersectorLease& a_intersector,
+                                                                 VecPt3d& a_locations,
+                                                                 VecInt& a_triangleIdxs,
+                                                                 VecDbl& a_stations,
+                                                                 VecInt& a_segmentIdxs)
 {
   a_locations.clear();
+  a_triangleIdxs.clear();
+  a_stations.clear();
+  a_segmentIdxs.clear();
   if (a_polyline.empty())
   {
     XM_LOG(xmlog::error, "Attempting to extract polyline profile with empty polyline.");
@@ -239,40 +671,35 @@ void XmUGrid2dPolylineDataExtractorImpl::ComputeExtractLocations(const VecPt3d&
     return;
   }
 
-  if (!m_multiPolyIntersector)
-  {
-    const VecPt3d& points = m_extractor->GetUGridTriangles()->GetPoints();
-    const VecInt& triangles = m_extractor->GetUGridTriangles()->GetTriangles();
-    VecInt2d polygons;
-    VecInt triangle;
-    for (size_t triangleIdx = 0; triangleIdx < triangles.size(); triangleIdx += 3)
-    {
-      triangle = {triangles[triangleIdx], triangles[triangleIdx + 1], triangles[triangleIdx + 2]};
-      polygons.push_back(triangle);
-    }
-
-    BSHP<GmMultiPolyIntersectionSorter> sorter(new GmMultiPolyIntersectionSorterTerse());
-    m_multiPolyIntersector = GmMultiPolyIntersector::New(points, polygons, sorter, 0);
-  }
-
   // get points crossing cell edges
   Pt3d lastPoint = a_polyline[0];
   a_locations.push_back(lastPoint);
+  a_stations.push_back(0.0);
+  a_segmentIdxs.push_back(0);
 
+  int cellIdx = -1;
+  double station = 0.0;
   for (size_t polyIdx = 1; polyIdx < a_polyline.size(); ++polyIdx)
   {
     Pt3d pt1 = a_polyline[polyIdx - 1];
     Pt3d pt2 = a_polyline[polyIdx];
     VecInt intersectIdxs;
     VecPt3d intersectPts;
+    size_t segmentStart = a_locations.size();
 
-    m_multiPolyIntersector->TraverseLineSegment(pt1.x, pt1.y, pt2.x, pt2.y, intersectIdxs,
-                                                intersectPts);
+    if (m_useCellWalking)
+    {
+      WalkLineSegment(pt1, pt2, a_intersector, cellIdx, intersectIdxs, intersectPts);
+    }
+    else
+    {
+      TraverseLineSegment(pt1, pt2, a_intersector, intersectIdxs, intersectPts);
+    }
 
     if (intersectIdxs.size() != intersectPts.size())
     {
       XM_LOG(xmlog::error, "Internal error when extracting polyline profile.");
-      return;
+      break;
     }
 
     for (size_t i = 0; i < intersectIdxs.size(); ++i)
@@ -294,15 +721,422 @@ void XmUGrid2dPolylineDataExtractorImpl::ComputeExtractLocations(const VecPt3d&
       a_locations.push_back(pt2);
       lastPoint = pt2;
     }
+
+    a_triangleIdxs.resize(a_locations.size(), -1);
+    if (m_sampleSpacing > 0.0 || m_samplesPerSegment > 0)
+    {
+      AddSamples(pt1, pt2, station, intersectIdxs, intersectPts, segmentStart, a_locations,
+                 a_triangleIdxs);
+    }
+    if (m_useCellWalking)
+    {
+      AddCellTriangles(pt1, pt2, intersectIdxs, intersectPts, segmentStart - 1, a_locations,
+                       a_triangleIdxs);
+    }
+    for (size_t i = segmentStart; i < a_locations.size(); ++i)
+    {
+      const Pt3d& location = a_locations[i];
+      a_stations.push_back(station + std::sqrt((location.x - pt1.x) * (location.x - pt1.x) +
+                                               (location.y - pt1.y) * (location.y - pt1.y)));
+      a_segmentIdxs.push_back(static_cast<int>(polyIdx - 1));
+    }
+    station += std::sqrt((pt2.x - pt1.x) * (pt2.x - pt1.x) + (pt2.y - pt1.y) * (pt2.y - pt1.y));
   }
+  a_triangleIdxs.resize(a_locations.size(), -1);
 } // XmUGrid2dPolylineDataExtractorImpl::ComputeExtractLocations
+//------------------------------------------------------------------------------
+/// \brief Add sample locations inside a polyline segment at the station
+///        spacing and the number per segment. Each sample takes the triangle
+///        the segment was crossing from the traversal so it isn't searched for
+///        again. Samples on walked cells get their triangle from
+///        AddCellTriangles.
+/// \param[in] a_pt1 The start of the segment.
+/// \param[in] a_pt2 The end of the segment.
+/// \param[in] a_station The station at the start of the segment.
+/// \param[in] a_intersectIdxs The triangles or cells crossed by the segment.
+/// \param[in] a_intersectPts The entry point of each triangle or cell.
+/// \param[in] a_segmentStart The first location after the start of the
+///            segment.
+/// \param[in,out] a_locations The locations with the segment's added.
+/// \param[in,out] a_triangleIdxs The triangle of each location or -1.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorImpl::AddSamples(const Pt3d& a_pt1,
+                                                    const Pt3d& a_pt2,
+                                                    double a_station,
+                                                    const VecInt& a_intersectIdxs,
+                                                    const VecPt3d& a_intersectPts,
+                                                    size_t a_segmentStart,
+                                                    VecPt3d& a_locations,
+                                                    VecInt& a_triangleIdxs) const
+{
+  double dx = a_pt2.x - a_pt1.x;
+  double dy = a_pt2.y - a_pt1.y;
+  double length2 = dx * dx + dy * dy;
+  if (length2 == 0.0)
+    return;
+  double length = std::sqrt(length2);
+  auto parameter = [&](const Pt3d& a_pt) {
+    return ((a_pt.x - a_pt1.x) * dx + (a_pt.y - a_pt1.y) * dy) / length2;
+  };
+
+  VecDbl sampleTs;
+  if (m_sampleSpacing > 0.0)
+  {
+    for (double k = std::floor(a_station / m_sampleSpacing) + 1.0;
+         k * m_sampleSpacing < a_station + length; k += 1.0)
+    {
+      sampleTs.push_back((k * m_sampleSpacing - a_station) / length);
+    }
+  }
+  for (int i = 1; i <= m_samplesPerSegment; ++i)
+    sampleTs.push_back(static_cast<double>(i) / (m_samplesPerSegment + 1));
+  std::sort(sampleTs.begin(), sampleTs.end());
+  sampleTs.erase(std::unique(sampleTs.begin(), sampleTs.end()), sampleTs.end());
+
+  // merge the samples with the segment's locations in order along it
+  VecPt3d locations;
+  VecInt triangleIdxs;
+  size_t locationIdx = a_segmentStart;
+  size_t pieceIdx = 0;
+  for (double t : sampleTs)
+  {
+    if (t <= 0.0 || t >= 1.0)
+      continue;
+    while (locationIdx < a_locations.size() && parameter(a_locations[locationIdx]) <= t)
+    {
+      locations.push_back(a_locations[locationIdx]);
+      triangleIdxs.push_back(a_triangleIdxs[locationIdx]);
+      ++locationIdx;
+    }
+    while (pieceIdx + 1 < a_intersectPts.size() && parameter(a_intersectPts[pieceIdx + 1]) <= t)
+      ++pieceIdx;
+
+    Pt3d sample = a_pt1 + (a_pt2 - a_pt1) * t;
+    const Pt3d& previous = locations.empty() ? a_locations[a_segmentStart - 1] : locations.back();
+    if (sample == previous)
+      continue;
+    int triangleIdx = -1;
+    if (!m_useCellWalking && pieceIdx < a_intersectIdxs.size() &&
+        parameter(a_intersectPts[pieceIdx]) <= t)
+    {
+      triangleIdx = a_intersectIdxs[pieceIdx];
+    }
+    locations.push_back(sample);
+    triangleIdxs.push_back(triangleIdx);
+  }
+  locations.insert(locations.end(), a_locations.begin() + locationIdx, a_locations.end());
+  triangleIdxs.insert(triangleIdxs.end(), a_triangleIdxs.begin() + locationIdx,
+                      a_triangleIdxs.end());
+  a_locations.resize(a_segmentStart);
+  a_locations.insert(a_locations.end(), locations.begin(), locations.end());
+  a_triangleIdxs.resize(a_segmentStart);
+  a_triangleIdxs.insert(a_triangleIdxs.end(), triangleIdxs.begin(), triangleIdxs.end());
+} // XmUGrid2dPolylineDataExtractorImpl::AddSamples
+//------------------------------------------------------------------------------
+/// \brief Give the locations on a walked segment the triangle of the walked
+///        cell containing them so they aren't searched for. Locations where
+///        the segment crosses a cell edge are on two cells and are left to
+///        the search, as they are when traversing triangles.
+/// \param[in] a_pt1 The start of the segment.
+/// \param[in] a_pt2 The end of the segment.
+/// \param[in] a_cellIdxs The cells crossed by the segment followed by -1.
+/// \param[in] a_cellPts The entry point of each cell.
+/// \param[in] a_first The first location on the segment.
+/// \param[in] a_locations The locations.
+/// \param[in,out] a_triangleIdxs The triangle of each location or -1. Only
+///                -1 values are changed.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorImpl::AddCellTriangles(const Pt3d& a_pt1,
+                                                          const Pt3d& a_pt2,
+                                                          const VecInt& a_cellIdxs,
+                                                          const VecPt3d& a_cellPts,
+                                                          size_t a_first,
+                                                          const VecPt3d& a_locations,
+                                                          VecInt& a_triangleIdxs) const
+{
+  double dx = a_pt2.x - a_pt1.x;
+  double dy = a_pt2.y - a_pt1.y;
+  double length2 = dx * dx + dy * dy;
+  if (length2 == 0.0 || a_cellIdxs.empty())
+    return;
+  auto parameter = [&](const Pt3d& a_pt) {
+    return ((a_pt.x - a_pt1.x) * dx + (a_pt.y - a_pt1.y) * dy) / length2;
+  };
+
+  BSHP<XmUGridTriangles2d> triangles = m_extractor->GetUGridTriangles();
+  size_t pieceIdx = 0;
+  for (size_t locationIdx = a_first; locationIdx < a_locations.size(); ++locationIdx)
+  {
+    const Pt3d& location = a_locations[locationIdx];
+    double t = parameter(location);
+    while (pieceIdx + 1 < a_cellPts.size() && parameter(a_cellPts[pieceIdx + 1]) <= t)
+      ++pieceIdx;
+    if (a_triangleIdxs[locationIdx] >= 0)
+      continue;
+    int cellIdx = a_cellIdxs[pieceIdx];
+    if (pieceIdx > 0 && location == a_cellPts[pieceIdx])
+      cellIdx = a_cellIdxs[pieceIdx - 1];
+    if (cellIdx >= 0)
+      a_triangleIdxs[locationIdx] = triangles->GetCellTriangle(cellIdx, location);
+  }
+} // XmUGrid2dPolylineDataExtractorImpl::AddCellTriangles
+//------------------------------------------------------------------------------
+/// \brief Find the cells crossed by a line segment by stepping from the cell
+///        containing its start to neighboring cells. The output matches
+///        GmMultiPolyIntersector::TraverseLineSegment with cells instead of
+///        triangles: each cell entered with its entry point, then -1 with the
+///        point where the segment leaves the UGrid or ends.
+/// \param[in] a_pt1 The start of the segment.
+/// \param[in] a_pt2 The end of the segment.
+/// \param[in,out] a_intersector The intersector used outside the UGrid or in
+///                cells that can't be walked.
+/// \param[in,out] a_cellIdx The cell containing a_pt1 or -1 to search for it.
+///                Set to the cell containing a_pt2 or -1 if unknown.
+/// \param[out] a_cellIdxs The cells crossed followed by -1.
+/// \param[out] a_points The point at which each cell is entered and the
+///             point the segment leaves the UGrid or ends.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorImpl::WalkLineSegment(const Pt3d& a_pt1,
+                                                         const Pt3d& a_pt2,
+                                                         XmIntersectorLease& a_intersector,
+                                                         int& a_cellIdx,
+                                                         VecInt& a_cellIdxs,
+                                                         VecPt3d& a_points)
+{
+  a_cellIdxs.clear();
+  a_points.clear();
+  if (a_pt1.x == a_pt2.x && a_pt1.y == a_pt2.y)
+    return;
+
+  if (a_cellIdx < 0)
+  {
+    VecInt idxs;
+    VecDbl weights;
+    a_cellIdx = m_extractor->GetUGridTriangles()->GetIntersectedCell(a_pt1, DynBitset(), idxs,
+                                                                     weights);
+  }
+
+  VecInt cellPoints;
+  int cellIdx = a_cellIdx;
+  double t = 0.0;
+  while (true)
+  {
+    double tEnter, tExit;
+    if (cellIdx < 0 || !ClipToCell(cellIdx, a_pt1, a_pt2, cellPoints, tEnter, tExit) ||
+        tEnter > t + WALK_TOLERANCE || tExit < t - WALK_TOLERANCE)
+    {
+      // outside the UGrid or in a cell that can't be walked
+      TraverseCells(a_pt1 + (a_pt2 - a_pt1) * t, a_pt2, a_intersector, a_cellIdxs, a_points);
+      a_cellIdx = -1;
+      return;
+    }
+
+    a_cellIdxs.push_back(cellIdx);
+    a_points.push_back(a_pt1 + (a_pt2 - a_pt1) * t);
+    if (tExit >= 1.0 - WALK_TOLERANCE)
+    {
+      a_cellIdxs.push_back(-1);
+      a_points.push_back(a_pt2);
+      a_cellIdx = cellIdx;
+      return;
+    }
+
+    t = std::max(t, tExit);
+    cellIdx = FindNextCell(cellIdx, a_pt1, a_pt2, t);
+    if (cellIdx < 0)
+    {
+      a_cellIdxs.push_back(-1);
+      a_points.push_back(a_pt1 + (a_pt2 - a_pt1) * t);
+    }
+  }
+} // XmUGrid2dPolylineDataExtractorImpl::WalkLineSegment
+//------------------------------------------------------------------------------
+/// \brief Find the cell a line segment goes into after leaving a cell. Cells
+///        across the edges of the cell are checked first, then the other cells
+///        touching its points for segments passing through a point.
+/// \param[in] a_cellIdx The cell being left.
+/// \param[in] a_pt1 The start of the segment.
+/// \param[in] a_pt2 The end of the segment.
+/// \param[in] a_t The segment parameter where the cell is left.
+/// \return The next cell or -1 if the segment leaves the UGrid.
+//------------------------------------------------------------------------------
+int XmUGrid2dPolylineDataExtractorImpl::FindNextCell(int a_cellIdx,
+                                                     const Pt3d& a_pt1,
+                                                     const Pt3d& a_pt2,
+                                                     double a_t) const
+{
+  VecInt candidates;
+  int edgeCount = m_ugrid->GetCellEdgeCount(a_cellIdx);
+  for (int edgeIdx = 0; edgeIdx < edgeCount; ++edgeIdx)
+  {
+    int adjacentCell = m_ugrid->GetCell2dEdgeAdjacentCell(a_cellIdx, edgeIdx);
+    if (adjacentCell >= 0)
+      candidates.push_back(adjacentCell);
+  }
+
+  VecInt cellPoints;
+  VecInt adjacentCells;
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    if (pass == 1)
+    {
+      VecInt edgeCells;
+      edgeCells.swap(candidates);
+      m_ugrid->GetCellPoints(a_cellIdx, cellPoints);
+      for (auto pointIdx : cellPoints)
+      {
+        m_ugrid->GetPointAdjacentCells(pointIdx, adjacentCells);
+        for (auto adjacentCell : adjacentCells)
+        {
+          if (std::find(edgeCells.begin(), edgeCells.end(), adjacentCell) == edgeCells.end() &&
+              std::find(candidates.begin(), candidates.end(), adjacentCell) == candidates.end())
+            candidates.push_back(adjacentCell);
+        }
+      }
+    }
+
+    int nextCell = -1;
+    double nextExit = a_t + WALK_TOLERANCE;
+    for (auto candidate : candidates)
+    {
+      double tEnter, tExit;
+      if (candidate != a_cellIdx &&
+          ClipToCell(candidate, a_pt1, a_pt2, cellPoints, tEnter, tExit) &&
+          tEnter <= a_t + WALK_TOLERANCE && tExit > nextExit)
+      {
+        nextCell = candidate;
+        nextExit = tExit;
+      }
+    }
+    if (nextCell >= 0)
+      return nextCell;
+  }
+  return -1;
+} // XmUGrid2dPolylineDataExtractorImpl::FindNextCell
+//------------------------------------------------------------------------------
+/// \brief Clip a line segment to a convex 2D cell.
+/// \param[in] a_cellIdx The cell.
+/// \param[in] a_pt1 The start of the segment.
+/// \param[in] a_pt2 The end of the segment.
+/// \param[out] a_cellPoints Storage for the cell points.
+/// \param[out] a_tEnter The segment parameter where it enters the cell.
+/// \param[out] a_tExit The segment parameter where it leaves the cell.
+/// \return False if the cell isn't a convex 2D cell or the segment misses it.
+//------------------------------------------------------------------------------
+bool XmUGrid2dPolylineDataExtractorImpl::ClipToCell(int a_cellIdx,
+                                                    const Pt3d& a_pt1,
+                                                    const Pt3d& a_pt2,
+                                                    VecInt& a_cellPoints,
+                                                    double& a_tEnter,
+                                                    double& a_tExit) const
+{
+  if (m_ugrid->GetCellDimension(a_cellIdx) != 2)
+    return false;
+  m_ugrid->GetCellPoints(a_cellIdx, a_cellPoints);
+  size_t numPoints = a_cellPoints.size();
+  if (numPoints < 3)
+    return false;
+
+  const VecPt3d& locations = m_ugrid->GetLocations();
+  double area2 = 0.0;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const Pt3d& p1 = locations[a_cellPoints[i]];
+    const Pt3d& p2 = locations[a_cellPoints[(i + 1) % numPoints]];
+    area2 += p1.x * p2.y - p2.x * p1.y;
+  }
+  if (area2 == 0.0)
+    return false;
+  double orientation = area2 > 0.0 ? 1.0 : -1.0;
+
+  double dx = a_pt2.x - a_pt1.x;
+  double dy = a_pt2.y - a_pt1.y;
+  double length = std::sqrt(dx * dx + dy * dy);
+  a_tEnter = 0.0;
+  a_tExit = 1.0;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const Pt3d& p1 = locations[a_cellPoints[i]];
+    const Pt3d& p2 = locations[a_cellPoints[(i + 1) % numPoints]];
+    const Pt3d& p3 = locations[a_cellPoints[(i + 2) % numPoints]];
+    double ex = p2.x - p1.x;
+    double ey = p2.y - p1.y;
+    double edgeLength = std::sqrt(ex * ex + ey * ey);
+    if (edgeLength == 0.0)
+      return false;
+    if (orientation * (ex * (p3.y - p2.y) - ey * (p3.x - p2.x)) < 0.0)
+      return false; // not convex
+
+    // signed distance inside the edge and its change along the segment
+    double nx = -ey * orientation / edgeLength;
+    double ny = ex * orientation / edgeLength;
+    double distance = nx * (a_pt1.x - p1.x) + ny * (a_pt1.y - p1.y);
+    double change = nx * dx + ny * dy;
+    if (std::fabs(change) <= WALK_TOLERANCE * length)
+    {
+      if (distance < -WALK_TOLERANCE * (length + edgeLength))
+        return false;
+      continue;
+    }
+    double t = -distance / change;
+    if (change > 0.0)
+      a_tEnter = std::max(a_tEnter, t);
+    else
+      a_tExit = std::min(a_tExit, t);
+  }
+  return a_tEnter <= a_tExit + WALK_TOLERANCE;
+} // XmUGrid2dPolylineDataExtractorImpl::ClipToCell
+//------------------------------------------------------------------------------
+/// \brief Find the cells crossed by a line segment with the intersector. Used
+///        where cells can't be walked. The triangles crossed are merged into
+///        the cells they belong to.
+/// \param[in] a_pt1 The start of the segment.
+/// \param[in] a_pt2 The end of the segment.
+/// \param[in,out] a_intersector The intersector used by the calling thread.
+/// \param[in,out] a_cellIdxs The cells crossed followed by -1 are appended.
+/// \param[in,out] a_points The entry points of the cells are appended.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorImpl::TraverseCells(const Pt3d& a_pt1,
+                                                       const Pt3d& a_pt2,
+                                                       XmIntersectorLease& a_intersector,
+                                                       VecInt& a_cellIdxs,
+                                                       VecPt3d& a_points)
+{
+  VecInt intersectIdxs;
+  VecPt3d intersectPts;
+  TraverseLineSegment(a_pt1, a_pt2, a_intersector, intersectIdxs, intersectPts);
+
+  VecInt idxs;
+  VecDbl weights;
+  for (size_t i = 0; i < intersectIdxs.size(); ++i)
+  {
+    int cellIdx = -1;
+    if (intersectIdxs[i] >= 0 && i + 1 < intersectPts.size())
+    {
+      Pt3d middle = (intersectPts[i] + intersectPts[i + 1]) / 2.0;
+      cellIdx =
+        m_extractor->GetUGridTriangles()->GetIntersectedCell(middle, DynBitset(), idxs, weights);
+    }
+    if (!a_cellIdxs.empty() && a_points.back() == intersectPts[i])
+    {
+      // continues at the point the walk stopped
+      a_cellIdxs.back() = cellIdx;
+    }
+    else if (a_cellIdxs.empty() || a_cellIdxs.back() != cellIdx)
+    {
+      a_cellIdxs.push_back(cellIdx);
+      a_points.push_back(intersectPts[i]);
+    }
+  }
+} // XmUGrid2dPolylineDataExtractorImpl::TraverseCells
 
 } // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \class XmUGrid2dPolylineDataExtractor
 /// \brief Provides ability to interpolate and extract the scalar values along a
-///        polyline for an unstructured grid.
+///        polyline for an unstructured grid. Instances come from New; the
+///        methods are pure virtual since nothing outside derives from it.
 ////////////////////////////////////////////////////////////////////////////////
 //------------------------------------------------------------------------------
 /// \brief Create a new XmUGrid2dPolylineDataExtractor.
@@ -319,6 +1153,33 @@ BSHP<XmUGrid2dPolylineDataExtractor> XmUGrid2dPolylineDataExtractor::New(
   return extractor;
 } // XmUGrid2dPolylineDataExtractor::New
 //------------------------------------------------------------------------------
+/// \brief Create a new XmUGrid2dPolylineDataExtractor using shallow copy from
+///        existing extractor. The copy shares the triangles and a pool of
+///        polyline intersectors. GmMultiPolyIntersector keeps state while
+///        traversing and can't be shared between threads without changes to
+///        xmsgrid, so the pool builds at most four per set of triangles, each
+///        a copy of the mesh, and lends them out one call at a time. Copies
+///        used one after another reuse the same intersector. More than four
+///        copies traversing at once wait for one to be given back.
+/// \param[in] a_extractor The extractor to shallow copy
+/// \return the new XmUGrid2dPolylineDataExtractor.
+//------------------------------------------------------------------------------
+BSHP<XmUGrid2dPolylineDataExtractor> XmUGrid2dPolylineDataExtractor::New(
+  BSHP<XmUGrid2dPolylineDataExtractor> a_extractor)
+{
+  BSHP<XmUGrid2dPolylineDataExtractorImpl> copied =
+    BDPC<XmUGrid2dPolylineDataExtractorImpl>(a_extractor);
+  if (copied)
+  {
+    BSHP<XmUGrid2dPolylineDataExtractor> extractor(
+      new XmUGrid2dPolylineDataExtractorImpl(copied));
+    return extractor;
+  }
+
+  XM_ASSERT(0);
+  return nullptr;
+} // XmUGrid2dPolylineDataExtractor::New
+//------------------------------------------------------------------------------
 /// \brief Constructor
 //------------------------------------------------------------------------------
 XmUGrid2dPolylineDataExtractor::XmUGrid2dPolylineDataExtractor()
@@ -340,6 +1201,10 @@ XmUGrid2dPolylineDataExtractor::~XmUGrid2dPolylineDataExtractor()
 using namespace xms;
 #include <xmsextractor/extractor/XmUGrid2dPolylineDataExtractor.t.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include <xmscore/misc/xmstype.h>
 #include <xmscore/testing/TestTools.h>
 #include <xmsgrid/geometry/geoms.h>
@@ -876,6 +1741,401 @@ void XmUGrid2dPolylineDataExtractorUnitTests::testCellScalars()
   TS_ASSERT_EQUALS(expectedLocations, extractedLocations);
 } // XmUGrid2dPolylineDataExtractorUnitTests::testCellScalars
 //------------------------------------------------------------------------------
+/// \brief Test extracting many polylines at once matches extracting them one at
+///        a time.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorUnitTests::testExtractPolylines()
+{
+  // clang-format off
+  //     (0,2)-------(1,2)-------(2,2)
+  //       |           |           |
+  //     (0,1)-------(1,1)-------(2,1)
+  //       |           |           |
+  //     (0,0)-------(1,0)-------(2,0)
+  // clang-format on
+  VecPt3d points = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {0, 1, 0}, {1, 1, 0},
+                    {2, 1, 0}, {0, 2, 0}, {1, 2, 0}, {2, 2, 0}};
+  VecInt cells = {XMU_QUAD, 4, 0, 1, 4, 3, XMU_QUAD, 4, 1, 2, 5, 4,
+                  XMU_QUAD, 4, 3, 4, 7, 6, XMU_QUAD, 4, 4, 5, 8, 7};
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  BSHP<XmUGrid2dPolylineDataExtractor> extractor =
+    XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  VecFlt pointScalars = {0, 1, 2, 1, 2, 3, 2, 3, 4};
+  extractor->SetGridScalars(pointScalars, DynBitset(), LOC_POINTS);
+
+  // build many polylines, including one outside and one empty
+  VecInt polylineOffsets = {0};
+  VecPt3d polylinePoints;
+  for (int i = 0; i < 100; ++i)
+  {
+    double y = 0.1 + 1.8 * i / 99.0;
+    polylinePoints.push_back(Pt3d(-0.5, y, 0.0));
+    polylinePoints.push_back(Pt3d(2.5, 2.0 - y, 0.0));
+    if (i % 3 == 0)
+      polylinePoints.push_back(Pt3d(1.0, y, 0.0));
+    polylineOffsets.push_back((int)polylinePoints.size());
+  }
+  polylinePoints.push_back(Pt3d(5.0, 5.0, 0.0));
+  polylinePoints.push_back(Pt3d(6.0, 5.0, 0.0));
+  polylineOffsets.push_back((int)polylinePoints.size());
+  polylineOffsets.push_back((int)polylinePoints.size());
+
+  VecInt expectedOffsets = {0};
+  VecPt3d expectedLocations;
+  VecFlt expectedData;
+  VecInt expectedCellIdxs;
+  for (size_t i = 0; i + 1 < polylineOffsets.size(); ++i)
+  {
+    VecPt3d polyline(polylinePoints.begin() + polylineOffsets[i],
+                     polylinePoints.begin() + polylineOffsets[i + 1]);
+    VecFlt data;
+    VecPt3d locations;
+    if (!polyline.empty())
+    {
+      extractor->ComputeLocationsAndExtractData(polyline, data, locations);
+      const VecInt& cellIdxs = extractor->GetCellIndexes();
+      expectedCellIdxs.insert(expectedCellIdxs.end(), cellIdxs.begin(), cellIdxs.end());
+    }
+    expectedLocations.insert(expectedLocations.end(), locations.begin(), locations.end());
+    expectedData.insert(expectedData.end(), data.begin(), data.end());
+    expectedOffsets.push_back((int)expectedLocations.size());
+  }
+
+  extractor->GetDataExtractor()->SetThreadCount(4);
+  VecInt locationOffsets;
+  VecPt3d locations;
+  VecFlt extractedData;
+  VecInt cellIdxs;
+  extractor->ExtractPolylines(polylineOffsets, polylinePoints, locationOffsets, locations,
+                              extractedData, cellIdxs);
+  TS_ASSERT_EQUALS(expectedOffsets, locationOffsets);
+  TS_ASSERT_EQUALS(expectedLocations, locations);
+  TS_ASSERT_EQUALS(expectedData, extractedData);
+  TS_ASSERT_EQUALS(expectedCellIdxs, cellIdxs);
+  TS_ASSERT_EQUALS(locations, extractor->GetExtractLocations());
+
+  // offsets must start at 0 and end at the number of points
+  bool threw = false;
+  try
+  {
+    VecInt badOffsets = {0, 2};
+    extractor->ExtractPolylines(badOffsets, polylinePoints, locationOffsets, locations,
+                                extractedData, cellIdxs);
+  }
+  catch (std::invalid_argument&)
+  {
+    threw = true;
+  }
+  TS_ASSERT(threw);
+} // XmUGrid2dPolylineDataExtractorUnitTests::testExtractPolylines
+//------------------------------------------------------------------------------
+/// \brief Test finding polyline locations by walking cells.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorUnitTests::testCellWalking()
+{
+  // clang-format off
+  //     6-----------7-----------8
+  //     |           |           |
+  //     |     2     |     3     |
+  //     |           |           |
+  //     3-----------4-----------5
+  //     |           |           |
+  //     |     0     |     1     |
+  //     |           |           |
+  //     0-----------1-----------2
+  // clang-format on
+  VecPt3d points = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {0, 1, 0}, {1, 1, 0},
+                    {2, 1, 0}, {0, 2, 0}, {1, 2, 0}, {2, 2, 0}};
+  VecInt cells = {XMU_QUAD, 4, 0, 1, 4, 3, XMU_QUAD, 4, 1, 2, 5, 4,
+                  XMU_QUAD, 4, 3, 4, 7, 6, XMU_QUAD, 4, 4, 5, 8, 7};
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  BSHP<XmUGrid2dPolylineDataExtractor> extractor =
+    XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  VecFlt pointScalars = {0, 1, 2, 1, 2, 3, 2, 3, 4};
+  extractor->SetGridScalars(pointScalars, DynBitset(), LOC_POINTS);
+  TS_ASSERT(!extractor->GetUseCellWalking());
+  extractor->SetUseCellWalking(true);
+  TS_ASSERT(extractor->GetUseCellWalking());
+
+  // across an edge then through a point into the diagonal cell
+  VecPt3d polyline = {{0.5, 0.5, 0.0}, {1.5, 1.7, 0.0}, {0.25, 1.75, 0.0}};
+  VecFlt extractedData;
+  VecPt3d extractedLocations;
+  extractor->ComputeLocationsAndExtractData(polyline, extractedData, extractedLocations);
+  VecPt3d expectedLocations = {{0.5, 0.5, 0.0},        {0.916666667, 1.0, 0.0},
+                               {1.0, 1.1, 0.0},        {1.5, 1.7, 0.0},
+                               {1.0, 1.72, 0.0},       {0.25, 1.75, 0.0}};
+  TS_ASSERT_DELTA_VECPT3D(expectedLocations, extractedLocations, 1.0e-6);
+  VecFlt expectedData = {1.0f, 1.916666667f, 2.1f, 3.2f, 2.72f, 2.0f};
+  TS_ASSERT_DELTA_VEC(expectedData, extractedData, 1.0e-5);
+
+  polyline = {{0.25, 0.5, 0.0}, {1.75, 1.5, 0.0}};
+  extractor->ComputeLocationsAndExtractData(polyline, extractedData, extractedLocations);
+  expectedLocations = {{0.25, 0.5, 0.0}, {1.0, 1.0, 0.0}, {1.75, 1.5, 0.0}};
+  TS_ASSERT_DELTA_VECPT3D(expectedLocations, extractedLocations, 1.0e-6);
+  TS_ASSERT_EQUALS((VecInt{0, 0, 3}), extractor->GetCellIndexes());
+
+  // starting outside falls back to the intersector but still gives cell edges
+  polyline = {{-0.5, 1.5, 0.0}, {1.5, 1.5, 0.0}};
+  extractor->ComputeLocationsAndExtractData(polyline, extractedData, extractedLocations);
+  expectedLocations = {{-0.5, 1.5, 0.0}, {0.0, 1.5, 0.0}, {1.0, 1.5, 0.0}, {1.5, 1.5, 0.0}};
+  TS_ASSERT_DELTA_VECPT3D(expectedLocations, extractedLocations, 1.0e-6);
+  expectedData = {XM_NODATA, 1.5f, 2.5f, 3.0f};
+  TS_ASSERT_DELTA_VEC(expectedData, extractedData, 1.0e-5);
+
+  // leave the UGrid through a gap between cells and come back in
+  // clang-format off
+  //     4-----5     6-----7
+  //     |  0  |     |  1  |
+  //     0-----1     2-----3
+  // clang-format on
+  points = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {3, 0, 0},
+            {0, 1, 0}, {1, 1, 0}, {2, 1, 0}, {3, 1, 0}};
+  cells = {XMU_QUAD, 4, 0, 1, 5, 4, XMU_QUAD, 4, 2, 3, 7, 6};
+  ugrid = XmUGrid::New(points, cells);
+  extractor = XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  pointScalars = {0, 1, 2, 3, 1, 2, 3, 4};
+  extractor->SetGridScalars(pointScalars, DynBitset(), LOC_POINTS);
+  extractor->SetUseCellWalking(true);
+  polyline = {{0.5, 0.5, 0.0}, {2.5, 0.5, 0.0}};
+  extractor->ComputeLocationsAndExtractData(polyline, extractedData, extractedLocations);
+  expectedLocations = {{0.5, 0.5, 0.0}, {1.0, 0.5, 0.0}, {1.5, 0.5, 0.0}, {2.0, 0.5, 0.0},
+                       {2.5, 0.5, 0.0}};
+  TS_ASSERT_DELTA_VECPT3D(expectedLocations, extractedLocations, 1.0e-6);
+  expectedData = {1.0f, 1.5f, XM_NODATA, 2.5f, 3.0f};
+  TS_ASSERT_DELTA_VEC(expectedData, extractedData, 1.0e-5);
+} // XmUGrid2dPolylineDataExtractorUnitTests::testCellWalking
+//------------------------------------------------------------------------------
+/// \brief Test polyline extractors copied from one another sharing the
+///        intersector from several threads.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorUnitTests::testSharedIntersector()
+{
+  // clang-format off
+  //      3========2========5
+  //      |        |        |
+  //   0===============1    |
+  //      |        |        |
+  //      0--------1--------4
+  // clang-format on
+  VecPt3d points = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {2, 0, 0}, {2, 1, 0}};
+  VecInt cells = {XMU_QUAD, 4, 0, 1, 2, 3, XMU_QUAD, 4, 1, 4, 5, 2};
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  BSHP<XmUGrid2dPolylineDataExtractor> extractor =
+    XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_CELLS);
+  VecPt3d polyline = {{-0.5, 0.75, 0.0}, {1.5, 0.75, 0.0}};
+  extractor->SetPolyline(polyline);
+  auto intersectorBuilds = [&]() {
+    return BDPC<XmUGrid2dPolylineDataExtractorImpl>(extractor)->GetIntersectorBuildCount();
+  };
+  TS_ASSERT_EQUALS(1, intersectorBuilds());
+
+  // each copy has its own scalars but shares the triangles and intersectors
+  const int numCopies = 6;
+  std::vector<BSHP<XmUGrid2dPolylineDataExtractor>> copies;
+  for (int i = 0; i < numCopies; ++i)
+  {
+    copies.push_back(XmUGrid2dPolylineDataExtractor::New(extractor));
+    TS_ASSERT_EQUALS(LOC_CELLS, copies.back()->GetScalarLocation());
+    TS_ASSERT_EQUALS(extractor->GetDataExtractor()->GetUGridTriangles(),
+                     copies.back()->GetDataExtractor()->GetUGridTriangles());
+    copies.back()->SetGridScalars({(float)i, (float)(2 * i)}, DynBitset(), LOC_CELLS);
+  }
+
+  // copies used one after another reuse the intersector already built
+  for (auto& copy : copies)
+    copy->SetPolyline(polyline);
+  TS_ASSERT_EQUALS(1, intersectorBuilds());
+
+  // the copies traverse at the same time with at most four intersectors,
+  // waiting on each other to take one
+  std::vector<VecFlt> extractedData(numCopies);
+  std::vector<VecPt3d> extractedLocations(numCopies);
+  std::vector<std::thread> threads;
+  std::atomic<int> started(0);
+  for (int i = 0; i < numCopies; ++i)
+  {
+    threads.push_back(std::thread([&, i]() {
+      ++started;
+      while (started < numCopies)
+        std::this_thread::yield();
+      for (int repeat = 0; repeat < 20; ++repeat)
+      {
+        copies[i]->ComputeLocationsAndExtractData(polyline, extractedData[i],
+                                                  extractedLocations[i]);
+      }
+    }));
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  VecPt3d expectedLocations = {{-0.5, 0.75, 0.0}, {0.0, 0.75, 0.0}, {0.25, 0.75, 0.0},
+                               {0.75, 0.75, 0.0}, {1., 0.75, 0.0},  {1.25, 0.75, 0.0},
+                               {1.5, 0.75, 0.0}};
+  for (int i = 0; i < numCopies; ++i)
+  {
+    float value = (float)i;
+    VecFlt expectedData = {XM_NODATA,     value,         value,        1.25f * value,
+                           1.5f * value, 1.75f * value, 1.875f * value};
+    TS_ASSERT_EQUALS(expectedLocations, extractedLocations[i]);
+    TS_ASSERT_DELTA_VEC(expectedData, extractedData[i], 1.0e-5);
+  }
+  TS_ASSERT(intersectorBuilds() >= 1 && intersectorBuilds() <= 4);
+} // XmUGrid2dPolylineDataExtractorUnitTests::testSharedIntersector
+//------------------------------------------------------------------------------
+/// \brief Test adding locations at a station spacing and per segment.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorUnitTests::testSampleLocations()
+{
+  // clang-format off
+  //     6-----------7-----------8
+  //     |           |           |
+  //     |     2     |     3     |
+  //     |           |           |
+  //     3-----------4-----------5
+  //     |           |           |
+  //     |     0     |     1     |
+  //     |           |           |
+  //     0-----------1-----------2
+  // clang-format on
+  VecPt3d points = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {0, 1, 0}, {1, 1, 0},
+                    {2, 1, 0}, {0, 2, 0}, {1, 2, 0}, {2, 2, 0}};
+  VecInt cells = {XMU_QUAD, 4, 0, 1, 4, 3, XMU_QUAD, 4, 1, 2, 5, 4,
+                  XMU_QUAD, 4, 3, 4, 7, 6, XMU_QUAD, 4, 4, 5, 8, 7};
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  BSHP<XmUGrid2dPolylineDataExtractor> extractor =
+    XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  VecFlt pointScalars = {0, 1, 2, 1, 2, 3, 2, 3, 4};
+  extractor->SetGridScalars(pointScalars, DynBitset(), LOC_POINTS);
+  TS_ASSERT_EQUALS(0.0, extractor->GetSampleSpacing());
+  TS_ASSERT_EQUALS(0, extractor->GetSamplesPerSegment());
+
+  VecPt3d polyline = {{0.25, 0.5, 0.0}, {1.75, 0.5, 0.0}, {1.75, 2.5, 0.0}};
+
+  // stations 0.5 to 3.0 except 1.5, which is a polyline point, and 2.0, which
+  // is a cell crossing
+  VecPt3d samples = {{0.75, 0.5, 0.0}, {1.25, 0.5, 0.0}, {1.75, 1.5, 0.0},
+                     {1.75, 2.0, 0.0}, {1.75, 2.5, 0.0}};
+  for (int walk = 0; walk < 2; ++walk)
+  {
+    extractor->SetUseCellWalking(walk == 1);
+    extractor->SetSampleSpacing(0.0);
+    extractor->SetPolyline(polyline);
+    VecPt3d expectedLocations = extractor->GetExtractLocations();
+    expectedLocations.insert(expectedLocations.end(), samples.begin(), samples.end());
+    std::sort(expectedLocations.begin(), expectedLocations.end(),
+              [](const Pt3d& a_p1, const Pt3d& a_p2) {
+                return a_p1.y < a_p2.y || (a_p1.y == a_p2.y && a_p1.x < a_p2.x);
+              });
+    expectedLocations.erase(std::unique(expectedLocations.begin(), expectedLocations.end()),
+                            expectedLocations.end());
+
+    extractor->SetSampleSpacing(0.5);
+    VecFlt extractedData;
+    VecPt3d extractedLocations;
+    extractor->ComputeLocationsAndExtractData(polyline, extractedData, extractedLocations);
+    TS_ASSERT_EQUALS(expectedLocations, extractedLocations);
+    VecInt cellIdxs = extractor->GetCellIndexes();
+
+    // same values and cells as searching for every location
+    BSHP<XmUGrid2dDataExtractor> searched = XmUGrid2dDataExtractor::New(ugrid);
+    searched->SetGridPointScalars(pointScalars, DynBitset(), LOC_POINTS);
+    searched->SetExtractLocations(extractedLocations);
+    VecFlt expectedData;
+    searched->ExtractData(expectedData);
+    TS_ASSERT_DELTA_VEC(expectedData, extractedData, 1.0e-5);
+    TS_ASSERT_EQUALS(searched->GetCellIndexes(), cellIdxs);
+  }
+
+  // a number of locations in each segment
+  extractor->SetUseCellWalking(false);
+  extractor->SetSampleSpacing(0.0);
+  extractor->SetSamplesPerSegment(1);
+  polyline = {{0.25, 0.25, 0.0}, {0.75, 0.25, 0.0}, {0.75, 0.75, 0.0}};
+  extractor->SetPolyline(polyline);
+  VecPt3d expectedLocations = {{0.25, 0.25, 0.0}, {0.5, 0.25, 0.0}, {0.75, 0.25, 0.0},
+                               {0.75, 0.5, 0.0},  {0.75, 0.75, 0.0}};
+  TS_ASSERT_EQUALS(expectedLocations, extractor->GetExtractLocations());
+} // XmUGrid2dPolylineDataExtractorUnitTests::testSampleLocations
+//------------------------------------------------------------------------------
+/// \brief Test the station and segment of each location.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorUnitTests::testStations()
+{
+  // clang-format off
+  //     6-----------7-----------8
+  //     |           |           |
+  //     |     2     |     3     |
+  //     |           |           |
+  //     3-----------4-----------5
+  //     |           |           |
+  //     |     0     |     1     |
+  //     |           |           |
+  //     0-----------1-----------2
+  // clang-format on
+  VecPt3d points = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {0, 1, 0}, {1, 1, 0},
+                    {2, 1, 0}, {0, 2, 0}, {1, 2, 0}, {2, 2, 0}};
+  VecInt cells = {XMU_QUAD, 4, 0, 1, 4, 3, XMU_QUAD, 4, 1, 2, 5, 4,
+                  XMU_QUAD, 4, 3, 4, 7, 6, XMU_QUAD, 4, 4, 5, 8, 7};
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  BSHP<XmUGrid2dPolylineDataExtractor> extractor =
+    XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  VecFlt pointScalars = {0, 1, 2, 1, 2, 3, 2, 3, 4};
+  extractor->SetGridScalars(pointScalars, DynBitset(), LOC_POINTS);
+
+  // walking gives only the cell crossings
+  VecPt3d polyline = {{0.5, 0.5, 0.0}, {1.5, 0.5, 0.0}, {1.5, 1.5, 0.0}};
+  extractor->SetUseCellWalking(true);
+  extractor->SetPolyline(polyline);
+  VecPt3d expectedLocations = {
+    {0.5, 0.5, 0.0}, {1.0, 0.5, 0.0}, {1.5, 0.5, 0.0}, {1.5, 1.0, 0.0}, {1.5, 1.5, 0.0}};
+  TS_ASSERT_EQUALS(expectedLocations, extractor->GetExtractLocations());
+  VecDbl expectedStations = {0.0, 0.5, 1.0, 1.5, 2.0};
+  TS_ASSERT_DELTA_VEC(expectedStations, extractor->GetExtractStations(), 1.0e-9);
+  VecInt expectedSegments = {0, 0, 0, 1, 1};
+  TS_ASSERT_EQUALS(expectedSegments, extractor->GetExtractSegmentIndexes());
+
+  // the stations of triangle crossings and samples are the distance along the
+  // polyline
+  extractor->SetUseCellWalking(false);
+  extractor->SetSampleSpacing(0.3);
+  extractor->SetPolyline(polyline);
+  const VecPt3d& locations = extractor->GetExtractLocations();
+  const VecDbl& stations = extractor->GetExtractStations();
+  const VecInt& segments = extractor->GetExtractSegmentIndexes();
+  TS_ASSERT_EQUALS(locations.size(), stations.size());
+  TS_ASSERT_EQUALS(locations.size(), segments.size());
+  for (size_t i = 0; i < locations.size() && i < stations.size() && i < segments.size(); ++i)
+  {
+    double expected = segments[i] == 0 ? locations[i].x - 0.5 : 1.0 + locations[i].y - 0.5;
+    TS_ASSERT_DELTA(expected, stations[i], 1.0e-9);
+    if (i > 0)
+    {
+      TS_ASSERT(stations[i - 1] < stations[i]);
+      TS_ASSERT(segments[i - 1] <= segments[i]);
+    }
+  }
+  TS_ASSERT_EQUALS(1, segments.back());
+
+  // stations start over for each polyline
+  extractor->SetUseCellWalking(true);
+  extractor->SetSampleSpacing(0.0);
+  VecInt offsets = {0, 3, 5};
+  VecPt3d polylinePoints = polyline;
+  polylinePoints.push_back({0.5, 1.5, 0.0});
+  polylinePoints.push_back({1.5, 1.5, 0.0});
+  VecInt locationOffsets;
+  VecPt3d extractedLocations;
+  VecFlt extractedData;
+  VecInt cellIdxs;
+  extractor->ExtractPolylines(offsets, polylinePoints, locationOffsets, extractedLocations,
+                              extractedData, cellIdxs);
+  expectedStations.insert(expectedStations.end(), {0.0, 0.5, 1.0});
+  TS_ASSERT_DELTA_VEC(expectedStations, extractor->GetExtractStations(), 1.0e-9);
+  expectedSegments.insert(expectedSegments.end(), {0, 0, 0});
+  TS_ASSERT_EQUALS(expectedSegments, extractor->GetExtractSegmentIndexes());
+} // XmUGrid2dPolylineDataExtractorUnitTests::testStations
+//------------------------------------------------------------------------------
 /// \brief Test XmUGrid2dPolylineDataExtractor for tutorial with transient data.
 //------------------------------------------------------------------------------
 //! [snip_test_Example_TransientPolylineExtractor]
@@ -938,4 +2198,185 @@ void XmUGrid2dPolylineDataExtractorUnitTests::testTransientTutorial()
 } // XmUGrid2dPolylineDataExtractorUnitTests::testTransientTutorial
 //! [snip_test_Example_TransientPolylineExtractor]
 
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmUGrid2dPolylineDataExtractorIntermediateTests
+/// \brief Class to to test XmUGrid2dPolylineDataExtractor on large grids
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Time setting up the intersector for the first polyline on a large
+///        grid.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorIntermediateTests::testSetPolylineLargeGrid()
+{
+  const int rows = 700;
+  const int cols = 700;
+  VecPt3d points;
+  for (int row = 0; row <= rows; ++row)
+  {
+    for (int col = 0; col <= cols; ++col)
+      points.push_back(Pt3d(col, row, 0.0));
+  }
+  VecInt cells;
+  for (int row = 0; row < rows; ++row)
+  {
+    for (int col = 0; col < cols; ++col)
+    {
+      int pt0 = row * (cols + 1) + col;
+      int pt1 = pt0 + cols + 1;
+      cells.insert(cells.end(), {XMU_QUAD, 4, pt0, pt0 + 1, pt1 + 1, pt1});
+    }
+  }
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  BSHP<XmUGrid2dPolylineDataExtractor> extractor =
+    XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  VecFlt pointScalars(points.size());
+  for (size_t i = 0; i < pointScalars.size(); ++i)
+    pointScalars[i] = static_cast<float>(points[i].x + points[i].y);
+  extractor->SetGridScalars(pointScalars, DynBitset(), LOC_POINTS);
+  extractor->GetDataExtractor()->BuildTriangles(LOC_POINTS);
+
+  VecPt3d polyline = {{0.25, 0.5, 0.0}, {2.75, 0.5, 0.0}};
+  auto start = std::chrono::steady_clock::now();
+  extractor->SetPolyline(polyline);
+  std::chrono::duration<double> setupTime = std::chrono::steady_clock::now() - start;
+
+  // the part of the setup making a vector per polygon, which
+  // GmMultiPolyIntersector requires and copies, so they are freed afterward
+  const VecInt& triangles = extractor->GetDataExtractor()->GetUGridTriangles()->GetTriangles();
+  start = std::chrono::steady_clock::now();
+  VecInt2d polygons(triangles.size() / 3);
+  for (size_t i = 0; i < polygons.size(); ++i)
+    polygons[i].assign(triangles.begin() + 3 * i, triangles.begin() + 3 * i + 3);
+  std::chrono::duration<double> polygonTime = std::chrono::steady_clock::now() - start;
+  TS_ASSERT_EQUALS(2 * rows * cols, (int)polygons.size());
+
+  VecFlt extractedData;
+  extractor->ExtractData(extractedData);
+  VecFlt expectedData = {0.75f, 1.0f, 1.5f, 2.0f, 2.5f, 3.0f, 3.25f};
+  TS_ASSERT_DELTA_VEC(expectedData, extractedData, 1.0e-5);
+
+  // walk a transect across the whole grid without the intersector. Finding
+  // the cell of the first point builds the triangle search, which is most
+  // of the walking time
+  extractor = XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  extractor->SetGridScalars(pointScalars, DynBitset(), LOC_POINTS);
+  extractor->GetDataExtractor()->BuildTriangles(LOC_POINTS);
+  extractor->SetUseCellWalking(true);
+  polyline = {{0.3, 0.7, 0.0}, {699.1, 698.6, 0.0}};
+  start = std::chrono::steady_clock::now();
+  extractor->SetPolyline(polyline);
+  std::chrono::duration<double> walkTime = std::chrono::steady_clock::now() - start;
+
+  // the ends plus crossing x = 1 to 699 and y = 1 to 698
+  const VecPt3d& locations = extractor->GetExtractLocations();
+  TS_ASSERT_EQUALS(2 + 699 + 698, (int)locations.size());
+  start = std::chrono::steady_clock::now();
+  extractor->ExtractData(extractedData);
+  std::chrono::duration<double> walkExtractTime = std::chrono::steady_clock::now() - start;
+  bool dataMatches = extractedData.size() == locations.size();
+  for (size_t i = 0; dataMatches && i < locations.size(); ++i)
+    dataMatches = std::fabs(extractedData[i] - (locations[i].x + locations[i].y)) < 1.0e-2;
+  TS_ASSERT(dataMatches);
+
+  std::ostringstream msg;
+  msg << "SetPolyline with " << 2 * rows * cols << " triangles: " << setupTime.count()
+      << " seconds (making polygons " << polygonTime.count() << " seconds), walking "
+      << locations.size() << " locations: " << walkTime.count() << " seconds, extracting them: "
+      << walkExtractTime.count() << " seconds";
+  TS_TRACE(msg.str());
+} // XmUGrid2dPolylineDataExtractorIntermediateTests::testSetPolylineLargeGrid
+//------------------------------------------------------------------------------
+/// \brief Time extracting many polylines in a batch on all hardware threads
+///        against one at a time. The batch builds no more intersectors than
+///        the pool allows however many threads are asked for.
+//------------------------------------------------------------------------------
+void XmUGrid2dPolylineDataExtractorIntermediateTests::testExtractPolylinesBatch()
+{
+  const int rows = 70;
+  const int cols = 70;
+  VecPt3d points;
+  for (int row = 0; row <= rows; ++row)
+  {
+    for (int col = 0; col <= cols; ++col)
+      points.push_back(Pt3d(col, row, 0.0));
+  }
+  VecInt cells;
+  for (int row = 0; row < rows; ++row)
+  {
+    for (int col = 0; col < cols; ++col)
+    {
+      int pt0 = row * (cols + 1) + col;
+      int pt1 = pt0 + cols + 1;
+      cells.insert(cells.end(), {XMU_QUAD, 4, pt0, pt0 + 1, pt1 + 1, pt1});
+    }
+  }
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  VecFlt pointScalars(points.size());
+  for (size_t i = 0; i < pointScalars.size(); ++i)
+    pointScalars[i] = static_cast<float>(points[i].x + points[i].y);
+
+  // cross sections across the grid
+  const int numPolylines = 128;
+  VecInt offsets = {0};
+  VecPt3d polylinePoints;
+  for (int i = 0; i < numPolylines; ++i)
+  {
+    double y = 0.3 + (rows - 0.6) * i / numPolylines;
+    polylinePoints.push_back(Pt3d(0.2, y, 0.0));
+    polylinePoints.push_back(Pt3d(cols - 0.2, rows - y, 0.0));
+    offsets.push_back((int)polylinePoints.size());
+  }
+
+  BSHP<XmUGrid2dPolylineDataExtractor> serial =
+    XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  serial->SetGridScalars(pointScalars, DynBitset(), LOC_POINTS);
+  serial->GetDataExtractor()->BuildTriangles(LOC_POINTS);
+  serial->SetPolyline({polylinePoints[0], polylinePoints[1]});
+  VecPt3d serialLocations;
+  VecFlt serialData;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < numPolylines; ++i)
+  {
+    VecPt3d polyline(polylinePoints.begin() + offsets[i], polylinePoints.begin() + offsets[i + 1]);
+    VecFlt data;
+    VecPt3d locations;
+    serial->ComputeLocationsAndExtractData(polyline, data, locations);
+    serialLocations.insert(serialLocations.end(), locations.begin(), locations.end());
+    serialData.insert(serialData.end(), data.begin(), data.end());
+  }
+  std::chrono::duration<double> serialTime = std::chrono::steady_clock::now() - start;
+
+  BSHP<XmUGrid2dPolylineDataExtractor> batch =
+    XmUGrid2dPolylineDataExtractor::New(ugrid, LOC_POINTS);
+  batch->SetGridScalars(pointScalars, DynBitset(), LOC_POINTS);
+  int numThreads = std::max(xmResolveThreadCount(0), 8);
+  batch->GetDataExtractor()->SetThreadCount(numThreads);
+  batch->GetDataExtractor()->BuildTriangles(LOC_POINTS);
+  VecInt locationOffsets;
+  VecPt3d batchLocations;
+  VecFlt batchData;
+  VecInt cellIdxs;
+  // the first batch builds the workers' intersectors
+  batch->ExtractPolylines(offsets, polylinePoints, locationOffsets, batchLocations, batchData,
+                          cellIdxs);
+  start = std::chrono::steady_clock::now();
+  batch->ExtractPolylines(offsets, polylinePoints, locationOffsets, batchLocations, batchData,
+                          cellIdxs);
+  std::chrono::duration<double> batchTime = std::chrono::steady_clock::now() - start;
+  int intersectorBuilds =
+    BDPC<XmUGrid2dPolylineDataExtractorImpl>(batch)->GetIntersectorBuildCount();
+  TS_ASSERT(intersectorBuilds >= 1 && intersectorBuilds <= MAX_INTERSECTORS);
+
+  TS_ASSERT_EQUALS(serialLocations, batchLocations);
+  TS_ASSERT_DELTA_VEC(serialData, batchData, 1.0e-5);
+
+  std::ostringstream msg;
+  msg << numPolylines << " polylines with " << 2 * rows * cols
+      << " triangles: one at a time " << serialTime.count() << " seconds, batch on "
+      << std::min(numThreads, MAX_INTERSECTORS) << " threads (" << intersectorBuilds
+      << " intersectors, " << xmResolveThreadCount(0) << " hardware threads) "
+      << batchTime.count() << " seconds";
+  TS_TRACE(msg.str());
+} // XmUGrid2dPolylineDataExtractorIntermediateTests::testExtractPolylinesBatch
+
 #endif
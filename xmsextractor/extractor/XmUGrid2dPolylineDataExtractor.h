@@ -41,6 +41,8 @@ class XmUGrid2dPolylineDataExtractor
 public:
   static BSHP<XmUGrid2dPolylineDataExtractor> New(std::shared_ptr<XmUGrid> a_ugrid,
                                                   DataLocationEnum a_scalarLocation);
+  static BSHP<XmUGrid2dPolylineDataExtractor> New(
+    BSHP<XmUGrid2dPolylineDataExtractor> a_extractor);
   virtual ~XmUGrid2dPolylineDataExtractor();
 
   /// \brief Gets the underlying data extractor. Convenience so a user would not have to
@@ -55,6 +57,14 @@ public:
   virtual void SetGridScalars(const VecFlt& a_scalars,
                               const DynBitset& a_activity,
                               DataLocationEnum a_activityLocation) = 0;
+  /// \brief Setup scalars taking over the vector instead of copying point
+  ///        scalars.
+  /// \param[in] a_scalars The cell or point scalars.
+  /// \param[in] a_activity The activity of the cells.
+  /// \param[in] a_activityLocation The location at which the data is currently stored.
+  virtual void SetGridScalars(VecFlt&& a_scalars,
+                              const DynBitset& a_activity,
+                              DataLocationEnum a_activityLocation) = 0;
 
   /// \brief Set the polyline along which to extract the scalar data. Locations
   ///        crossing cell boundaries are computed along the polyline.
@@ -71,6 +81,25 @@ public:
   virtual void ComputeLocationsAndExtractData(const VecPt3d& a_polyline,
                                               VecFlt& a_extractedData,
                                               VecPt3d& a_extractedLocations) = 0;
+  /// \brief Extract data along many polylines at once. The polylines are
+  ///        split up on the data extractor's threads. The locations of all
+  ///        polylines become the extract locations.
+  /// \param[in] a_polylineOffsets The index of the first point of each
+  ///            polyline followed by the number of points (number of
+  ///            polylines + 1).
+  /// \param[in] a_polylinePoints The points of every polyline one polyline
+  ///            after another.
+  /// \param[out] a_locationOffsets The index of the first location of each
+  ///             polyline followed by the number of locations.
+  /// \param[out] a_locations The locations of every polyline.
+  /// \param[out] a_extractedData The interpolated scalars at the locations.
+  /// \param[out] a_cellIdxs The cell index of each location or -1 if outside.
+  virtual void ExtractPolylines(const VecInt& a_polylineOffsets,
+                                const VecPt3d& a_polylinePoints,
+                                VecInt& a_locationOffsets,
+                                VecPt3d& a_locations,
+                                VecFlt& a_extractedData,
+                                VecInt& a_cellIdxs) = 0;
 
   /// \brief Set to use IDW to calculate point scalar values from cell scalars.
   /// \param a_useIdw Whether to turn IDW on or off.
@@ -79,16 +108,45 @@ public:
   ///        intersect with the grid.
   /// \param[in] a_noDataValue The no data value
   virtual void SetNoDataValue(float a_noDataValue) = 0;
-
-  /// \brief Gets the scalars
+  /// \brief Set to find polyline locations by walking from cell to cell
+  ///        across UGrid cell edges instead of intersecting the polyline with
+  ///        every triangle. Locations are then where the polyline crosses cell
+  ///        edges rather than triangle edges. Parts of the polyline outside the
+  ///        UGrid or in cells that aren't convex fall back to the intersector.
+  ///        The cell of the first point is searched for, which builds the
+  ///        triangle search; the other locations take the triangle of the
+  ///        walked cell containing them.
+  /// \param[in] a_useCellWalking Whether to turn cell walking on or off.
+  virtual void SetUseCellWalking(bool a_useCellWalking) = 0;
+  /// \brief Set a station spacing at which to add locations along the
+  ///        polyline in addition to its points and cell crossings. Stations
+  ///        are measured in plan view from the start of the polyline.
+  /// \param[in] a_spacing The spacing. Zero or less for none.
+  virtual void SetSampleSpacing(double a_spacing) = 0;
+  /// \brief Set a number of locations to add evenly spaced inside each polyline
+  ///        segment in addition to its points and cell crossings.
+  /// \param[in] a_count The number of locations per segment. Zero for none.
+  virtual void SetSamplesPerSegment(int a_count) = 0;
+
+  /// \brief Gets a copy of the scalars at the triangle points.
   /// \return The scalars.
-  virtual const VecFlt& GetScalars() const = 0;
+  virtual VecFlt GetScalars() const = 0;
   /// \brief Gets the location of the scalars (points or cells)
   /// \return The location of the scalars.
   virtual DataLocationEnum GetScalarLocation() const = 0;
   /// \brief Gets computed locations along polyline to extract interpolated scalar data from.
   /// \return The locations.
   virtual const VecPt3d& GetExtractLocations() const = 0;
+  /// \brief Gets the station of each location computed by SetPolyline,
+  ///        ComputeLocationsAndExtractData or ExtractPolylines. Stations are
+  ///        measured in plan view from the start of each polyline.
+  /// \return The stations.
+  virtual const VecDbl& GetExtractStations() const = 0;
+  /// \brief Gets the polyline segment of each computed location. A location at
+  ///        a polyline point is on the segment ending there and the first
+  ///        location is on segment 0.
+  /// \return The segment indexes.
+  virtual const VecInt& GetExtractSegmentIndexes() const = 0;
   /// \brief Gets cell indexes associated with the extract location points.
   /// \return The cell indexes.
   virtual const VecInt& GetCellIndexes() const = 0;
@@ -98,6 +156,15 @@ public:
   /// \brief Gets the no data value
   /// \return The no data value.
   virtual float GetNoDataValue() const = 0;
+  /// \brief Gets the option for walking cells to find polyline locations.
+  /// \return The option.
+  virtual bool GetUseCellWalking() const = 0;
+  /// \brief Gets the station spacing of added locations.
+  /// \return The spacing or zero for none.
+  virtual double GetSampleSpacing() const = 0;
+  /// \brief Gets the number of locations added inside each polyline segment.
+  /// \return The number of locations.
+  virtual int GetSamplesPerSegment() const = 0;
 
 private:
   XM_DISALLOW_COPY_AND_ASSIGN(XmUGrid2dPolylineDataExtractor)
@@ -44,8 +44,21 @@ public:
   void testThreeSegmentsCrossOnBoundary();
 
   void testCellScalars();
+  void testExtractPolylines();
+  void testCellWalking();
+  void testSharedIntersector();
+  void testSampleLocations();
+  void testStations();
 
   void testTransientTutorial();
 }; // XmUGrid2dPolylineDataExtractorUnitTests
 
+////////////////////////////////////////////////////////////////////////////////
+class XmUGrid2dPolylineDataExtractorIntermediateTests : public CxxTest::TestSuite
+{
+public:
+  void testSetPolylineLargeGrid();
+  void testExtractPolylinesBatch();
+}; // XmUGrid2dPolylineDataExtractorIntermediateTests
+
 #endif
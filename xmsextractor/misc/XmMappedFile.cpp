@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup misc
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsextractor/misc/XmMappedFile.h>
+
+// 3. Standard library headers
+#include <atomic>
+#include <cstdio>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 4. External library headers
+
+// 5. Shared code headers
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+/// XMS Namespace
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Constructor.
+//------------------------------------------------------------------------------
+XmMappedFile::XmMappedFile()
+: m_data(nullptr)
+, m_size(0)
+, m_file(nullptr)
+, m_mapping(nullptr)
+{
+} // XmMappedFile::XmMappedFile
+//------------------------------------------------------------------------------
+/// \brief Destructor. Unmaps the file.
+//------------------------------------------------------------------------------
+XmMappedFile::~XmMappedFile()
+{
+  Close();
+} // XmMappedFile::~XmMappedFile
+//------------------------------------------------------------------------------
+/// \brief Map a file read only. Closes any file already open.
+/// \param[in] a_fileName The file to map.
+/// \return True if the file was mapped. An empty file can't be mapped.
+//------------------------------------------------------------------------------
+bool XmMappedFile::Open(const std::string& a_fileName)
+{
+  Close();
+#ifdef _WIN32
+  HANDLE file = CreateFileA(a_fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping)
+  {
+    CloseHandle(file);
+    return false;
+  }
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!data)
+  {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  m_file = file;
+  m_mapping = mapping;
+  m_data = static_cast<const char*>(data);
+  m_size = static_cast<size_t>(size.QuadPart);
+#else
+  int fd = open(a_fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+  size_t size = static_cast<size_t>(fileStat.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+  m_data = static_cast<const char*>(data);
+  m_size = size;
+#endif
+  return true;
+} // XmMappedFile::Open
+//------------------------------------------------------------------------------
+/// \brief Unmap the file if one is open.
+//------------------------------------------------------------------------------
+void XmMappedFile::Close()
+{
+  if (!m_data)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+  CloseHandle(static_cast<HANDLE>(m_mapping));
+  CloseHandle(static_cast<HANDLE>(m_file));
+#else
+  munmap(const_cast<char*>(m_data), m_size);
+#endif
+  m_data = nullptr;
+  m_size = 0;
+  m_file = nullptr;
+  m_mapping = nullptr;
+} // XmMappedFile::Close
+//------------------------------------------------------------------------------
+/// \brief Get a name for a temporary file in the same directory as a file,
+///        unique to the process and call, to write before replacing the file.
+/// \param[in] a_fileName The file that will be replaced.
+/// \return The temporary file name.
+//------------------------------------------------------------------------------
+std::string xmTempFileName(const std::string& a_fileName)
+{
+  static std::atomic<unsigned> counter(0);
+#ifdef _WIN32
+  unsigned long processId = GetCurrentProcessId();
+#else
+  unsigned long processId = static_cast<unsigned long>(getpid());
+#endif
+  return a_fileName + "." + std::to_string(processId) + "." + std::to_string(counter++) + ".tmp";
+} // xmTempFileName
+//------------------------------------------------------------------------------
+/// \brief Replace a file with a completely written temporary file in one
+///        step. Readers that have the old file open or mapped keep seeing
+///        the old contents and others see the old or new file, never a
+///        partly written one. The temporary file is removed if it can't
+///        replace the file, such as on Windows while the file is mapped.
+/// \param[in] a_tempFileName The temporary file from xmTempFileName.
+/// \param[in] a_fileName The file to replace.
+/// \return True if the file was replaced.
+//------------------------------------------------------------------------------
+bool xmReplaceFile(const std::string& a_tempFileName, const std::string& a_fileName)
+{
+#ifdef _WIN32
+  bool replaced = MoveFileExA(a_tempFileName.c_str(), a_fileName.c_str(),
+                              MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  bool replaced = std::rename(a_tempFileName.c_str(), a_fileName.c_str()) == 0;
+#endif
+  if (!replaced)
+    std::remove(a_tempFileName.c_str());
+  return replaced;
+} // xmReplaceFile
+
+} // namespace xms
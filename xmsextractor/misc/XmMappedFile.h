@@ -0,0 +1,67 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Contains the XmMappedFile class for read only memory mapped files.
+/// \ingroup misc
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+#include <string>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/misc/base_macros.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+/// XMS Namespace
+namespace xms
+{
+//----- Forward declarations ---------------------------------------------------
+
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmMappedFile
+/// \brief A file mapped read only into memory. The file contents are paged in
+///        by the operating system as they are read.
+////////////////////////////////////////////////////////////////////////////////
+class XmMappedFile
+{
+public:
+  XmMappedFile();
+  ~XmMappedFile();
+
+  bool Open(const std::string& a_fileName);
+  void Close();
+
+  /// \brief Get the mapped file contents.
+  /// \return The first byte of the file or null if no file is open.
+  const char* GetData() const { return m_data; }
+  /// \brief Get the size of the mapped file.
+  /// \return The number of bytes in the file.
+  size_t GetSize() const { return m_size; }
+
+private:
+  XM_DISALLOW_COPY_AND_ASSIGN(XmMappedFile)
+
+  const char* m_data; ///< The mapped file contents
+  size_t m_size;      ///< The number of bytes in the file
+  void* m_file;       ///< File handle (Windows only)
+  void* m_mapping;    ///< File mapping handle (Windows only)
+};
+
+//----- Function prototypes ----------------------------------------------------
+std::string xmTempFileName(const std::string& a_fileName);
+bool xmReplaceFile(const std::string& a_tempFileName, const std::string& a_fileName);
+
+} // namespace xms
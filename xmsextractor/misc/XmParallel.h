@@ -0,0 +1,106 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Utilities for splitting index ranges across worker threads.
+/// \ingroup misc
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// 4. External library headers
+
+// 5. Shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+/// XMS Namespace
+namespace xms
+{
+//----- Forward declarations ---------------------------------------------------
+
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+
+//----- Function prototypes ----------------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Get the number of threads to use for a requested thread count.
+/// \param[in] a_numThreads The requested number of threads. Values less than
+///            one use the number of hardware threads.
+/// \return The number of threads to use (at least one).
+//------------------------------------------------------------------------------
+inline int xmResolveThreadCount(int a_numThreads)
+{
+  if (a_numThreads > 0)
+    return a_numThreads;
+  int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+  return std::max(1, hardwareThreads);
+} // xmResolveThreadCount
+//------------------------------------------------------------------------------
+/// \brief Call a function on contiguous chunks of the range [0, a_count) using
+///        up to a_numThreads threads. The first chunk is run on the calling
+///        thread. An exception thrown by any chunk is rethrown after all
+///        threads have finished.
+/// \param[in] a_count The number of items in the range.
+/// \param[in] a_numThreads The requested number of threads (see
+///            xmResolveThreadCount).
+/// \param[in] a_minChunkSize The smallest number of items given to a thread.
+/// \param[in] a_func Function called as a_func(begin, end) for each chunk.
+//------------------------------------------------------------------------------
+template <typename Func>
+void xmParallelFor(size_t a_count, int a_numThreads, size_t a_minChunkSize, Func a_func)
+{
+  if (a_count == 0)
+    return;
+
+  size_t numChunks = static_cast<size_t>(xmResolveThreadCount(a_numThreads));
+  size_t maxChunks = (a_count + std::max<size_t>(a_minChunkSize, 1) - 1) /
+                     std::max<size_t>(a_minChunkSize, 1);
+  numChunks = std::min(numChunks, maxChunks);
+  if (numChunks <= 1)
+  {
+    a_func(size_t(0), a_count);
+    return;
+  }
+
+  std::vector<std::exception_ptr> errors(numChunks);
+  auto runChunk = [&](size_t a_chunk) {
+    size_t begin = a_count * a_chunk / numChunks;
+    size_t end = a_count * (a_chunk + 1) / numChunks;
+    try
+    {
+      a_func(begin, end);
+    }
+    catch (...)
+    {
+      errors[a_chunk] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(numChunks - 1);
+  for (size_t chunk = 1; chunk < numChunks; ++chunk)
+    threads.emplace_back(runChunk, chunk);
+  runChunk(0);
+  for (auto& thread : threads)
+    thread.join();
+
+  for (auto& error : errors)
+  {
+    if (error)
+      std::rethrow_exception(error);
+  }
+} // xmParallelFor
+
+} // namespace xms
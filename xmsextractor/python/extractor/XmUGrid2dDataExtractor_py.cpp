@@ -40,52 +40,80 @@ void initXmUGrid2dDataExtractor(py::module &m) {
     // -------------------------------------------------------------------------
     // function: SetGridPointScalars
     // -------------------------------------------------------------------------
-    extractor.def("SetGridPointScalars", [](xms::XmUGrid2dDataExtractor &self, py::iterable a_pointScalars,
-                     py::iterable a_activity, xms::DataLocationEnum a_activityType) {
-      boost::shared_ptr<xms::VecFlt> pointScalars = xms::VecFltFromPyIter(a_pointScalars);
-      xms::DynBitset activity = xms::DynamicBitsetFromPyIter(a_activity);
-      self.SetGridPointScalars(*pointScalars, activity, a_activityType);
+    extractor.def("SetGridPointScalars", [](xms::XmUGrid2dDataExtractor &self, py::object a_pointScalars,
+                     py::object a_activity, xms::DataLocationEnum a_activityType) {
+      xms::VecFlt pointScalars = VecFltFromPyObject(a_pointScalars);
+      xms::DynBitset activity = DynBitsetFromPyObject(a_activity);
+      PyCallExclusive(&self, [&]() {
+        self.SetGridPointScalars(std::move(pointScalars), activity, a_activityType);
+      });
     }, py::arg("point_scalars"), py::arg("activity"), py::arg("activity_type"));
 
     // -------------------------------------------------------------------------
     // function: SetGridCellScalars
     // -------------------------------------------------------------------------
-    extractor.def("SetGridCellScalars", [](xms::XmUGrid2dDataExtractor &self, py::iterable a_cellScalars,
-                     py::iterable a_activity, xms::DataLocationEnum a_activityType) {
-      boost::shared_ptr<xms::VecFlt> cellScalars = xms::VecFltFromPyIter(a_cellScalars);
-      xms::DynBitset activity = xms::DynamicBitsetFromPyIter(a_activity);
-      self.SetGridCellScalars(*cellScalars, activity, a_activityType);
+    extractor.def("SetGridCellScalars", [](xms::XmUGrid2dDataExtractor &self, py::object a_cellScalars,
+                     py::object a_activity, xms::DataLocationEnum a_activityType) {
+      // cell scalars are only read while they are set, so NumPy arrays are read in place
+      auto cellScalars = PyFloatArrayFromPyObject(a_cellScalars);
+      const float* data = cellScalars.data();
+      size_t numScalars = static_cast<size_t>(cellScalars.size());
+      xms::DynBitset activity = DynBitsetFromPyObject(a_activity);
+      PyCallExclusive(&self, [&]() {
+        self.SetGridCellScalars(data, numScalars, activity, a_activityType);
+      });
     }, py::arg("point_scalars"), py::arg("activity") ,py::arg("activity_type"));
 
+    // -------------------------------------------------------------------------
+    // function: UpdateGridActivity
+    // -------------------------------------------------------------------------
+    extractor.def("UpdateGridActivity", [](xms::XmUGrid2dDataExtractor &self, py::iterable a_changedIdxs,
+                     py::object a_activity, xms::DataLocationEnum a_activityType) {
+      xms::VecInt changedIdxs = *xms::VecIntFromPyIter(a_changedIdxs);
+      xms::DynBitset activity = DynBitsetFromPyObject(a_activity);
+      PyCallExclusive(&self, [&]() { self.UpdateGridActivity(changedIdxs, activity, a_activityType); });
+    }, py::arg("changed_idxs"), py::arg("activity"), py::arg("activity_type"));
+
+    // -------------------------------------------------------------------------
+    // function: UpdateGridScalars
+    // -------------------------------------------------------------------------
+    extractor.def("UpdateGridScalars", [](xms::XmUGrid2dDataExtractor &self, py::iterable a_idxs,
+                     py::object a_values) {
+      xms::VecInt idxs = *xms::VecIntFromPyIter(a_idxs);
+      xms::VecFlt values = VecFltFromPyObject(a_values);
+      PyCallExclusive(&self, [&]() { self.UpdateGridScalars(idxs, values); });
+    }, py::arg("idxs"), py::arg("values"));
+
     // -------------------------------------------------------------------------
     // function: SetExtractLocations
     // -------------------------------------------------------------------------
-    extractor.def("SetExtractLocations", [](xms::XmUGrid2dDataExtractor &self, py::iterable locations) {
-      boost::shared_ptr<xms::VecPt3d> _locations = xms::VecPt3dFromPyIter(locations);
-      self.SetExtractLocations(*_locations);
+    extractor.def("SetExtractLocations", [](xms::XmUGrid2dDataExtractor &self, py::object locations) {
+      xms::VecPt3d _locations = VecPt3dFromPyObject(locations);
+      PyCallExclusive(&self, [&]() { self.SetExtractLocations(_locations); });
     }, py::arg("locations"));
 
     // -------------------------------------------------------------------------
     // function: GetExtractLocations
     // -------------------------------------------------------------------------
     extractor.def("GetExtractLocations", [](xms::XmUGrid2dDataExtractor &self) {
-      return xms::PyIterFromVecPt3d(self.GetExtractLocations());
+      return PyCallSharedWithGil(&self, [&]() { return PyArrayFromVecPt3d(self.GetExtractLocations()); });
     });
 
     // -------------------------------------------------------------------------
     // function: GetCellIndexes
     // -------------------------------------------------------------------------
     extractor.def("GetCellIndexes", [](xms::XmUGrid2dDataExtractor &self) {
-      return xms::PyIterFromVecInt(self.GetCellIndexes());
+      xms::VecInt cellIdxs = PyCallShared(&self, [&]() { return self.GetCellIndexes(); });
+      return PyArrayFromVecInt(std::move(cellIdxs));
     });
 
     // -------------------------------------------------------------------------
     // function: ExtractData
     // -------------------------------------------------------------------------
-    extractor.def("ExtractData", [](xms::XmUGrid2dDataExtractor &self) -> py::iterable {
+    extractor.def("ExtractData", [](xms::XmUGrid2dDataExtractor &self) -> py::array {
       xms::VecFlt outData;
-      self.ExtractData(outData);
-      return xms::PyIterFromVecFlt(outData);
+      PyCallExclusive(&self, [&]() { self.ExtractData(outData); });
+      return PyArrayFromVecFlt(std::move(outData));
     });
 
     // -------------------------------------------------------------------------
@@ -93,28 +121,98 @@ void initXmUGrid2dDataExtractor(py::module &m) {
     // -------------------------------------------------------------------------
     extractor.def("ExtractAtLocation", [](xms::XmUGrid2dDataExtractor &self, py::iterable location) -> float {
       xms::Pt3d _location = xms::Pt3dFromPyIter(location);
-      return self.ExtractAtLocation(_location);
+      return PyCallShared(&self, [&]() { return self.ExtractAtLocation(_location); });
     }, py::arg("location"));
 
+    // -------------------------------------------------------------------------
+    // function: ExtractTimesteps
+    // -------------------------------------------------------------------------
+    extractor.def("ExtractTimesteps", [](xms::XmUGrid2dDataExtractor &self, py::object a_scalars,
+                     xms::DataLocationEnum a_scalarLocation, py::iterable a_activity,
+                     xms::DataLocationEnum a_activityType) -> py::array {
+      xms::VecFlt scalars = VecFltFromPyObject(a_scalars);
+      std::vector<xms::DynBitset> activity;
+      for (auto stepActivity : a_activity) {
+        activity.push_back(DynBitsetFromPyObject(py::reinterpret_borrow<py::object>(stepActivity)));
+      }
+      xms::VecFlt outData;
+      PyCallExclusive(&self, [&]() {
+        self.ExtractTimesteps(scalars, a_scalarLocation, activity, a_activityType, outData);
+      });
+      return PyArrayFromVecFlt(std::move(outData));
+    }, py::arg("scalars"), py::arg("scalar_location"), py::arg("activity"), py::arg("activity_type"));
+
     // -------------------------------------------------------------------------
     // function: SetUseIdwForPointData
     // -------------------------------------------------------------------------
-    extractor.def("SetUseIdwForPointData", &xms::XmUGrid2dDataExtractor::SetUseIdwForPointData, py::arg("use_idw"));
+    extractor.def("SetUseIdwForPointData", [](xms::XmUGrid2dDataExtractor &self, bool a_value) {
+      PyCallExclusive(&self, [&]() { self.SetUseIdwForPointData(a_value); });
+    }, py::arg("use_idw"));
 
     // -------------------------------------------------------------------------
     // function: GetUseIdwForPointData
     // -------------------------------------------------------------------------
-    extractor.def("GetUseIdwForPointData", &xms::XmUGrid2dDataExtractor::GetUseIdwForPointData);
+    extractor.def("GetUseIdwForPointData", [](xms::XmUGrid2dDataExtractor &self) {
+      return PyCallShared(&self, [&]() { return self.GetUseIdwForPointData(); });
+    });
 
     // -------------------------------------------------------------------------
     // function: SetNoDataValue
     // -------------------------------------------------------------------------
-    extractor.def("SetNoDataValue", &xms::XmUGrid2dDataExtractor::SetNoDataValue, py::arg("no_data_value"));
+    extractor.def("SetNoDataValue", [](xms::XmUGrid2dDataExtractor &self, float a_value) {
+      PyCallExclusive(&self, [&]() { self.SetNoDataValue(a_value); });
+    }, py::arg("no_data_value"));
 
     // -------------------------------------------------------------------------
     // function: GetNoDataValue
     // -------------------------------------------------------------------------
-    extractor.def("GetNoDataValue", &xms::XmUGrid2dDataExtractor::GetNoDataValue);
+    extractor.def("GetNoDataValue", [](xms::XmUGrid2dDataExtractor &self) {
+      return PyCallShared(&self, [&]() { return self.GetNoDataValue(); });
+    });
+
+    // -------------------------------------------------------------------------
+    // function: SetThreadCount
+    // -------------------------------------------------------------------------
+    extractor.def("SetThreadCount", [](xms::XmUGrid2dDataExtractor &self, int a_value) {
+      PyCallExclusive(&self, [&]() { self.SetThreadCount(a_value); });
+    }, py::arg("thread_count"));
+
+    // -------------------------------------------------------------------------
+    // function: GetThreadCount
+    // -------------------------------------------------------------------------
+    extractor.def("GetThreadCount", [](xms::XmUGrid2dDataExtractor &self) {
+      return PyCallShared(&self, [&]() { return self.GetThreadCount(); });
+    });
+
+    // -------------------------------------------------------------------------
+    // function: SetUsePreparedLocations
+    // -------------------------------------------------------------------------
+    extractor.def("SetUsePreparedLocations", [](xms::XmUGrid2dDataExtractor &self, bool a_value) {
+      PyCallExclusive(&self, [&]() { self.SetUsePreparedLocations(a_value); });
+    }, py::arg("use_prepared"));
+
+    // -------------------------------------------------------------------------
+    // function: GetUsePreparedLocations
+    // -------------------------------------------------------------------------
+    extractor.def("GetUsePreparedLocations", [](xms::XmUGrid2dDataExtractor &self) {
+      return PyCallShared(&self, [&]() { return self.GetUsePreparedLocations(); });
+    });
+
+    // -------------------------------------------------------------------------
+    // function: SetTrianglesCacheFile
+    // -------------------------------------------------------------------------
+    extractor.def("SetTrianglesCacheFile", [](xms::XmUGrid2dDataExtractor &self,
+                                              const std::string &a_fileName) {
+      PyCallExclusive(&self, [&]() { self.SetTrianglesCacheFile(a_fileName); });
+    }, py::arg("file_name"));
+
+    // -------------------------------------------------------------------------
+    // function: GetTrianglesCacheFile
+    // -------------------------------------------------------------------------
+    extractor.def("GetTrianglesCacheFile", [](xms::XmUGrid2dDataExtractor &self) {
+      // copy the name while the lock is held so SetTrianglesCacheFile can't change it
+      return PyCallShared(&self, [&]() -> std::string { return self.GetTrianglesCacheFile(); });
+    });
 
     // DataLocationEnum
     py::enum_<xms::DataLocationEnum>(m, "data_location_enum",
@@ -51,73 +51,163 @@ void initXmUGrid2dPolylineDataExtractor(py::module &m) {
     // function: SetGridScalars
     // -------------------------------------------------------------------------
     extractor.def("SetGridScalars", [](xms::XmUGrid2dPolylineDataExtractor &self,
-                     py::iterable scalars, py::iterable activity, xms::DataLocationEnum activity_type) {
-      boost::shared_ptr<xms::VecFlt> _scalars = xms::VecFltFromPyIter(scalars);
-      xms::DynBitset _activity = xms::DynamicBitsetFromPyIter(activity);
-      self.SetGridScalars(*_scalars, _activity, activity_type);
+                     py::object scalars, py::object activity, xms::DataLocationEnum activity_type) {
+      xms::VecFlt _scalars = VecFltFromPyObject(scalars);
+      xms::DynBitset _activity = DynBitsetFromPyObject(activity);
+      PyCallExclusive(&self, [&]() { self.SetGridScalars(std::move(_scalars), _activity, activity_type); });
     }, py::arg("scalars"),py::arg("activity"), py::arg("activity_type"));
 
     // -------------------------------------------------------------------------
     // function: SetPolyline
     // -------------------------------------------------------------------------
-    extractor.def("SetPolyline", [](xms::XmUGrid2dPolylineDataExtractor &self, py::iterable polyline) {
-      boost::shared_ptr<xms::VecPt3d> _polyline = xms::VecPt3dFromPyIter(polyline);
-      self.SetPolyline(*_polyline);
+    extractor.def("SetPolyline", [](xms::XmUGrid2dPolylineDataExtractor &self, py::object polyline) {
+      xms::VecPt3d _polyline = VecPt3dFromPyObject(polyline);
+      PyCallExclusive(&self, [&]() { self.SetPolyline(_polyline); });
     },py::arg("polyline"));
 
     // -------------------------------------------------------------------------
     // function: GetExtractLocations
     // -------------------------------------------------------------------------
-    extractor.def("GetExtractLocations", [](xms::XmUGrid2dPolylineDataExtractor &self) -> py::iterable {
-      xms::VecPt3d locations = self.GetExtractLocations();
-      return xms::PyIterFromVecPt3d(locations);
+    extractor.def("GetExtractLocations", [](xms::XmUGrid2dPolylineDataExtractor &self) -> py::array {
+      return PyCallSharedWithGil(&self, [&]() { return PyArrayFromVecPt3d(self.GetExtractLocations()); });
+    });
+
+    // -------------------------------------------------------------------------
+    // function: GetExtractStations
+    // -------------------------------------------------------------------------
+    extractor.def("GetExtractStations", [](xms::XmUGrid2dPolylineDataExtractor &self) -> py::array {
+      xms::VecDbl stations = PyCallShared(&self, [&]() { return self.GetExtractStations(); });
+      return PyArrayFromVecDbl(std::move(stations));
+    });
+
+    // -------------------------------------------------------------------------
+    // function: GetExtractSegmentIndexes
+    // -------------------------------------------------------------------------
+    extractor.def("GetExtractSegmentIndexes", [](xms::XmUGrid2dPolylineDataExtractor &self) -> py::array {
+      xms::VecInt segmentIdxs = PyCallShared(&self, [&]() { return self.GetExtractSegmentIndexes(); });
+      return PyArrayFromVecInt(std::move(segmentIdxs));
     });
 
     // -------------------------------------------------------------------------
     // function: GetCellIndexes
     // -------------------------------------------------------------------------
-    extractor.def("GetCellIndexes", [](xms::XmUGrid2dPolylineDataExtractor &self) -> py::iterable {
-      return xms::PyIterFromVecInt(self.GetCellIndexes());
+    extractor.def("GetCellIndexes", [](xms::XmUGrid2dPolylineDataExtractor &self) -> py::array {
+      xms::VecInt cellIdxs = PyCallShared(&self, [&]() { return self.GetCellIndexes(); });
+      return PyArrayFromVecInt(std::move(cellIdxs));
     });
 
     // -------------------------------------------------------------------------
     // function: ExtractData
     // -------------------------------------------------------------------------
-    extractor.def("ExtractData", [](xms::XmUGrid2dPolylineDataExtractor &self) -> py::iterable {
+    extractor.def("ExtractData", [](xms::XmUGrid2dPolylineDataExtractor &self) -> py::array {
       xms::VecFlt outData;
-      self.ExtractData(outData);
-      return xms::PyIterFromVecFlt(outData);
+      PyCallExclusive(&self, [&]() { self.ExtractData(outData); });
+      return PyArrayFromVecFlt(std::move(outData));
     });
 
     // -------------------------------------------------------------------------
     // function: ComputeLocationsAndExtractData
     // -------------------------------------------------------------------------
     extractor.def("ComputeLocationsAndExtractData", [](xms::XmUGrid2dPolylineDataExtractor &self,
-                     py::iterable polyline) -> py::iterable {
-      boost::shared_ptr<xms::VecPt3d> line(xms::VecPt3dFromPyIter(polyline));
+                     py::object polyline) -> py::tuple {
+      xms::VecPt3d line = VecPt3dFromPyObject(polyline);
       xms::VecFlt extracted_data;
       xms::VecPt3d extracted_locations;
-      self.ComputeLocationsAndExtractData(*line, extracted_data, extracted_locations);
-      return py::make_tuple(extracted_data, extracted_locations);
-    });
+      PyCallExclusive(&self, [&]() {
+        self.ComputeLocationsAndExtractData(line, extracted_data, extracted_locations);
+      });
+      return py::make_tuple(PyArrayFromVecFlt(std::move(extracted_data)),
+                            PyArrayFromVecPt3d(extracted_locations));
+    }, py::arg("polyline"));
+
+    // -------------------------------------------------------------------------
+    // function: ExtractPolylines
+    // -------------------------------------------------------------------------
+    extractor.def("ExtractPolylines", [](xms::XmUGrid2dPolylineDataExtractor &self,
+                     py::iterable polyline_offsets, py::object polyline_points) -> py::tuple {
+      xms::VecInt offsets = *xms::VecIntFromPyIter(polyline_offsets);
+      xms::VecPt3d points = VecPt3dFromPyObject(polyline_points);
+      xms::VecInt location_offsets;
+      xms::VecPt3d locations;
+      xms::VecFlt extracted_data;
+      xms::VecInt cell_idxs;
+      PyCallExclusive(&self, [&]() {
+        self.ExtractPolylines(offsets, points, location_offsets, locations, extracted_data,
+                              cell_idxs);
+      });
+      return py::make_tuple(PyArrayFromVecInt(std::move(location_offsets)),
+                            PyArrayFromVecPt3d(locations),
+                            PyArrayFromVecFlt(std::move(extracted_data)),
+                            PyArrayFromVecInt(std::move(cell_idxs)));
+    }, py::arg("polyline_offsets"), py::arg("polyline_points"));
 
     // -------------------------------------------------------------------------
     // function: SetUseIdwForPointData
     // -------------------------------------------------------------------------
-    extractor.def("SetUseIdwForPointData", &xms::XmUGrid2dPolylineDataExtractor::SetUseIdwForPointData, py::arg("use_idw"));
+    extractor.def("SetUseIdwForPointData", [](xms::XmUGrid2dPolylineDataExtractor &self, bool a_value) {
+      PyCallExclusive(&self, [&]() { self.SetUseIdwForPointData(a_value); });
+    }, py::arg("use_idw"));
 
     // -------------------------------------------------------------------------
     // function: GetUseIdwForPointData
     // -------------------------------------------------------------------------
-    extractor.def("GetUseIdwForPointData", &xms::XmUGrid2dPolylineDataExtractor::GetUseIdwForPointData);
+    extractor.def("GetUseIdwForPointData", [](xms::XmUGrid2dPolylineDataExtractor &self) {
+      return PyCallShared(&self, [&]() { return self.GetUseIdwForPointData(); });
+    });
 
     // -------------------------------------------------------------------------
     // function: SetNoDataValue
     // -------------------------------------------------------------------------
-    extractor.def("SetNoDataValue", &xms::XmUGrid2dPolylineDataExtractor::SetNoDataValue, py::arg("no_data_value"));
+    extractor.def("SetNoDataValue", [](xms::XmUGrid2dPolylineDataExtractor &self, float a_value) {
+      PyCallExclusive(&self, [&]() { self.SetNoDataValue(a_value); });
+    }, py::arg("no_data_value"));
 
     // -------------------------------------------------------------------------
     // function: GetNoDataValue
     // -------------------------------------------------------------------------
-    extractor.def("GetNoDataValue", &xms::XmUGrid2dPolylineDataExtractor::GetNoDataValue);
+    extractor.def("GetNoDataValue", [](xms::XmUGrid2dPolylineDataExtractor &self) {
+      return PyCallShared(&self, [&]() { return self.GetNoDataValue(); });
+    });
+
+    // -------------------------------------------------------------------------
+    // function: SetUseCellWalking
+    // -------------------------------------------------------------------------
+    extractor.def("SetUseCellWalking", [](xms::XmUGrid2dPolylineDataExtractor &self, bool a_value) {
+      PyCallExclusive(&self, [&]() { self.SetUseCellWalking(a_value); });
+    }, py::arg("use_cell_walking"));
+
+    // -------------------------------------------------------------------------
+    // function: GetUseCellWalking
+    // -------------------------------------------------------------------------
+    extractor.def("GetUseCellWalking", [](xms::XmUGrid2dPolylineDataExtractor &self) {
+      return PyCallShared(&self, [&]() { return self.GetUseCellWalking(); });
+    });
+
+    // -------------------------------------------------------------------------
+    // function: SetSampleSpacing
+    // -------------------------------------------------------------------------
+    extractor.def("SetSampleSpacing", [](xms::XmUGrid2dPolylineDataExtractor &self, double a_value) {
+      PyCallExclusive(&self, [&]() { self.SetSampleSpacing(a_value); });
+    }, py::arg("spacing"));
+
+    // -------------------------------------------------------------------------
+    // function: GetSampleSpacing
+    // -------------------------------------------------------------------------
+    extractor.def("GetSampleSpacing", [](xms::XmUGrid2dPolylineDataExtractor &self) {
+      return PyCallShared(&self, [&]() { return self.GetSampleSpacing(); });
+    });
+
+    // -------------------------------------------------------------------------
+    // function: SetSamplesPerSegment
+    // -------------------------------------------------------------------------
+    extractor.def("SetSamplesPerSegment", [](xms::XmUGrid2dPolylineDataExtractor &self, int a_value) {
+      PyCallExclusive(&self, [&]() { self.SetSamplesPerSegment(a_value); });
+    }, py::arg("count"));
+
+    // -------------------------------------------------------------------------
+    // function: GetSamplesPerSegment
+    // -------------------------------------------------------------------------
+    extractor.def("GetSamplesPerSegment", [](xms::XmUGrid2dPolylineDataExtractor &self) {
+      return PyCallShared(&self, [&]() { return self.GetSamplesPerSegment(); });
+    });
 }
@@ -10,7 +10,9 @@
 
 #include <xmsextractor/python/extractor/extractor_py.h>
 
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
 #include <xmscore/misc/StringUtil.h>
 #include <xmscore/python/misc/PyUtils.h>
@@ -65,4 +67,186 @@ std::string PyReprStringFromXmUGrid2dPolylineDataExtractor(
   ss << "no_data_value: " << xms::STRstd(a_extractor.GetNoDataValue()) << "\n";
   return ss.str();
 } // PyReprStringFromXmUGrid2dDataExtractor
+// ---------------------------------------------------------------------------
+/// \brief Get floats from a NumPy array or other iterable. NumPy arrays are
+///        read through the buffer protocol without iterating in Python.
+/// \param[in] a_obj: the NumPy array or iterable
+/// \return the floats
+// ---------------------------------------------------------------------------
+xms::VecFlt VecFltFromPyObject(const py::object& a_obj)
+{
+  if (!py::isinstance<py::array>(a_obj))
+    return std::move(*xms::VecFltFromPyIter(py::iterable(a_obj)));
+
+  auto array = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(a_obj);
+  if (!array)
+    throw py::type_error("Unable to convert NumPy array.");
+  const float* data = array.data();
+  return xms::VecFlt(data, data + array.size());
+} // VecFltFromPyObject
+// ---------------------------------------------------------------------------
+/// \brief Get a float NumPy array to read in place from a NumPy array or
+///        other iterable. NumPy float32 arrays are used without copying.
+/// \param[in] a_obj: the NumPy array or iterable
+/// \return the NumPy array
+// ---------------------------------------------------------------------------
+py::array_t<float, py::array::c_style | py::array::forcecast> PyFloatArrayFromPyObject(
+  const py::object& a_obj)
+{
+  using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+  if (!py::isinstance<py::array>(a_obj))
+  {
+    BSHP<xms::VecFlt> values = xms::VecFltFromPyIter(py::iterable(a_obj));
+    return FloatArray::ensure(PyArrayFromVecFlt(std::move(*values)));
+  }
+
+  auto array = FloatArray::ensure(a_obj);
+  if (!array)
+    throw py::type_error("Unable to convert NumPy array.");
+  return array;
+} // PyFloatArrayFromPyObject
+// ---------------------------------------------------------------------------
+/// \brief Get a bitset from a NumPy array or other iterable. NumPy arrays are
+///        read through the buffer protocol without iterating in Python.
+/// \param[in] a_obj: the NumPy array or iterable
+/// \return the bitset
+// ---------------------------------------------------------------------------
+xms::DynBitset DynBitsetFromPyObject(const py::object& a_obj)
+{
+  if (!py::isinstance<py::array>(a_obj))
+    return xms::DynamicBitsetFromPyIter(py::iterable(a_obj));
+
+  auto array = py::array_t<bool, py::array::c_style | py::array::forcecast>::ensure(a_obj);
+  if (!array)
+    throw py::type_error("Unable to convert NumPy array.");
+  const bool* data = array.data();
+  xms::DynBitset bitset(static_cast<size_t>(array.size()));
+  for (size_t i = 0; i < bitset.size(); ++i)
+    bitset[i] = data[i];
+  return bitset;
+} // DynBitsetFromPyObject
+// ---------------------------------------------------------------------------
+/// \brief Get points from an (n, 2) or (n, 3) NumPy array or other iterable.
+///        NumPy arrays are read through the buffer protocol without iterating
+///        in Python.
+/// \param[in] a_obj: the NumPy array or iterable
+/// \return the points
+// ---------------------------------------------------------------------------
+xms::VecPt3d VecPt3dFromPyObject(const py::object& a_obj)
+{
+  if (!py::isinstance<py::array>(a_obj))
+    return std::move(*xms::VecPt3dFromPyIter(py::iterable(a_obj)));
+
+  auto array = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(a_obj);
+  if (!array)
+    throw py::type_error("Unable to convert NumPy array.");
+  if (array.size() == 0)
+    return xms::VecPt3d();
+  if (array.ndim() != 2 || (array.shape(1) != 2 && array.shape(1) != 3))
+    throw py::value_error("Points must be an (n, 2) or (n, 3) array.");
 
+  size_t numPoints = static_cast<size_t>(array.shape(0));
+  size_t dimension = static_cast<size_t>(array.shape(1));
+  const double* data = array.data();
+  xms::VecPt3d points(numPoints);
+  for (size_t i = 0; i < numPoints; ++i, data += dimension)
+  {
+    points[i].x = data[0];
+    points[i].y = data[1];
+    points[i].z = dimension == 3 ? data[2] : 0.0;
+  }
+  return points;
+} // VecPt3dFromPyObject
+// ---------------------------------------------------------------------------
+/// \brief Create a NumPy array that takes ownership of a vector of floats
+///        without copying it.
+/// \param[in] a_values: the floats to move into the array
+/// \return the NumPy array
+// ---------------------------------------------------------------------------
+py::array PyArrayFromVecFlt(xms::VecFlt&& a_values)
+{
+  if (a_values.empty())
+    return py::array_t<float>(py::ssize_t(0));
+  xms::VecFlt* values = new xms::VecFlt(std::move(a_values));
+  py::capsule owner(values, [](void* a_ptr) { delete reinterpret_cast<xms::VecFlt*>(a_ptr); });
+  return py::array_t<float>(values->size(), values->data(), owner);
+} // PyArrayFromVecFlt
+// ---------------------------------------------------------------------------
+/// \brief Create a NumPy array that takes ownership of a vector of ints
+///        without copying it.
+/// \param[in] a_values: the ints to move into the array
+/// \return the NumPy array
+// ---------------------------------------------------------------------------
+py::array PyArrayFromVecInt(xms::VecInt&& a_values)
+{
+  if (a_values.empty())
+    return py::array_t<int>(py::ssize_t(0));
+  xms::VecInt* values = new xms::VecInt(std::move(a_values));
+  py::capsule owner(values, [](void* a_ptr) { delete reinterpret_cast<xms::VecInt*>(a_ptr); });
+  return py::array_t<int>(values->size(), values->data(), owner);
+} // PyArrayFromVecInt
+// ---------------------------------------------------------------------------
+/// \brief Create a NumPy array that takes ownership of a vector of doubles
+///        without copying it.
+/// \param[in] a_values: the doubles to move into the array
+/// \return the NumPy array
+// ---------------------------------------------------------------------------
+py::array PyArrayFromVecDbl(xms::VecDbl&& a_values)
+{
+  if (a_values.empty())
+    return py::array_t<double>(py::ssize_t(0));
+  xms::VecDbl* values = new xms::VecDbl(std::move(a_values));
+  py::capsule owner(values, [](void* a_ptr) { delete reinterpret_cast<xms::VecDbl*>(a_ptr); });
+  return py::array_t<double>(values->size(), values->data(), owner);
+} // PyArrayFromVecDbl
+// ---------------------------------------------------------------------------
+/// \brief Create an (n, 3) NumPy array from points.
+/// \param[in] a_points: the points
+/// \return the NumPy array
+// ---------------------------------------------------------------------------
+py::array PyArrayFromVecPt3d(const xms::VecPt3d& a_points)
+{
+  std::vector<py::ssize_t> shape = {static_cast<py::ssize_t>(a_points.size()), 3};
+  py::array_t<double> array(shape);
+  double* data = array.mutable_data();
+  for (const auto& point : a_points)
+  {
+    *data++ = point.x;
+    *data++ = point.y;
+    *data++ = point.z;
+  }
+  return array;
+} // PyArrayFromVecPt3d
+// ---------------------------------------------------------------------------
+/// \brief Get the mutex guarding a C++ object used from Python. Calls that
+///        modify the object hold it exclusively and calls that only read hold
+///        it shared. Each object has its own mutex, which exists while any
+///        call holds the returned pointer and is removed after the last one
+///        releases it. Calls holding it must not wait for the GIL, so they
+///        release the GIL first or keep it for the whole call.
+/// \param[in] a_instance: the C++ object
+/// \return the mutex for the object
+// ---------------------------------------------------------------------------
+std::shared_ptr<std::shared_mutex> PyInstanceMutex(const void* a_instance)
+{
+  static std::mutex registryMutex;
+  static std::unordered_map<const void*, std::weak_ptr<std::shared_mutex>> mutexes;
+  std::lock_guard<std::mutex> lock(registryMutex);
+  std::weak_ptr<std::shared_mutex>& entry = mutexes[a_instance];
+  std::shared_ptr<std::shared_mutex> mutex = entry.lock();
+  if (!mutex)
+  {
+    mutex.reset(new std::shared_mutex(), [a_instance](std::shared_mutex* a_mutex) {
+      {
+        // a later call may already have replaced the expired entry
+        std::lock_guard<std::mutex> eraseLock(registryMutex);
+        auto it = mutexes.find(a_instance);
+        if (it != mutexes.end() && it->second.expired())
+          mutexes.erase(it);
+      }
+      delete a_mutex;
+    });
+    entry = mutex;
+  }
+  return mutex;
+} // PyInstanceMutex
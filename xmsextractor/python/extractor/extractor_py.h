@@ -8,6 +8,13 @@
 
 //----- Included files ---------------------------------------------------------
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+#include <memory>
+#include <shared_mutex>
+
+#include <xmscore/misc/DynBitset.h>
+#include <xmscore/stl/vector.h>
 
 //----- Namespace declaration --------------------------------------------------
 namespace py = pybind11;
@@ -26,3 +33,64 @@ void initXmUGrid2dPolylineDataExtractor(py::module &);
 std::string PyReprStringFromXmUGrid2dDataExtractor(const xms::XmUGrid2dDataExtractor& a_);
 std::string PyReprStringFromXmUGrid2dPolylineDataExtractor(
   const xms::XmUGrid2dPolylineDataExtractor& a_extractor);
+
+xms::VecFlt VecFltFromPyObject(const py::object& a_obj);
+py::array_t<float, py::array::c_style | py::array::forcecast> PyFloatArrayFromPyObject(
+  const py::object& a_obj);
+xms::DynBitset DynBitsetFromPyObject(const py::object& a_obj);
+xms::VecPt3d VecPt3dFromPyObject(const py::object& a_obj);
+py::array PyArrayFromVecFlt(xms::VecFlt&& a_values);
+py::array PyArrayFromVecInt(xms::VecInt&& a_values);
+py::array PyArrayFromVecDbl(xms::VecDbl&& a_values);
+py::array PyArrayFromVecPt3d(const xms::VecPt3d& a_points);
+
+std::shared_ptr<std::shared_mutex> PyInstanceMutex(const void* a_instance);
+
+// ---------------------------------------------------------------------------
+/// \brief Call a function that modifies a C++ object with the GIL released
+///        and the object's mutex held exclusively. The function must not use
+///        Python objects.
+/// \param[in] a_instance: the C++ object
+/// \param[in] a_func: the function to call
+/// \return the result of the function
+// ---------------------------------------------------------------------------
+template <typename Func>
+auto PyCallExclusive(const void* a_instance, Func a_func) -> decltype(a_func())
+{
+  py::gil_scoped_release release;
+  std::shared_ptr<std::shared_mutex> mutex = PyInstanceMutex(a_instance);
+  std::unique_lock<std::shared_mutex> lock(*mutex);
+  return a_func();
+} // PyCallExclusive
+// ---------------------------------------------------------------------------
+/// \brief Call a function that only reads a C++ object with the GIL released
+///        and the object's mutex held shared. The function must not use
+///        Python objects.
+/// \param[in] a_instance: the C++ object
+/// \param[in] a_func: the function to call
+/// \return the result of the function
+// ---------------------------------------------------------------------------
+template <typename Func>
+auto PyCallShared(const void* a_instance, Func a_func) -> decltype(a_func())
+{
+  py::gil_scoped_release release;
+  std::shared_ptr<std::shared_mutex> mutex = PyInstanceMutex(a_instance);
+  std::shared_lock<std::shared_mutex> lock(*mutex);
+  return a_func();
+} // PyCallShared
+// ---------------------------------------------------------------------------
+/// \brief Call a function that only reads a C++ object and creates Python
+///        objects from it, keeping the GIL while the object's mutex is held
+///        shared. This can't deadlock since calls holding the mutex never
+///        wait for the GIL.
+/// \param[in] a_instance: the C++ object
+/// \param[in] a_func: the function to call
+/// \return the result of the function
+// ---------------------------------------------------------------------------
+template <typename Func>
+auto PyCallSharedWithGil(const void* a_instance, Func a_func) -> decltype(a_func())
+{
+  std::shared_ptr<std::shared_mutex> mutex = PyInstanceMutex(a_instance);
+  std::shared_lock<std::shared_mutex> lock(*mutex);
+  return a_func();
+} // PyCallSharedWithGil
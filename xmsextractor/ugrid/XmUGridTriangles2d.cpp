@@ -13,6 +13,13 @@
 #include <xmsextractor/ugrid/XmUGridTriangles2d.h>
 
 // 3. Standard library headers
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
 
 // 4. External library headers
 
@@ -21,6 +28,9 @@
 #include <xmsgrid/ugrid/XmUGrid.h>
 
 // 6. Non-shared code headers
+#include <xmsextractor/extractor/XmCellToPointOperator.h>
+#include <xmsextractor/misc/XmMappedFile.h>
+#include <xmsextractor/misc/XmParallel.h>
 #include <xmsextractor/ugrid/XmUGridTriangulator.h>
 
 //----- Forward declarations ---------------------------------------------------
@@ -42,6 +52,116 @@ namespace xms
 
 namespace
 {
+const size_t MIN_CELLS_PER_CHUNK = 1024; ///< smallest chunk for parallel builds
+const size_t CHUNKS_PER_THREAD = 4;      ///< chunks per thread to balance work
+const double WEIGHT_TOLERANCE = 1.0e-9;  ///< barycentric weight tolerance
+
+const char FILE_MAGIC[8] = {'X', 'M', 'S', 'T', 'R', 'I', '2', 'D'}; ///< triangle file id
+const uint32_t FILE_VERSION = 1;             ///< triangle file format version
+const uint32_t FILE_BYTE_ORDER = 0x01020304; ///< detects files from other byte orders
+
+/// Header at the start of a triangle file. It is followed by the points added
+/// to the UGrid points (x, y, z doubles), the triangle point indices, the cell
+/// of each triangle and the centroid point of each cell (-1 if none). Values
+/// are stored in native byte order.
+struct XmTrianglesFileHeader
+{
+  char magic[8];          ///< FILE_MAGIC
+  uint32_t version;       ///< FILE_VERSION
+  uint32_t byteOrder;     ///< FILE_BYTE_ORDER
+  uint64_t ugridHash;     ///< hash of the UGrid points and cells
+  int32_t pointOption;    ///< point option the triangles were built with
+  int32_t numUGridPoints; ///< number of UGrid points
+  int32_t numCells;       ///< number of UGrid cells
+  int32_t numPoints;      ///< number of triangle points
+  int32_t numTriangles;   ///< number of triangles
+  int32_t reserved;       ///< unused, keeps the points 8 byte aligned
+};
+static_assert(sizeof(XmTrianglesFileHeader) == 48, "unexpected triangle file header size");
+
+//------------------------------------------------------------------------------
+/// \brief Add a value to a 64 bit FNV-1a style hash. Whole values are mixed in
+///        rather than single bytes so large UGrids hash quickly.
+/// \param[in] a_hash The hash so far.
+/// \param[in] a_value The value to add.
+/// \return The updated hash.
+//------------------------------------------------------------------------------
+template <typename T>
+uint64_t iHashValue(uint64_t a_hash, T a_value)
+{
+  uint64_t word = 0;
+  memcpy(&word, &a_value, sizeof(T));
+  return (a_hash ^ word) * 0x100000001b3ULL;
+} // iHashValue
+//------------------------------------------------------------------------------
+/// \brief Hash the points and cells of a UGrid to tell if triangles written
+///        to a file were built for it.
+/// \param[in] a_ugrid The UGrid.
+/// \return The hash.
+//------------------------------------------------------------------------------
+uint64_t iHashUGrid(const XmUGrid& a_ugrid)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  const VecPt3d& locations = a_ugrid.GetLocations();
+  hash = iHashValue(hash, (uint64_t)locations.size());
+  for (const auto& location : locations)
+  {
+    hash = iHashValue(hash, location.x);
+    hash = iHashValue(hash, location.y);
+    hash = iHashValue(hash, location.z);
+  }
+  const VecInt& cellstream = a_ugrid.GetCellstream();
+  hash = iHashValue(hash, (uint64_t)cellstream.size());
+  for (auto value : cellstream)
+    hash = iHashValue(hash, value);
+  return hash;
+} // iHashUGrid
+//------------------------------------------------------------------------------
+/// \brief Write the contents of a vector to a binary stream.
+/// \param[in] a_file The stream.
+/// \param[in] a_values The values to write.
+//------------------------------------------------------------------------------
+template <typename T>
+void iWriteVector(std::ofstream& a_file, const std::vector<T>& a_values)
+{
+  if (!a_values.empty())
+    a_file.write(reinterpret_cast<const char*>(&a_values[0]), a_values.size() * sizeof(T));
+} // iWriteVector
+//------------------------------------------------------------------------------
+/// \brief Read the contents of a vector from a binary stream.
+/// \param[in] a_file The stream.
+/// \param[in] a_size The number of values to read.
+/// \param[out] a_values The values read.
+/// \return True if all of the values were read.
+//------------------------------------------------------------------------------
+template <typename T>
+bool iReadVector(std::ifstream& a_file, size_t a_size, std::vector<T>& a_values)
+{
+  a_values.resize(a_size);
+  if (a_size > 0)
+    a_file.read(reinterpret_cast<char*>(&a_values[0]), a_size * sizeof(T));
+  return !a_file.fail();
+} // iReadVector
+
+class XmUGridTrianglesChunk : public XmUGridTriangulatorBase
+{
+public:
+  XmUGridTrianglesChunk(const VecPt3d& a_points);
+
+  virtual int AddCentroidPoint(const int a_cellIdx, const Pt3d& a_pt) override;
+  virtual void AddTriangle(const int a_cellIdx,
+                           const int a_pt1,
+                           const int a_pt2,
+                           const int a_pt3) override;
+  virtual const VecPt3d& GetPoints() const override;
+
+  const VecPt3d& m_points;    ///< UGrid points
+  VecPt3d m_centroids;        ///< Centroid points added for the chunk cells
+  VecInt m_centroidCellIdxs;  ///< The cell index for each centroid
+  VecInt m_triangles;         ///< Triangles for the chunk cells
+  VecInt m_triangleToCellIdx; ///< The cell index for each triangle
+};
+
 class XmUGridTriangles2dImpl : public XmUGridTriangles2d
 {
 public:
@@ -50,24 +170,125 @@ public:
   virtual void BuildTriangles(const XmUGrid& a_ugrid, PointOptionEnum a_pointOption) override;
   virtual void BuildEarcutTriangles(const XmUGrid& a_ugrid) override;
   virtual void SetCellActivity(const DynBitset& a_cellActivity) override;
+  virtual void SetThreadCount(int a_numThreads) override;
+
+  virtual bool WriteToFile(const std::string& a_fileName, const XmUGrid& a_ugrid) const override;
+  virtual bool ReadFromFile(const std::string& a_fileName,
+                            const XmUGrid& a_ugrid,
+                            PointOptionEnum a_pointOption) override;
 
   virtual const VecPt3d& GetPoints() const override;
   virtual const VecInt& GetTriangles() const override;
-  virtual BSHP<VecPt3d> GetPointsPtr() override;
+  virtual BSHP<const VecPt3d> GetPointsPtr() const override;
   virtual BSHP<VecInt> GetTrianglesPtr() override;
 
   virtual int GetCellCentroid(int a_cellIdx) const override;
-
-  virtual int GetIntersectedCell(const Pt3d& a_point, VecInt& a_idxs, VecDbl& a_weights) override;
+  virtual BSHP<const XmCellToPointOperator> GetCellToPointOperator(const XmUGrid& a_ugrid,
+                                                                   bool a_useIdw) const override;
+
+  virtual int GetIntersectedCell(const Pt3d& a_point,
+                                 VecInt& a_idxs,
+                                 VecDbl& a_weights) const override;
+  virtual int GetIntersectedCell(const Pt3d& a_point,
+                                 const DynBitset& a_cellActivity,
+                                 VecInt& a_idxs,
+                                 VecDbl& a_weights) const override;
+  virtual int GetIntersectedCell(const Pt3d& a_point,
+                                 int a_triangleIdx,
+                                 const DynBitset& a_cellActivity,
+                                 VecInt& a_idxs,
+                                 VecDbl& a_weights) const override;
+  virtual int GetCellTriangle(int a_cellIdx, const Pt3d& a_point) const override;
 
 private:
   void Initialize(const XmUGrid& a_ugrid);
-  BSHP<GmTriSearch> GetTriSearch();
+  void BuildTrianglesParallel(const XmUGrid& a_ugrid, bool a_addCentroids);
+  void BuildPointTriangles() const;
+  void BuildCellTriangles() const;
+  BSHP<GmTriSearch> GetTriSearch() const;
+  int FindTriangle(const Pt3d& a_point, VecInt& a_idxs, VecDbl& a_weights) const;
+  bool IsTriangleActive(int a_triangleIdx, const DynBitset& a_cellActivity) const;
+  bool TriangleWeights(const Pt3d& a_point,
+                       int a_triangleIdx,
+                       VecInt& a_idxs,
+                       VecDbl& a_weights) const;
 
   BSHP<XmUGridTriangulator> m_triangulator; ///< Triangulator
   mutable BSHP<GmTriSearch> m_triSearch;    ///< Triangle searcher for triangles
+  mutable std::mutex m_triSearchMutex;      ///< Guards building the triangle searcher
+  mutable std::atomic<bool> m_triSearchBuilt; ///< Is the triangle searcher built
+  int m_numThreads;                         ///< Number of threads used to build
+  int m_pointOption;                        ///< Point option built with or -1
+  mutable std::mutex m_pointTrianglesMutex;      ///< Guards building point triangles
+  mutable std::atomic<bool> m_pointTrianglesBuilt; ///< Are point triangles built
+  mutable VecInt m_pointTriangleOffsets;         ///< Start of each point's triangles
+  mutable VecInt m_pointTriangles;               ///< Triangles attached to each point
+  mutable std::mutex m_cellTrianglesMutex;       ///< Guards building cell triangles
+  mutable std::atomic<bool> m_cellTrianglesBuilt; ///< Are cell triangles built
+  mutable VecInt m_cellTriangleOffsets;          ///< Start of each cell's triangles
+  mutable VecInt m_cellTriangles;                ///< Triangles of each cell
+  DynBitset m_triangleActivity;  ///< Triangle activity set from cell activity
+  mutable std::mutex m_cellToPointMutex; ///< Guards building cell to point operators
+  mutable BSHP<const XmCellToPointOperator> m_cellToPoint[2]; ///< Average and IDW operators
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmUGridTrianglesChunk
+/// \brief Triangles built for a contiguous range of cells by one thread.
+///        Centroid points are numbered after the UGrid points as if the chunk
+///        were the first one, and are offset when the chunks are combined.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Constructor
+/// \param[in] a_points The UGrid points.
+//------------------------------------------------------------------------------
+XmUGridTrianglesChunk::XmUGridTrianglesChunk(const VecPt3d& a_points)
+: m_points(a_points)
+, m_centroids()
+, m_centroidCellIdxs()
+, m_triangles()
+, m_triangleToCellIdx()
+{
+} // XmUGridTrianglesChunk::XmUGridTrianglesChunk
+//------------------------------------------------------------------------------
+/// \brief Add a cell point (for the cell centroid).
+/// \param a_cellIdx The cell index for the centroid point
+/// \param a_pt The centroid point
+/// \return The chunk index of the added point
+//------------------------------------------------------------------------------
+int XmUGridTrianglesChunk::AddCentroidPoint(const int a_cellIdx, const Pt3d& a_pt)
+{
+  int centroidIdx = (int)(m_points.size() + m_centroids.size());
+  m_centroids.push_back(a_pt);
+  m_centroidCellIdxs.push_back(a_cellIdx);
+  return centroidIdx;
+} // XmUGridTrianglesChunk::AddCentroidPoint
+//------------------------------------------------------------------------------
+/// \brief Add a triangle cell.
+/// \param[in] a_cellIdx The cell index the triangle is from
+/// \param[in] a_pt1 The first triangle point index (counter clockwise)
+/// \param[in] a_pt2 The second triangle point index (counter clockwise)
+/// \param[in] a_pt3 The third triangle point index (counter clockwise)
+//------------------------------------------------------------------------------
+void XmUGridTrianglesChunk::AddTriangle(const int a_cellIdx,
+                                        const int a_pt1,
+                                        const int a_pt2,
+                                        const int a_pt3)
+{
+  m_triangles.push_back(a_pt1);
+  m_triangles.push_back(a_pt2);
+  m_triangles.push_back(a_pt3);
+  m_triangleToCellIdx.push_back(a_cellIdx);
+} // XmUGridTrianglesChunk::AddTriangle
+//------------------------------------------------------------------------------
+/// \brief Get the UGrid points.
+/// \return The UGrid points
+//------------------------------------------------------------------------------
+const VecPt3d& XmUGridTrianglesChunk::GetPoints() const
+{
+  return m_points;
+} // XmUGridTrianglesChunk::GetPoints
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \class XmUGridTriangles2dImpl
 /// \brief Class to store XmUGrid triangles. Tracks where midpoints and
@@ -79,6 +300,21 @@ private:
 XmUGridTriangles2dImpl::XmUGridTriangles2dImpl()
 : m_triangulator()
 , m_triSearch()
+, m_triSearchMutex()
+, m_triSearchBuilt(false)
+, m_numThreads(1)
+, m_pointOption(-1)
+, m_pointTrianglesMutex()
+, m_pointTrianglesBuilt(false)
+, m_pointTriangleOffsets()
+, m_pointTriangles()
+, m_cellTrianglesMutex()
+, m_cellTrianglesBuilt(false)
+, m_cellTriangleOffsets()
+, m_cellTriangles()
+, m_triangleActivity()
+, m_cellToPointMutex()
+, m_cellToPoint()
 {
 } // XmUGridTriangles2dImpl::XmUGridTriangles2dImpl
 //------------------------------------------------------------------------------
@@ -89,10 +325,19 @@ XmUGridTriangles2dImpl::XmUGridTriangles2dImpl()
 void XmUGridTriangles2dImpl::BuildTriangles(const XmUGrid& a_ugrid, PointOptionEnum a_pointOption)
 {
   Initialize(a_ugrid);
+  m_pointOption = a_pointOption;
+
+  bool createMidpoints = a_pointOption == PO_CENTROIDS_AND_MIDPOINTS;
+  // midpoints are shared between neighboring cells so are added serially
+  if (!createMidpoints && xmResolveThreadCount(m_numThreads) > 1)
+  {
+    BuildTrianglesParallel(a_ugrid, a_pointOption != PO_NO_POINTS);
+    return;
+  }
 
   int numCells = a_ugrid.GetCellCount();
   VecInt cellPoints;
-  bool createMidpoints = a_pointOption == PO_CENTROIDS_AND_MIDPOINTS;
+  VecInt ringPoints;
   if (createMidpoints)
     m_triangulator->InitMidpoints();
   for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
@@ -102,18 +347,17 @@ void XmUGridTriangles2dImpl::BuildTriangles(const XmUGrid& a_ugrid, PointOptionE
     a_ugrid.GetCellPoints(cellIdx, cellPoints);
     if (createMidpoints)
     {
-      int nPts = (int)cellPoints.size();
-      int i = 0;
-      for (auto it = cellPoints.begin(); it != cellPoints.end(); ++it)
+      // interleave each corner with the midpoint of the edge that follows it
+      int numPoints = (int)cellPoints.size();
+      ringPoints.resize(2 * numPoints);
+      for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
       {
-        int ip1 = (i + 1) % nPts;
-        int id0 = cellPoints[i];
-        int id1 = cellPoints[ip1];
-        int idMid = m_triangulator->AddMidPoint(cellIdx, id0, id1);
-        it = cellPoints.insert(it + 1, idMid);
-        i += 2;
-        nPts = (int)cellPoints.size();
+        int id0 = cellPoints[pointIdx];
+        int id1 = cellPoints[(pointIdx + 1) % numPoints];
+        ringPoints[2 * pointIdx] = id0;
+        ringPoints[2 * pointIdx + 1] = m_triangulator->AddMidPoint(cellIdx, id0, id1);
       }
+      cellPoints.swap(ringPoints);
     }
     bool builtTriangles = false;
     if (a_pointOption != PO_NO_POINTS)
@@ -129,6 +373,14 @@ void XmUGridTriangles2dImpl::BuildTriangles(const XmUGrid& a_ugrid, PointOptionE
 void XmUGridTriangles2dImpl::BuildEarcutTriangles(const XmUGrid& a_ugrid)
 {
   Initialize(a_ugrid);
+  // the same triangles as building without added points
+  m_pointOption = PO_NO_POINTS;
+
+  if (xmResolveThreadCount(m_numThreads) > 1)
+  {
+    BuildTrianglesParallel(a_ugrid, false);
+    return;
+  }
 
   int numCells = a_ugrid.GetCellCount();
   VecInt cellPoints;
@@ -145,24 +397,197 @@ void XmUGridTriangles2dImpl::BuildEarcutTriangles(const XmUGrid& a_ugrid)
 //------------------------------------------------------------------------------
 void XmUGridTriangles2dImpl::SetCellActivity(const DynBitset& a_cellActivity)
 {
+  m_triangleActivity.clear();
   if (a_cellActivity.empty())
   {
-    DynBitset emptyActivity;
-    GetTriSearch()->SetTriActivity(emptyActivity);
+    GetTriSearch()->SetTriActivity(m_triangleActivity);
     return;
   }
 
-  DynBitset triangleActivity;
   int numTriangles = (int)m_triangulator->GetNumTriangles();
-  triangleActivity.resize(numTriangles);
+  m_triangleActivity.resize(numTriangles);
   for (int triangleIdx = 0; triangleIdx < numTriangles; ++triangleIdx)
   {
     int cellIdx = m_triangulator->GetCellFromTriangle(triangleIdx);
-    triangleActivity[triangleIdx] = cellIdx >= a_cellActivity.size() || a_cellActivity[cellIdx];
+    m_triangleActivity[triangleIdx] = cellIdx >= a_cellActivity.size() || a_cellActivity[cellIdx];
   }
-  GetTriSearch()->SetTriActivity(triangleActivity);
+  GetTriSearch()->SetTriActivity(m_triangleActivity);
 } // XmUGridTriangles2dImpl::SetCellActivity
 //------------------------------------------------------------------------------
+/// \brief Set the number of threads used to build triangles.
+/// \param[in] a_numThreads The number of threads. One builds serially. Zero or
+///            less uses the number of hardware threads.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dImpl::SetThreadCount(int a_numThreads)
+{
+  m_numThreads = a_numThreads;
+} // XmUGridTriangles2dImpl::SetThreadCount
+//------------------------------------------------------------------------------
+/// \brief Write the triangles to a binary file. Only the points added to the
+///        UGrid points are written, the rest come from the UGrid when read.
+///        The file is replaced in one step so it is never partly written.
+/// \param[in] a_fileName The file to write.
+/// \param[in] a_ugrid The UGrid the triangles were built for.
+/// \return True if the file was written.
+//------------------------------------------------------------------------------
+bool XmUGridTriangles2dImpl::WriteToFile(const std::string& a_fileName,
+                                         const XmUGrid& a_ugrid) const
+{
+  if (!m_triangulator || m_pointOption < 0)
+    return false;
+
+  const VecPt3d& points = m_triangulator->GetPoints();
+  const VecInt& triangles = m_triangulator->GetTriangles();
+  int numUGridPoints = a_ugrid.GetPointCount();
+  int numCells = a_ugrid.GetCellCount();
+  int numTriangles = m_triangulator->GetNumTriangles();
+  if ((int)points.size() < numUGridPoints)
+    return false;
+
+  XmTrianglesFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+  header.version = FILE_VERSION;
+  header.byteOrder = FILE_BYTE_ORDER;
+  header.ugridHash = iHashUGrid(a_ugrid);
+  header.pointOption = m_pointOption;
+  header.numUGridPoints = numUGridPoints;
+  header.numCells = numCells;
+  header.numPoints = (int32_t)points.size();
+  header.numTriangles = numTriangles;
+
+  VecDbl coords;
+  coords.reserve(3 * (points.size() - numUGridPoints));
+  for (size_t pointIdx = numUGridPoints; pointIdx < points.size(); ++pointIdx)
+  {
+    const Pt3d& point = points[pointIdx];
+    coords.insert(coords.end(), {point.x, point.y, point.z});
+  }
+  std::vector<int32_t> triangleCells(numTriangles);
+  for (int triangleIdx = 0; triangleIdx < numTriangles; ++triangleIdx)
+    triangleCells[triangleIdx] = m_triangulator->GetCellFromTriangle(triangleIdx);
+  std::vector<int32_t> centroids(numCells);
+  for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
+    centroids[cellIdx] = m_triangulator->GetCellCentroid(cellIdx);
+  std::vector<int32_t> trianglePoints(triangles.begin(), triangles.end());
+
+  // write a temporary file and rename it over the file so processes that
+  // have the old file mapped are unaffected
+  std::string tempFileName = xmTempFileName(a_fileName);
+  std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+  if (!file)
+    return false;
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  iWriteVector(file, coords);
+  iWriteVector(file, trianglePoints);
+  iWriteVector(file, triangleCells);
+  iWriteVector(file, centroids);
+  file.close();
+  if (file.fail())
+  {
+    std::remove(tempFileName.c_str());
+    return false;
+  }
+  return xmReplaceFile(tempFileName, a_fileName);
+} // XmUGridTriangles2dImpl::WriteToFile
+//------------------------------------------------------------------------------
+/// \brief Read triangles written by WriteToFile. The whole file is checked
+///        before any triangles are changed. Only the triangulation is skipped,
+///        the triangle search is not saved and is built by the first search.
+/// \param[in] a_fileName The file to read.
+/// \param[in] a_ugrid The UGrid the triangles are for.
+/// \param[in] a_pointOption The point option the triangles must have been
+///            built with.
+/// \return True if the triangles were read.
+//------------------------------------------------------------------------------
+bool XmUGridTriangles2dImpl::ReadFromFile(const std::string& a_fileName,
+                                          const XmUGrid& a_ugrid,
+                                          PointOptionEnum a_pointOption)
+{
+  std::ifstream file(a_fileName, std::ios::binary | std::ios::ate);
+  if (!file)
+    return false;
+  size_t actualSize = (size_t)file.tellg();
+  file.seekg(0);
+
+  XmTrianglesFileHeader header;
+  if (actualSize < sizeof(header) ||
+      !file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+  {
+    return false;
+  }
+  int numUGridPoints = a_ugrid.GetPointCount();
+  int numCells = a_ugrid.GetCellCount();
+  if (memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+      header.version != FILE_VERSION || header.byteOrder != FILE_BYTE_ORDER ||
+      header.pointOption != a_pointOption || header.numUGridPoints != numUGridPoints ||
+      header.numCells != numCells || header.numPoints < numUGridPoints ||
+      header.numTriangles < 0)
+  {
+    return false;
+  }
+
+  size_t numAdded = (size_t)(header.numPoints - numUGridPoints);
+  size_t numTriangles = (size_t)header.numTriangles;
+  size_t fileSize = sizeof(header) + 3 * numAdded * sizeof(double) +
+                    4 * numTriangles * sizeof(int32_t) + (size_t)numCells * sizeof(int32_t);
+  if (actualSize != fileSize)
+    return false;
+
+  VecDbl coords;
+  std::vector<int32_t> trianglePoints, triangleCells, centroids;
+  if (!iReadVector(file, 3 * numAdded, coords) ||
+      !iReadVector(file, 3 * numTriangles, trianglePoints) ||
+      !iReadVector(file, numTriangles, triangleCells) ||
+      !iReadVector(file, (size_t)numCells, centroids))
+  {
+    return false;
+  }
+  for (auto pointIdx : trianglePoints)
+  {
+    if (pointIdx < 0 || pointIdx >= header.numPoints)
+      return false;
+  }
+  for (auto cellIdx : triangleCells)
+  {
+    if (cellIdx < 0 || cellIdx >= numCells)
+      return false;
+  }
+  for (auto centroidIdx : centroids)
+  {
+    if (centroidIdx != -1 && (centroidIdx < numUGridPoints || centroidIdx >= header.numPoints))
+      return false;
+  }
+  // the hash is checked last since it reads the whole UGrid
+  if (header.ugridHash != iHashUGrid(a_ugrid))
+    return false;
+
+  Initialize(a_ugrid);
+  m_triangulator->Allocate((int)numAdded, (int)numTriangles);
+  if (numAdded > 0)
+  {
+    VecPt3d& points = *m_triangulator->GetPointsPtr();
+    for (size_t i = 0; i < numAdded; ++i)
+      points[numUGridPoints + i] = Pt3d(coords[3 * i], coords[3 * i + 1], coords[3 * i + 2]);
+  }
+  const VecPt3d& points = m_triangulator->GetPoints();
+  for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
+  {
+    int centroidIdx = centroids[cellIdx];
+    if (centroidIdx >= 0)
+      m_triangulator->SetCentroidPoint(cellIdx, centroidIdx, points[centroidIdx]);
+  }
+  for (size_t triangleIdx = 0; triangleIdx < numTriangles; ++triangleIdx)
+  {
+    m_triangulator->SetTriangle((int)triangleIdx, triangleCells[triangleIdx],
+                                trianglePoints[3 * triangleIdx],
+                                trianglePoints[3 * triangleIdx + 1],
+                                trianglePoints[3 * triangleIdx + 2]);
+  }
+  m_pointOption = a_pointOption;
+  return true;
+} // XmUGridTriangles2dImpl::ReadFromFile
+//------------------------------------------------------------------------------
 /// \brief Get the generated triangle points.
 /// \return The triangle points
 //------------------------------------------------------------------------------
@@ -179,12 +604,17 @@ const VecInt& XmUGridTriangles2dImpl::GetTriangles() const
   return m_triangulator->GetTriangles();
 } // XmUGridTriangles2dImpl::GetTriangles
 //------------------------------------------------------------------------------
-/// \brief Get the generated triangle points as a shared pointer.
+/// \brief Get the generated triangle points as a shared pointer. The UGrid
+///        locations aren't copied when no points were added; the pointer
+///        refers to them without owning them.
 /// \return The triangle points
 //------------------------------------------------------------------------------
-BSHP<VecPt3d> XmUGridTriangles2dImpl::GetPointsPtr()
+BSHP<const VecPt3d> XmUGridTriangles2dImpl::GetPointsPtr() const
 {
-  return m_triangulator->GetPointsPtr();
+  BSHP<const VecPt3d> points = m_triangulator->GetPointsPtr();
+  if (!points)
+    points.reset(&m_triangulator->GetPoints(), [](const VecPt3d*) {});
+  return points;
 } // XmUGridTriangles2dImpl::GetPointsPtr
 //------------------------------------------------------------------------------
 /// \brief Get the generated triangles as a shared pointer.
@@ -204,7 +634,31 @@ int XmUGridTriangles2dImpl::GetCellCentroid(int a_cellIdx) const
   return m_triangulator->GetCellCentroid(a_cellIdx);
 } // XmUGridTriangles2dImpl::GetCellCentroid
 //------------------------------------------------------------------------------
+/// \brief Get the operator that calculates UGrid point scalars from cell
+///        scalars. Each averaging mode is built once and shared by every
+///        extractor using the triangles.
+/// \param[in] a_ugrid The UGrid the triangles were built for.
+/// \param[in] a_useIdw Whether to use IDW rather than average.
+/// \return The operator.
+//------------------------------------------------------------------------------
+BSHP<const XmCellToPointOperator> XmUGridTriangles2dImpl::GetCellToPointOperator(
+  const XmUGrid& a_ugrid,
+  bool a_useIdw) const
+{
+  std::lock_guard<std::mutex> lock(m_cellToPointMutex);
+  BSHP<const XmCellToPointOperator>& cellToPoint = m_cellToPoint[a_useIdw ? 1 : 0];
+  if (!cellToPoint)
+  {
+    BSHP<XmCellToPointOperator> op(new XmCellToPointOperator);
+    op->Build(a_ugrid, *this, a_useIdw);
+    cellToPoint = op;
+  }
+  return cellToPoint;
+} // XmUGridTriangles2dImpl::GetCellToPointOperator
+//------------------------------------------------------------------------------
 /// \brief Get the cell index and interpolation values intersected by a point.
+///        The triangle search is built with the triangles so this doesn't
+///        modify the triangles and can be called from several threads at once.
 /// \param[in] a_point The point to intersect with the UGrid.
 /// \param[out] a_idxs The interpolation points.
 /// \param[out] a_weights The interpolation weights.
@@ -212,20 +666,103 @@ int XmUGridTriangles2dImpl::GetCellCentroid(int a_cellIdx) const
 //------------------------------------------------------------------------------
 int XmUGridTriangles2dImpl::GetIntersectedCell(const Pt3d& a_point,
                                                VecInt& a_idxs,
-                                               VecDbl& a_weights)
+                                               VecDbl& a_weights) const
 {
-  if (!m_triSearch)
-    GetTriSearch();
-  int cellIdx = -1;
-  int triangleLocation;
-  if (m_triSearch->InterpWeightsTriangleIdx(a_point, triangleLocation, a_idxs, a_weights))
+  int triangleIdx = FindTriangle(a_point, a_idxs, a_weights);
+  return triangleIdx < 0 ? -1 : m_triangulator->GetCellFromTriangle(triangleIdx);
+} // XmUGridTriangles2dImpl::GetIntersectedCell
+//------------------------------------------------------------------------------
+/// \brief Get the cell index and interpolation values intersected by a point
+///        ignoring triangles in inactive cells. The search finds a triangle
+///        without the activity. When its cell is inactive the point can still
+///        be on the edge of an active triangle, which must share a point with
+///        the triangle found.
+/// \param[in] a_point The point to intersect with the UGrid.
+/// \param[in] a_cellActivity The cell activity. Empty for all active.
+/// \param[out] a_idxs The interpolation points.
+/// \param[out] a_weights The interpolation weights.
+/// \return The active cell intersected by the point or -1 if outside of the
+///         active cells.
+//------------------------------------------------------------------------------
+int XmUGridTriangles2dImpl::GetIntersectedCell(const Pt3d& a_point,
+                                               const DynBitset& a_cellActivity,
+                                               VecInt& a_idxs,
+                                               VecDbl& a_weights) const
+{
+  int triangleIdx = FindTriangle(a_point, a_idxs, a_weights);
+  if (triangleIdx < 0)
+    return -1;
+  if (IsTriangleActive(triangleIdx, a_cellActivity))
+    return m_triangulator->GetCellFromTriangle(triangleIdx);
+
+  BuildPointTriangles();
+  const VecInt& triangles = m_triangulator->GetTriangles();
+  for (int i = 0; i < 3; ++i)
+  {
+    int pointIdx = triangles[triangleIdx * 3 + i];
+    for (int j = m_pointTriangleOffsets[pointIdx]; j < m_pointTriangleOffsets[pointIdx + 1]; ++j)
+    {
+      int adjacentIdx = m_pointTriangles[j];
+      if (IsTriangleActive(adjacentIdx, a_cellActivity) &&
+          TriangleWeights(a_point, adjacentIdx, a_idxs, a_weights))
+      {
+        return m_triangulator->GetCellFromTriangle(adjacentIdx);
+      }
+    }
+  }
+  a_idxs.clear();
+  a_weights.clear();
+  return -1;
+} // XmUGridTriangles2dImpl::GetIntersectedCell
+//------------------------------------------------------------------------------
+/// \brief Get the cell index and interpolation values intersected by a point
+///        checking a triangle expected to contain it before searching.
+/// \param[in] a_point The point to intersect with the UGrid.
+/// \param[in] a_triangleIdx The triangle to check first or -1 to search.
+/// \param[in] a_cellActivity The cell activity. Empty for all active.
+/// \param[out] a_idxs The interpolation points.
+/// \param[out] a_weights The interpolation weights.
+/// \return The active cell intersected by the point or -1 if outside of the
+///         active cells.
+//------------------------------------------------------------------------------
+int XmUGridTriangles2dImpl::GetIntersectedCell(const Pt3d& a_point,
+                                               int a_triangleIdx,
+                                               const DynBitset& a_cellActivity,
+                                               VecInt& a_idxs,
+                                               VecDbl& a_weights) const
+{
+  int numTriangles = static_cast<int>(m_triangulator->GetTriangles().size() / 3);
+  if (a_triangleIdx >= 0 && a_triangleIdx < numTriangles &&
+      IsTriangleActive(a_triangleIdx, a_cellActivity) &&
+      TriangleWeights(a_point, a_triangleIdx, a_idxs, a_weights))
   {
-    int triangleIdx = triangleLocation / 3;
-    cellIdx = m_triangulator->GetCellFromTriangle(triangleIdx);
+    return m_triangulator->GetCellFromTriangle(a_triangleIdx);
   }
-  return cellIdx;
+  return GetIntersectedCell(a_point, a_cellActivity, a_idxs, a_weights);
 } // XmUGridTriangles2dImpl::GetIntersectedCell
 //------------------------------------------------------------------------------
+/// \brief Get the triangle of a cell that contains a point.
+/// \param[in] a_cellIdx The cell.
+/// \param[in] a_point The point.
+/// \return The triangle or -1 if the point isn't in the cell.
+//------------------------------------------------------------------------------
+int XmUGridTriangles2dImpl::GetCellTriangle(int a_cellIdx, const Pt3d& a_point) const
+{
+  if (!m_triangulator)
+    return -1;
+  BuildCellTriangles();
+  if (a_cellIdx < 0 || a_cellIdx + 1 >= (int)m_cellTriangleOffsets.size())
+    return -1;
+  VecInt idxs;
+  VecDbl weights;
+  for (int i = m_cellTriangleOffsets[a_cellIdx]; i < m_cellTriangleOffsets[a_cellIdx + 1]; ++i)
+  {
+    if (TriangleWeights(a_point, m_cellTriangles[i], idxs, weights))
+      return m_cellTriangles[i];
+  }
+  return -1;
+} // XmUGridTriangles2dImpl::GetCellTriangle
+//------------------------------------------------------------------------------
 /// \brief Initialize triangulation for a UGrid.
 /// \param[in] a_ugrid The UGrid for which triangles are generated.
 //------------------------------------------------------------------------------
@@ -233,26 +770,267 @@ void XmUGridTriangles2dImpl::Initialize(const XmUGrid& a_ugrid)
 {
   m_triangulator = XmUGridTriangulator::New(a_ugrid);
   m_triSearch.reset();
+  m_triSearchBuilt = false;
+  m_pointOption = -1;
+  m_pointTrianglesBuilt = false;
+  m_pointTriangleOffsets.clear();
+  m_pointTriangles.clear();
+  m_cellTrianglesBuilt = false;
+  m_cellTriangleOffsets.clear();
+  m_cellTriangles.clear();
+  m_triangleActivity.clear();
+  m_cellToPoint[0].reset();
+  m_cellToPoint[1].reset();
 } // XmUGridTriangles2dImpl::Initialize
 //------------------------------------------------------------------------------
-/// \brief Get triangle search object.
+/// \brief Generate triangles for contiguous ranges of cells on several threads
+///        and combine them in cell order. Gives the same points and triangles
+///        as building them serially.
+/// \param[in] a_ugrid The UGrid for which triangles are generated.
+/// \param[in] a_addCentroids Whether to try adding a centroid to each cell
+///            before using the earcut algorithm.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dImpl::BuildTrianglesParallel(const XmUGrid& a_ugrid, bool a_addCentroids)
+{
+  size_t numCells = (size_t)a_ugrid.GetCellCount();
+  int numThreads = xmResolveThreadCount(m_numThreads);
+  size_t numChunks = std::min(numThreads * CHUNKS_PER_THREAD,
+                              (numCells + MIN_CELLS_PER_CHUNK - 1) / MIN_CELLS_PER_CHUNK);
+
+  // triangulate each chunk of cells
+  const VecPt3d& points = m_triangulator->GetPoints();
+  std::vector<BSHP<XmUGridTrianglesChunk>> chunks(numChunks);
+  xmParallelFor(numChunks, numThreads, 1, [&](size_t a_begin, size_t a_end) {
+    VecInt cellPoints;
+    for (size_t chunkIdx = a_begin; chunkIdx < a_end; ++chunkIdx)
+    {
+      BSHP<XmUGridTrianglesChunk> chunk(new XmUGridTrianglesChunk(points));
+      int cellBegin = (int)(numCells * chunkIdx / numChunks);
+      int cellEnd = (int)(numCells * (chunkIdx + 1) / numChunks);
+      for (int cellIdx = cellBegin; cellIdx < cellEnd; ++cellIdx)
+      {
+        if (a_ugrid.GetCellDimension(cellIdx) != 2)
+          continue;
+        a_ugrid.GetCellPoints(cellIdx, cellPoints);
+        bool builtTriangles = false;
+        if (a_addCentroids)
+          builtTriangles = chunk->GenerateCentroidTriangles(cellIdx, cellPoints);
+        if (!builtTriangles)
+          chunk->BuildEarcutTriangles(cellIdx, cellPoints);
+      }
+      chunks[chunkIdx] = chunk;
+    }
+  });
+
+  // offset of each chunk's centroids and triangles in the combined arrays
+  VecInt centroidOffsets(numChunks + 1, 0);
+  VecInt triangleOffsets(numChunks + 1, 0);
+  for (size_t chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx)
+  {
+    const XmUGridTrianglesChunk& chunk = *chunks[chunkIdx];
+    centroidOffsets[chunkIdx + 1] = centroidOffsets[chunkIdx] + (int)chunk.m_centroids.size();
+    triangleOffsets[chunkIdx + 1] =
+      triangleOffsets[chunkIdx] + (int)chunk.m_triangleToCellIdx.size();
+  }
+
+  // copy the chunks into place
+  int numPoints = (int)points.size();
+  m_triangulator->Allocate(centroidOffsets.back(), triangleOffsets.back());
+  xmParallelFor(numChunks, numThreads, 1, [&](size_t a_begin, size_t a_end) {
+    for (size_t chunkIdx = a_begin; chunkIdx < a_end; ++chunkIdx)
+    {
+      const XmUGridTrianglesChunk& chunk = *chunks[chunkIdx];
+      int centroidOffset = centroidOffsets[chunkIdx];
+      for (size_t i = 0; i < chunk.m_centroids.size(); ++i)
+      {
+        m_triangulator->SetCentroidPoint(chunk.m_centroidCellIdxs[i],
+                                         numPoints + centroidOffset + (int)i, chunk.m_centroids[i]);
+      }
+
+      int triangleIdx = triangleOffsets[chunkIdx];
+      const VecInt& triangles = chunk.m_triangles;
+      for (size_t i = 0; i < chunk.m_triangleToCellIdx.size(); ++i, ++triangleIdx)
+      {
+        int idxs[3] = {triangles[3 * i], triangles[3 * i + 1], triangles[3 * i + 2]};
+        for (int& idx : idxs)
+        {
+          if (idx >= numPoints)
+            idx += centroidOffset;
+        }
+        m_triangulator->SetTriangle(triangleIdx, chunk.m_triangleToCellIdx[i], idxs[0], idxs[1],
+                                    idxs[2]);
+      }
+    }
+  });
+} // XmUGridTriangles2dImpl::BuildTrianglesParallel
+//------------------------------------------------------------------------------
+/// \brief Build the triangles attached to each point in compressed rows so an
+///        active triangle next to an inactive one can be found quickly. They
+///        are only built the first time a point is found in an inactive cell,
+///        which may happen on several threads at once.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dImpl::BuildPointTriangles() const
+{
+  if (m_pointTrianglesBuilt)
+    return;
+  std::lock_guard<std::mutex> lock(m_pointTrianglesMutex);
+  if (m_pointTrianglesBuilt)
+    return;
+
+  const VecInt& triangles = m_triangulator->GetTriangles();
+  size_t numPoints = m_triangulator->GetPoints().size();
+  m_pointTriangleOffsets.assign(numPoints + 1, 0);
+  for (auto pointIdx : triangles)
+    ++m_pointTriangleOffsets[pointIdx + 1];
+  for (size_t pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+    m_pointTriangleOffsets[pointIdx + 1] += m_pointTriangleOffsets[pointIdx];
+
+  VecInt positions(m_pointTriangleOffsets.begin(), m_pointTriangleOffsets.end() - 1);
+  m_pointTriangles.resize(triangles.size());
+  for (size_t i = 0; i < triangles.size(); ++i)
+    m_pointTriangles[positions[triangles[i]]++] = (int)(i / 3);
+  m_pointTrianglesBuilt = true;
+} // XmUGridTriangles2dImpl::BuildPointTriangles
+//------------------------------------------------------------------------------
+/// \brief Build the triangles of each cell in compressed rows so the triangle
+///        containing a point in a known cell can be found without searching.
+///        They are built the first time they are needed, which may happen on
+///        several threads at once.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dImpl::BuildCellTriangles() const
+{
+  if (m_cellTrianglesBuilt)
+    return;
+  std::lock_guard<std::mutex> lock(m_cellTrianglesMutex);
+  if (m_cellTrianglesBuilt)
+    return;
+
+  int numTriangles = (int)m_triangulator->GetTriangles().size() / 3;
+  int numCells = 0;
+  for (int triangleIdx = 0; triangleIdx < numTriangles; ++triangleIdx)
+    numCells = std::max(numCells, m_triangulator->GetCellFromTriangle(triangleIdx) + 1);
+  m_cellTriangleOffsets.assign(numCells + 1, 0);
+  for (int triangleIdx = 0; triangleIdx < numTriangles; ++triangleIdx)
+    ++m_cellTriangleOffsets[m_triangulator->GetCellFromTriangle(triangleIdx) + 1];
+  for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
+    m_cellTriangleOffsets[cellIdx + 1] += m_cellTriangleOffsets[cellIdx];
+
+  VecInt positions(m_cellTriangleOffsets.begin(), m_cellTriangleOffsets.end() - 1);
+  m_cellTriangles.resize(numTriangles);
+  for (int triangleIdx = 0; triangleIdx < numTriangles; ++triangleIdx)
+    m_cellTriangles[positions[m_triangulator->GetCellFromTriangle(triangleIdx)]++] = triangleIdx;
+  m_cellTrianglesBuilt = true;
+} // XmUGridTriangles2dImpl::BuildCellTriangles
 //------------------------------------------------------------------------------
-BSHP<GmTriSearch> XmUGridTriangles2dImpl::GetTriSearch()
+/// \brief Get triangle search object. It is built the first time it is
+///        needed rather than with the triangles, so triangles read from a
+///        file are ready without building the search. Can be called from
+///        several threads at once.
+/// \return The triangle search or null if there are no triangles.
+//------------------------------------------------------------------------------
+BSHP<GmTriSearch> XmUGridTriangles2dImpl::GetTriSearch() const
 {
-  if (!m_triSearch)
+  if (m_triSearchBuilt)
+    return m_triSearch;
+  std::lock_guard<std::mutex> lock(m_triSearchMutex);
+  if (m_triSearchBuilt || !m_triangulator)
+    return m_triSearch;
+
+  BSHP<VecPt3d> points = m_triangulator->GetPointsPtr();
+  if (!points)
+  {
+    // GmTriSearch takes mutable points but only reads them. The search is
+    // reset with the triangulator, which can't outlive the UGrid.
+    points.reset(const_cast<VecPt3d*>(&m_triangulator->GetPoints()), [](VecPt3d*) {});
+  }
+  BSHP<GmTriSearch> triSearch = GmTriSearch::New();
+  triSearch->TrisToSearch(points, m_triangulator->GetTrianglesPtr());
+  if (!m_triangleActivity.empty())
   {
-    m_triSearch = GmTriSearch::New();
-    m_triSearch->TrisToSearch(GetPointsPtr(), GetTrianglesPtr());
+    DynBitset triangleActivity = m_triangleActivity;
+    triSearch->SetTriActivity(triangleActivity);
   }
+  m_triSearch = triSearch;
+  m_triSearchBuilt = true;
   return m_triSearch;
 } // XmUGridTriangles2dImpl::GetTriSearch
+//------------------------------------------------------------------------------
+/// \brief Find the triangle containing a point using the triangle search.
+/// \param[in] a_point The point to find.
+/// \param[out] a_idxs The interpolation points.
+/// \param[out] a_weights The interpolation weights.
+/// \return The index of the triangle or -1 if not found.
+//------------------------------------------------------------------------------
+int XmUGridTriangles2dImpl::FindTriangle(const Pt3d& a_point,
+                                         VecInt& a_idxs,
+                                         VecDbl& a_weights) const
+{
+  BSHP<GmTriSearch> triSearch = GetTriSearch();
+  if (!triSearch)
+    return -1;
+  int triangleLocation;
+  if (triSearch->InterpWeightsTriangleIdx(a_point, triangleLocation, a_idxs, a_weights))
+    return triangleLocation / 3;
+  return -1;
+} // XmUGridTriangles2dImpl::FindTriangle
+//------------------------------------------------------------------------------
+/// \brief Determine if a triangle is active in both the given cell activity
+///        and the activity set on the triangles.
+/// \param[in] a_triangleIdx The triangle index.
+/// \param[in] a_cellActivity The cell activity. Empty for all active.
+/// \return True if the triangle is active.
+//------------------------------------------------------------------------------
+bool XmUGridTriangles2dImpl::IsTriangleActive(int a_triangleIdx,
+                                              const DynBitset& a_cellActivity) const
+{
+  if (!m_triangleActivity.empty() && !m_triangleActivity[a_triangleIdx])
+    return false;
+  int cellIdx = m_triangulator->GetCellFromTriangle(a_triangleIdx);
+  return cellIdx >= a_cellActivity.size() || a_cellActivity[cellIdx];
+} // XmUGridTriangles2dImpl::IsTriangleActive
+//------------------------------------------------------------------------------
+/// \brief Get the barycentric interpolation weights of a point in a triangle.
+/// \param[in] a_point The point.
+/// \param[in] a_triangleIdx The triangle index.
+/// \param[out] a_idxs The triangle points.
+/// \param[out] a_weights The weight of each triangle point.
+/// \return True if the point is inside or on the edge of the triangle.
+//------------------------------------------------------------------------------
+bool XmUGridTriangles2dImpl::TriangleWeights(const Pt3d& a_point,
+                                             int a_triangleIdx,
+                                             VecInt& a_idxs,
+                                             VecDbl& a_weights) const
+{
+  const VecPt3d& points = m_triangulator->GetPoints();
+  const VecInt& triangles = m_triangulator->GetTriangles();
+  const int* idxs = &triangles[a_triangleIdx * 3];
+  const Pt3d& p0 = points[idxs[0]];
+  const Pt3d& p1 = points[idxs[1]];
+  const Pt3d& p2 = points[idxs[2]];
+  double area2 = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+  if (area2 == 0.0)
+    return false;
+
+  double w0 = ((p1.x - a_point.x) * (p2.y - a_point.y) - (p1.y - a_point.y) * (p2.x - a_point.x)) /
+              area2;
+  double w1 = ((p2.x - a_point.x) * (p0.y - a_point.y) - (p2.y - a_point.y) * (p0.x - a_point.x)) /
+              area2;
+  double w2 = 1.0 - w0 - w1;
+  if (w0 < -WEIGHT_TOLERANCE || w1 < -WEIGHT_TOLERANCE || w2 < -WEIGHT_TOLERANCE)
+    return false;
+
+  a_idxs.assign(idxs, idxs + 3);
+  a_weights = {w0, w1, w2};
+  return true;
+} // XmUGridTriangles2dImpl::TriangleWeights
 
 } // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \class XmUGridTriangles2d
 /// \brief Class to store XmUGrid triangles. Tracks where midpoints and
-///        triangles came from.
+///        triangles came from. Only created with New, so new methods are
+///        pure virtual and signatures may change between versions.
 ////////////////////////////////////////////////////////////////////////////////
 //------------------------------------------------------------------------------
 /// \brief Build an instance of XmUGridTriangles2d
@@ -284,6 +1062,12 @@ XmUGridTriangles2d::~XmUGridTriangles2d()
 using namespace xms;
 #include <xmsextractor/ugrid/XmUGridTriangles2d.t.h>
 
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <numeric>
+#include <random>
+
 #include <xmscore/testing/TestTools.h>
 
 #include <xmsgrid/geometry/geoms.h>
@@ -327,6 +1111,165 @@ void iAssertDeltaVecPt3d(const char* a_file,
     }
   }
 } // iAssertDeltaVecPt3d
+//------------------------------------------------------------------------------
+/// \brief Build a UGrid of unit squares alternating between a pair of
+///        triangles, a quad, and a concave polygon that needs earcut triangles.
+/// \param[in] a_rows The number of rows of squares.
+/// \param[in] a_cols The number of columns of squares.
+/// \return The UGrid.
+//------------------------------------------------------------------------------
+std::shared_ptr<XmUGrid> iBuildMixedUGrid(int a_rows, int a_cols)
+{
+  VecPt3d points;
+  for (int row = 0; row <= a_rows; ++row)
+  {
+    for (int col = 0; col <= a_cols; ++col)
+      points.push_back(Pt3d(col, row, 0.1 * col));
+  }
+
+  VecInt cells;
+  for (int row = 0; row < a_rows; ++row)
+  {
+    for (int col = 0; col < a_cols; ++col)
+    {
+      int pt0 = row * (a_cols + 1) + col;
+      int pt1 = pt0 + 1;
+      int pt2 = pt1 + a_cols + 1;
+      int pt3 = pt0 + a_cols + 1;
+      switch ((row + col) % 3)
+      {
+      case 0:
+        cells.insert(cells.end(), {XMU_TRIANGLE, 3, pt0, pt1, pt2});
+        cells.insert(cells.end(), {XMU_TRIANGLE, 3, pt0, pt2, pt3});
+        break;
+      case 1:
+        cells.insert(cells.end(), {XMU_QUAD, 4, pt0, pt1, pt2, pt3});
+        break;
+      default:
+        // notch cut deep into the bottom so the centroid is outside the cell
+        int notch = (int)points.size();
+        points.push_back(Pt3d(col + 0.5, row + 0.9, 0.0));
+        cells.insert(cells.end(), {XMU_POLYGON, 5, pt0, notch, pt1, pt2, pt3});
+        break;
+      }
+    }
+  }
+  return XmUGrid::New(points, cells);
+} // iBuildMixedUGrid
+//------------------------------------------------------------------------------
+/// \brief Build a UGrid of quads with points numbered randomly like a mesh
+///        that hasn't been renumbered.
+/// \param[in] a_numRows The number of rows of points.
+/// \param[in] a_numCols The number of columns of points.
+/// \return The UGrid.
+//------------------------------------------------------------------------------
+std::shared_ptr<XmUGrid> iBuildShuffledQuadUGrid(int a_numRows, int a_numCols)
+{
+  VecInt pointIdxs(a_numRows * a_numCols);
+  std::iota(pointIdxs.begin(), pointIdxs.end(), 0);
+  std::shuffle(pointIdxs.begin(), pointIdxs.end(), std::mt19937(42));
+  VecPt3d points(a_numRows * a_numCols);
+  for (int row = 0; row < a_numRows; ++row)
+  {
+    for (int col = 0; col < a_numCols; ++col)
+      points[pointIdxs[row * a_numCols + col]] = Pt3d(col, row, 0);
+  }
+  VecInt cells;
+  cells.reserve(6 * (a_numRows - 1) * (a_numCols - 1));
+  for (int row = 0; row < a_numRows - 1; ++row)
+  {
+    for (int col = 0; col < a_numCols - 1; ++col)
+    {
+      int pt0 = row * a_numCols + col;
+      cells.insert(cells.end(), {XMU_QUAD, 4, pointIdxs[pt0], pointIdxs[pt0 + 1],
+                                 pointIdxs[pt0 + a_numCols + 1], pointIdxs[pt0 + a_numCols]});
+    }
+  }
+  return XmUGrid::New(points, cells);
+} // iBuildShuffledQuadUGrid
+//------------------------------------------------------------------------------
+/// \brief Check that two triangulations of a UGrid are the same.
+/// \param[in] a_ugrid The UGrid.
+/// \param[in] a_expected The expected triangles.
+/// \param[in] a_triangles The triangles to check.
+//------------------------------------------------------------------------------
+void iAssertSameTriangles(const XmUGrid& a_ugrid,
+                          XmUGridTriangles2d& a_expected,
+                          XmUGridTriangles2d& a_triangles)
+{
+  TS_ASSERT_EQUALS(a_expected.GetPoints(), a_triangles.GetPoints());
+  TS_ASSERT_EQUALS(a_expected.GetTriangles(), a_triangles.GetTriangles());
+  for (int cellIdx = 0; cellIdx < a_ugrid.GetCellCount(); ++cellIdx)
+    TS_ASSERT_EQUALS(a_expected.GetCellCentroid(cellIdx), a_triangles.GetCellCentroid(cellIdx));
+
+  const VecPt3d& points = a_expected.GetPoints();
+  const VecInt& triangles = a_expected.GetTriangles();
+  VecInt expectedIdxs, idxs;
+  VecDbl expectedWeights, weights;
+  for (size_t i = 0; i < triangles.size(); i += 3)
+  {
+    const Pt3d& p0 = points[triangles[i]];
+    const Pt3d& p1 = points[triangles[i + 1]];
+    const Pt3d& p2 = points[triangles[i + 2]];
+    Pt3d pt((p0.x + p1.x + p2.x) / 3, (p0.y + p1.y + p2.y) / 3, 0);
+    int expectedCell = a_expected.GetIntersectedCell(pt, expectedIdxs, expectedWeights);
+    TS_ASSERT_EQUALS(expectedCell, a_triangles.GetIntersectedCell(pt, idxs, weights));
+    TS_ASSERT_EQUALS(expectedIdxs, idxs);
+  }
+} // iAssertSameTriangles
+//------------------------------------------------------------------------------
+/// \brief Read the UGrid of the ExtractorRealData example, whose points and
+///        cells are stored as Python list items.
+/// \return The UGrid or null if the example files can't be read.
+//------------------------------------------------------------------------------
+std::shared_ptr<XmUGrid> iReadRealDataUGrid()
+{
+  // the example is in the repository next to the source directory
+  std::string path = __FILE__;
+  size_t sourceDir = path.rfind("xmsextractor");
+  std::string exampleDir = sourceDir == std::string::npos ? "" : path.substr(0, sourceDir);
+  exampleDir += "examples/ExtractorRealData/";
+  std::ifstream pointsFile(exampleDir + "PointsData.txt");
+  std::ifstream cellsFile(exampleDir + "CellsData.txt");
+  if (!pointsFile || !cellsFile)
+    return nullptr;
+
+  // points are "(x, y, z)," items
+  VecPt3d points;
+  std::string item;
+  while (std::getline(pointsFile, item, ')'))
+  {
+    std::replace_if(item.begin(), item.end(), [](char c) { return c == '(' || c == ','; }, ' ');
+    std::istringstream coords(item);
+    Pt3d point;
+    if (coords >> point.x >> point.y >> point.z)
+      points.push_back(point);
+  }
+
+  // cells are "xmsgrid.ugrid.UGrid.TRIANGLE, 3, i, j, k," items
+  VecInt cells;
+  while (std::getline(cellsFile, item, ','))
+  {
+    size_t typeStart = item.find("UGrid.");
+    if (typeStart == std::string::npos)
+    {
+      std::istringstream value(item);
+      int number;
+      if (value >> number)
+        cells.push_back(number);
+      continue;
+    }
+    std::string type = item.substr(typeStart + 6);
+    type.erase(type.find_last_not_of(" \t\r\n") + 1);
+    if (type == "TRIANGLE")
+      cells.push_back(XMU_TRIANGLE);
+    else if (type == "QUAD")
+      cells.push_back(XMU_QUAD);
+    else
+      cells.push_back(XMU_POLYGON);
+  }
+  return XmUGrid::New(points, cells);
+} // iReadRealDataUGrid
 } // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -704,4 +1647,551 @@ void XmUGridTriangles2dUnitTests::testBuildCentroidAndEarcutTrianglesBottomFace(
   TS_ASSERT_EQUALS(trianglesExpected, trianglesOut);
 } // XmUGridTriangles2dUnitTests::testBuildCentroidAndEarcutTrianglesBottomFace
 
+//------------------------------------------------------------------------------
+/// \brief Test building triangles on several threads gives the same triangles
+///        as building them serially.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dUnitTests::testBuildTrianglesParallel()
+{
+  std::shared_ptr<XmUGrid> ugrid = iBuildMixedUGrid(40, 50);
+  TS_REQUIRE_NOT_NULL(ugrid);
+
+  XmUGridTriangles2d::PointOptionEnum options[] = {XmUGridTriangles2d::PO_NO_POINTS,
+                                                   XmUGridTriangles2d::PO_CENTROIDS_ONLY};
+  for (auto option : options)
+  {
+    XmUGridTriangles2dImpl serial;
+    serial.BuildTriangles(*ugrid, option);
+
+    XmUGridTriangles2dImpl parallel;
+    parallel.SetThreadCount(4);
+    parallel.BuildTriangles(*ugrid, option);
+
+    TS_ASSERT_EQUALS(serial.GetPoints(), parallel.GetPoints());
+    TS_ASSERT_EQUALS(serial.GetTriangles(), parallel.GetTriangles());
+    for (int cellIdx = 0; cellIdx < ugrid->GetCellCount(); ++cellIdx)
+      TS_ASSERT_EQUALS(serial.GetCellCentroid(cellIdx), parallel.GetCellCentroid(cellIdx));
+
+    VecInt serialIdxs, parallelIdxs;
+    VecDbl serialWeights, parallelWeights;
+    Pt3d pts[] = {{0.25, 0.75, 0}, {10.5, 10.95, 0}, {20.3, 30.4, 0}, {49.9, 39.9, 0}};
+    for (const Pt3d& pt : pts)
+    {
+      int serialCell = serial.GetIntersectedCell(pt, serialIdxs, serialWeights);
+      int parallelCell = parallel.GetIntersectedCell(pt, parallelIdxs, parallelWeights);
+      TS_ASSERT_EQUALS(serialCell, parallelCell);
+      TS_ASSERT_EQUALS(serialIdxs, parallelIdxs);
+      TS_ASSERT_EQUALS(serialWeights, parallelWeights);
+    }
+  }
+
+  XmUGridTriangles2dImpl serial;
+  serial.BuildEarcutTriangles(*ugrid);
+  XmUGridTriangles2dImpl parallel;
+  parallel.SetThreadCount(3);
+  parallel.BuildEarcutTriangles(*ugrid);
+  TS_ASSERT_EQUALS(serial.GetPoints(), parallel.GetPoints());
+  TS_ASSERT_EQUALS(serial.GetTriangles(), parallel.GetTriangles());
+} // XmUGridTriangles2dUnitTests::testBuildTrianglesParallel
+
+//------------------------------------------------------------------------------
+/// \brief Test creating earcut and centroid triangles on convex, clockwise,
+///        concave and degenerate quads.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dUnitTests::testBuildEarcutTrianglesOnQuads()
+{
+  // clang-format off
+  VecPt3d points = {
+    {0, 0, 0}, {10, 0, 0}, {10, 10, 0}, {0, 10, 0},      // 0-3 square
+    {20, 0, 0}, {35, 2, 0}, {33, 9, 0}, {22, 12, 0},     // 4-7 skewed
+    {40, 0, 0}, {40, 10, 0}, {50, 10, 0}, {50, 0, 0},    // 8-11 clockwise
+    {60, 0, 0}, {70, 5, 0}, {60, 10, 0}, {67, 5, 0},     // 12-15 dart
+    {80, 0, 0}, {85, 0, 0}, {90, 0, 0}, {85, 10, 0}      // 16-19 collinear
+  };
+  std::vector<int> cells = {
+    XMU_QUAD, 4, 0, 1, 2, 3,
+    XMU_QUAD, 4, 4, 5, 6, 7,
+    XMU_QUAD, 4, 8, 9, 10, 11,
+    XMU_QUAD, 4, 12, 13, 14, 15,
+    XMU_QUAD, 4, 16, 17, 18, 19
+  };
+  // clang-format on
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  TS_REQUIRE_NOT_NULL(ugrid);
+
+  XmUGridTriangles2dImpl ugridTris;
+  ugridTris.BuildEarcutTriangles(*ugrid);
+  VecInt trianglesOut = ugridTris.GetTriangles();
+  VecInt trianglesExpected = {
+    // clang-format off
+    0, 1, 2,     0, 2, 3,     // square
+    6, 7, 4,     4, 5, 6,     // skewed
+    8, 9, 10,    8, 10, 11,   // clockwise
+    13, 14, 15,  12, 13, 15,  // dart
+    19, 16, 17,  17, 18, 19   // collinear
+    // clang-format on
+  };
+  TS_ASSERT_EQUALS(trianglesExpected, trianglesOut);
+
+  // the dart centroid is outside of the cell so it uses earcut triangles
+  ugridTris.BuildTriangles(*ugrid, XmUGridTriangles2d::PO_CENTROIDS_ONLY);
+  trianglesOut = ugridTris.GetTriangles();
+  trianglesExpected = {
+    // clang-format off
+    0, 1, 20,   1, 2, 20,   2, 3, 20,    3, 0, 20,   // square
+    4, 5, 21,   5, 6, 21,   6, 7, 21,    7, 4, 21,   // skewed
+    8, 9, 22,   9, 10, 22,  10, 11, 22,  11, 8, 22,  // clockwise
+    13, 14, 15, 12, 13, 15,                          // dart
+    16, 17, 23, 17, 18, 23, 18, 19, 23,  19, 16, 23  // collinear
+    // clang-format on
+  };
+  TS_ASSERT_EQUALS(trianglesExpected, trianglesOut);
+  VecPt3d triPointsOut = ugridTris.GetPoints();
+  VecPt3d triPointsExpected = points;
+  triPointsExpected.push_back({5, 5, 0});
+  triPointsExpected.push_back({26.912287, 5.529010, 0});
+  triPointsExpected.push_back({45, 5, 0});
+  triPointsExpected.push_back({85, 10 / 3.0, 0});
+  iAssertDeltaVecPt3d(__FILE__, __LINE__, triPointsExpected, triPointsOut, 1.0e-5);
+} // XmUGridTriangles2dUnitTests::testBuildEarcutTrianglesOnQuads
+
+//------------------------------------------------------------------------------
+/// \brief Test creating earcut triangles for a large concave polygon.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dUnitTests::testBuildEarcutTrianglesLargePolygon()
+{
+  // wavy circle with eight concave bays
+  const int numPoints = 1000;
+  const double pi = 3.14159265358979323846;
+  VecPt3d points;
+  VecInt cells = {XMU_POLYGON, numPoints};
+  double polygonArea = 0.0;
+  for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+  {
+    double angle = 2 * pi * pointIdx / numPoints;
+    double radius = 10 + sin(8 * angle);
+    points.push_back(Pt3d(radius * cos(angle), radius * sin(angle), 0));
+    cells.push_back(pointIdx);
+  }
+  for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+  {
+    const Pt3d& pt1 = points[pointIdx];
+    const Pt3d& pt2 = points[(pointIdx + 1) % numPoints];
+    polygonArea += (pt1.x * pt2.y - pt2.x * pt1.y) / 2;
+  }
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  TS_REQUIRE_NOT_NULL(ugrid);
+
+  XmUGridTriangles2dImpl ugridTris;
+  ugridTris.BuildEarcutTriangles(*ugrid);
+  const VecInt& triangles = ugridTris.GetTriangles();
+  TS_ASSERT_EQUALS(3 * (numPoints - 2), (int)triangles.size());
+
+  // triangles are counter clockwise and cover the cell
+  double area = 0.0;
+  for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+  {
+    const Pt3d& pt1 = points[triangles[i]];
+    const Pt3d& pt2 = points[triangles[i + 1]];
+    const Pt3d& pt3 = points[triangles[i + 2]];
+    double triangleArea = ((pt2.x - pt1.x) * (pt3.y - pt1.y) - (pt3.x - pt1.x) * (pt2.y - pt1.y)) / 2;
+    TS_ASSERT(triangleArea > 0.0);
+    area += triangleArea;
+  }
+  TS_ASSERT_DELTA(polygonArea, area, 1.0e-6);
+} // XmUGridTriangles2dUnitTests::testBuildEarcutTrianglesLargePolygon
+//------------------------------------------------------------------------------
+/// \brief Test that triangle points share the UGrid locations until centroid
+///        or midpoint points are added.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dUnitTests::testSharedUGridPoints()
+{
+  std::shared_ptr<XmUGrid> ugrid = iBuildMixedUGrid(30, 40);
+  TS_REQUIRE_NOT_NULL(ugrid);
+  const VecPt3d& locations = ugrid->GetLocations();
+
+  XmUGridTriangles2dImpl triangles;
+  triangles.BuildTriangles(*ugrid, XmUGridTriangles2d::PO_NO_POINTS);
+  TS_ASSERT_EQUALS(&locations, &triangles.GetPoints());
+  // the shared pointer refers to the UGrid locations without copying them
+  BSHP<const VecPt3d> pointsPtr = triangles.GetPointsPtr();
+  TS_ASSERT_EQUALS(&locations, pointsPtr.get());
+  VecInt idxs;
+  VecDbl weights;
+  TS_ASSERT(triangles.GetIntersectedCell(locations[0], idxs, weights) >= 0);
+
+  XmUGridTriangles2d::PointOptionEnum options[] = {
+    XmUGridTriangles2d::PO_CENTROIDS_ONLY, XmUGridTriangles2d::PO_CENTROIDS_AND_MIDPOINTS};
+  for (auto option : options)
+  {
+    triangles.BuildTriangles(*ugrid, option);
+    const VecPt3d& points = triangles.GetPoints();
+    TS_ASSERT(&locations != &points);
+    TS_ASSERT(points.size() > locations.size());
+    TS_ASSERT(std::equal(locations.begin(), locations.end(), points.begin()));
+    TS_ASSERT_EQUALS(&points, triangles.GetPointsPtr().get());
+  }
+
+  // the parallel build adds its centroids to a copy as well
+  triangles.SetThreadCount(3);
+  triangles.BuildTriangles(*ugrid, XmUGridTriangles2d::PO_NO_POINTS);
+  TS_ASSERT_EQUALS(&locations, &triangles.GetPoints());
+  triangles.BuildTriangles(*ugrid, XmUGridTriangles2d::PO_CENTROIDS_ONLY);
+  TS_ASSERT(&locations != &triangles.GetPoints());
+  TS_ASSERT_EQUALS(ugrid->GetPointCount(), (int)locations.size());
+} // XmUGridTriangles2dUnitTests::testSharedUGridPoints
+//------------------------------------------------------------------------------
+/// \brief Test finding the intersected cell with cell activity that isn't
+///        set on the triangles.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dUnitTests::testIntersectedCellWithActivity()
+{
+  //  3----2
+  //  | 1 /|
+  //  |  / |
+  //  | /  |
+  //  |/ 0 |
+  //  0----1
+  VecPt3d points = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+  VecInt cells = {XMU_TRIANGLE, 3, 0, 1, 2, XMU_TRIANGLE, 3, 0, 2, 3};
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  TS_REQUIRE_NOT_NULL(ugrid);
+
+  XmUGridTriangles2dImpl triangles;
+  triangles.BuildTriangles(*ugrid, XmUGridTriangles2d::PO_NO_POINTS);
+
+  const double delta = 1.0e-9;
+  VecInt idxs;
+  VecDbl weights;
+  DynBitset allActive;
+  DynBitset cell0Inactive;
+  cell0Inactive.resize(2, true);
+  cell0Inactive[0] = false;
+  DynBitset noneActive;
+  noneActive.resize(2, false);
+
+  // point on the shared edge
+  Pt3d edgePt(0.5, 0.5, 0);
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(edgePt, allActive, idxs, weights));
+  TS_ASSERT_EQUALS(1, triangles.GetIntersectedCell(edgePt, cell0Inactive, idxs, weights));
+  VecInt idxsExpected = {0, 2, 3};
+  TS_ASSERT_EQUALS(idxsExpected, idxs);
+  VecDbl weightsExpected = {0.5, 0.5, 0.0};
+  TS_ASSERT_DELTA_VEC(weightsExpected, weights, delta);
+  TS_ASSERT_EQUALS(-1, triangles.GetIntersectedCell(edgePt, noneActive, idxs, weights));
+  TS_ASSERT(idxs.empty());
+
+  // point inside the inactive cell
+  Pt3d innerPt(0.75, 0.25, 0);
+  TS_ASSERT_EQUALS(-1, triangles.GetIntersectedCell(innerPt, cell0Inactive, idxs, weights));
+
+  // the activity isn't kept by the triangles
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(edgePt, idxs, weights));
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(innerPt, idxs, weights));
+
+  // activity set on the triangles is combined with the given activity
+  DynBitset cell1Inactive;
+  cell1Inactive.resize(2, true);
+  cell1Inactive[1] = false;
+  triangles.SetCellActivity(cell1Inactive);
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(edgePt, allActive, idxs, weights));
+  TS_ASSERT_EQUALS(-1, triangles.GetIntersectedCell(edgePt, cell0Inactive, idxs, weights));
+} // XmUGridTriangles2dUnitTests::testIntersectedCellWithActivity
+//------------------------------------------------------------------------------
+/// \brief Test getting the intersected cell checking a given triangle first.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dUnitTests::testIntersectedCellWithTriangle()
+{
+  VecPt3d points = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+  VecInt cells = {XMU_TRIANGLE, 3, 0, 1, 2, XMU_TRIANGLE, 3, 0, 2, 3};
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  TS_REQUIRE_NOT_NULL(ugrid);
+
+  XmUGridTriangles2dImpl triangles;
+  triangles.BuildTriangles(*ugrid, XmUGridTriangles2d::PO_NO_POINTS);
+
+  VecInt idxs;
+  VecDbl weights;
+  DynBitset allActive;
+  DynBitset cell1Inactive;
+  cell1Inactive.resize(2, true);
+  cell1Inactive[1] = false;
+
+  // the given triangle is used when it contains the point
+  Pt3d innerPt(0.75, 0.25, 0);
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(innerPt, 0, allActive, idxs, weights));
+  VecInt idxsExpected = {0, 1, 2};
+  TS_ASSERT_EQUALS(idxsExpected, idxs);
+  VecDbl weightsExpected = {0.25, 0.5, 0.25};
+  TS_ASSERT_DELTA_VEC(weightsExpected, weights, 1.0e-9);
+  Pt3d edgePt(0.5, 0.5, 0);
+  TS_ASSERT_EQUALS(1, triangles.GetIntersectedCell(edgePt, 1, allActive, idxs, weights));
+
+  // otherwise the triangles are searched
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(innerPt, 1, allActive, idxs, weights));
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(innerPt, -1, allActive, idxs, weights));
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(innerPt, 2, allActive, idxs, weights));
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(edgePt, 1, cell1Inactive, idxs, weights));
+  TS_ASSERT_EQUALS(-1, triangles.GetIntersectedCell(Pt3d(2, 2, 0), 0, allActive, idxs, weights));
+} // XmUGridTriangles2dUnitTests::testIntersectedCellWithTriangle
+//------------------------------------------------------------------------------
+/// \brief Test getting the triangle of a cell that contains a point.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dUnitTests::testCellTriangle()
+{
+  // (3)  3--------2  (2)
+  //      |        |
+  //      |   4    |
+  //      |        |
+  // (0)  0--------1--------5  (1)
+  VecPt3d points = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {2, 0, 0}};
+  VecInt cells = {XMU_QUAD, 4, 0, 1, 2, 3, XMU_TRIANGLE, 3, 1, 4, 2};
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  TS_REQUIRE_NOT_NULL(ugrid);
+
+  XmUGridTriangles2dImpl triangles;
+  triangles.BuildTriangles(*ugrid, XmUGridTriangles2d::PO_CENTROIDS_ONLY);
+
+  VecInt idxs;
+  VecDbl weights;
+  Pt3d quadPt(0.5, 0.25, 0);
+  int triangleIdx = triangles.GetCellTriangle(0, quadPt);
+  TS_ASSERT(triangleIdx >= 0);
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(quadPt, triangleIdx, DynBitset(), idxs,
+                                                   weights));
+  Pt3d trianglePt(1.25, 0.25, 0);
+  triangleIdx = triangles.GetCellTriangle(1, trianglePt);
+  TS_ASSERT_EQUALS(1, triangles.GetIntersectedCell(trianglePt, triangleIdx, DynBitset(), idxs,
+                                                   weights));
+  TS_ASSERT_EQUALS(-1, triangles.GetCellTriangle(1, quadPt));
+  TS_ASSERT_EQUALS(-1, triangles.GetCellTriangle(2, quadPt));
+  TS_ASSERT_EQUALS(-1, triangles.GetCellTriangle(-1, quadPt));
+
+  // a point on the edge between the cells is in both
+  Pt3d edgePt(1, 0.5, 0);
+  triangleIdx = triangles.GetCellTriangle(0, edgePt);
+  TS_ASSERT_EQUALS(0, triangles.GetIntersectedCell(edgePt, triangleIdx, DynBitset(), idxs,
+                                                   weights));
+  triangleIdx = triangles.GetCellTriangle(1, edgePt);
+  TS_ASSERT_EQUALS(1, triangles.GetIntersectedCell(edgePt, triangleIdx, DynBitset(), idxs,
+                                                   weights));
+} // XmUGridTriangles2dUnitTests::testCellTriangle
+//------------------------------------------------------------------------------
+/// \brief Test writing triangles to a file and reading them back.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dUnitTests::testWriteAndReadFile()
+{
+  const std::string fileName = "XmUGridTriangles2d_testWriteAndReadFile.bin";
+  std::shared_ptr<XmUGrid> ugrid = iBuildMixedUGrid(6, 8);
+  TS_REQUIRE_NOT_NULL(ugrid);
+
+  XmUGridTriangles2dImpl unbuilt;
+  TS_ASSERT(!unbuilt.WriteToFile(fileName, *ugrid));
+  TS_ASSERT(!unbuilt.ReadFromFile(fileName + ".missing", *ugrid, XmUGridTriangles2d::PO_NO_POINTS));
+
+  XmUGridTriangles2d::PointOptionEnum options[] = {XmUGridTriangles2d::PO_NO_POINTS,
+                                                   XmUGridTriangles2d::PO_CENTROIDS_ONLY,
+                                                   XmUGridTriangles2d::PO_CENTROIDS_AND_MIDPOINTS};
+  for (auto option : options)
+  {
+    XmUGridTriangles2dImpl built;
+    built.BuildTriangles(*ugrid, option);
+    TS_ASSERT(built.WriteToFile(fileName, *ugrid));
+
+    XmUGridTriangles2dImpl read;
+    TS_ASSERT(read.ReadFromFile(fileName, *ugrid, option));
+    iAssertSameTriangles(*ugrid, built, read);
+    if (option == XmUGridTriangles2d::PO_NO_POINTS)
+      TS_ASSERT_EQUALS(&ugrid->GetLocations(), &read.GetPoints());
+
+    // a file for another point option isn't read
+    auto otherOption = option == XmUGridTriangles2d::PO_NO_POINTS
+                         ? XmUGridTriangles2d::PO_CENTROIDS_ONLY
+                         : XmUGridTriangles2d::PO_NO_POINTS;
+    TS_ASSERT(!read.ReadFromFile(fileName, *ugrid, otherOption));
+    iAssertSameTriangles(*ugrid, built, read);
+  }
+
+  // a file for a different UGrid isn't read
+  VecPt3d movedPoints = ugrid->GetLocations();
+  movedPoints[3].x += 0.001;
+  std::shared_ptr<XmUGrid> movedUGrid = XmUGrid::New(movedPoints, ugrid->GetCellstream());
+  XmUGridTriangles2dImpl triangles;
+  TS_ASSERT(!triangles.ReadFromFile(fileName, *movedUGrid,
+                                    XmUGridTriangles2d::PO_CENTROIDS_AND_MIDPOINTS));
+  TS_ASSERT(triangles.ReadFromFile(fileName, *ugrid,
+                                   XmUGridTriangles2d::PO_CENTROIDS_AND_MIDPOINTS));
+
+  // a truncated file isn't read
+  std::string contents;
+  {
+    std::ifstream file(fileName, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size() - 4);
+  }
+  TS_ASSERT(!triangles.ReadFromFile(fileName, *ugrid,
+                                    XmUGridTriangles2d::PO_CENTROIDS_AND_MIDPOINTS));
+  std::remove(fileName.c_str());
+} // XmUGridTriangles2dUnitTests::testWriteAndReadFile
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmUGridTriangles2dIntermediateTests
+/// \brief Longer running tests of XmUGridTriangles2d on large grids.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Benchmark building centroid and midpoint triangles on a grid with a
+///        million points.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dIntermediateTests::testBuildMidpointTrianglesLargeGrid()
+{
+  const int numRows = 1000;
+  const int numCols = 1000;
+  std::shared_ptr<XmUGrid> ugrid = iBuildShuffledQuadUGrid(numRows, numCols);
+  TS_REQUIRE_NOT_NULL(ugrid);
+
+  XmUGridTriangles2dImpl triangles;
+  triangles.BuildTriangles(*ugrid, XmUGridTriangles2d::PO_CENTROIDS_AND_MIDPOINTS);
+
+  int numCells = (numRows - 1) * (numCols - 1);
+  int numEdges = numRows * (numCols - 1) + (numRows - 1) * numCols;
+  TS_ASSERT_EQUALS(numRows * numCols + numEdges + numCells, (int)triangles.GetPoints().size());
+  TS_ASSERT_EQUALS(3 * 8 * numCells, (int)triangles.GetTriangles().size());
+} // XmUGridTriangles2dIntermediateTests::testBuildMidpointTrianglesLargeGrid
+//------------------------------------------------------------------------------
+/// \brief Benchmark reading triangles from a file against building them on a
+///        grid with a million points. Reading only skips the triangulation,
+///        the triangle search is built by the first search either way and
+///        takes most of the time to the first search.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dIntermediateTests::testReadTrianglesFileLargeGrid()
+{
+  const std::string fileName = "XmUGridTriangles2d_testReadTrianglesFileLargeGrid.bin";
+  std::shared_ptr<XmUGrid> ugrid = iBuildShuffledQuadUGrid(1000, 1000);
+  TS_REQUIRE_NOT_NULL(ugrid);
+  const Pt3d point(500.25, 500.75, 0);
+  VecInt builtIdxs, readIdxs;
+  VecDbl builtWeights, readWeights;
+
+  auto start = std::chrono::steady_clock::now();
+  XmUGridTriangles2dImpl built;
+  built.BuildTriangles(*ugrid, XmUGridTriangles2d::PO_CENTROIDS_ONLY);
+  std::chrono::duration<double> buildTime = std::chrono::steady_clock::now() - start;
+  int builtCell = built.GetIntersectedCell(point, builtIdxs, builtWeights);
+  std::chrono::duration<double> coldTime = std::chrono::steady_clock::now() - start;
+  TS_ASSERT(built.WriteToFile(fileName, *ugrid));
+
+  start = std::chrono::steady_clock::now();
+  XmUGridTriangles2dImpl read;
+  TS_ASSERT(read.ReadFromFile(fileName, *ugrid, XmUGridTriangles2d::PO_CENTROIDS_ONLY));
+  std::chrono::duration<double> readTime = std::chrono::steady_clock::now() - start;
+  int readCell = read.GetIntersectedCell(point, readIdxs, readWeights);
+  std::chrono::duration<double> warmTime = std::chrono::steady_clock::now() - start;
+  std::remove(fileName.c_str());
+
+  TS_ASSERT_EQUALS(built.GetPoints(), read.GetPoints());
+  TS_ASSERT_EQUALS(built.GetTriangles(), read.GetTriangles());
+  TS_ASSERT(builtCell >= 0);
+  TS_ASSERT_EQUALS(builtCell, readCell);
+  TS_ASSERT_EQUALS(builtIdxs, readIdxs);
+  std::ostringstream msg;
+  msg << "BuildTriangles: " << buildTime.count() << " seconds, ReadFromFile: "
+      << readTime.count() << " seconds; to first search cold: " << coldTime.count()
+      << " seconds, warm: " << warmTime.count() << " seconds";
+  TS_TRACE(msg.str());
+} // XmUGridTriangles2dIntermediateTests::testReadTrianglesFileLargeGrid
+
+//------------------------------------------------------------------------------
+/// \brief Benchmark building triangles for each point option on large polygon
+///        cells.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dIntermediateTests::testBuildTrianglesLargePolygonModes()
+{
+  // a row of wavy circles with eight concave bays each
+  const int numCells = 100;
+  const int numCellPoints = 2000;
+  const double pi = 3.14159265358979323846;
+  VecPt3d points;
+  VecInt cells;
+  for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
+  {
+    cells.push_back(XMU_POLYGON);
+    cells.push_back(numCellPoints);
+    for (int pointIdx = 0; pointIdx < numCellPoints; ++pointIdx)
+    {
+      double angle = 2 * pi * pointIdx / numCellPoints;
+      double radius = 10 + sin(8 * angle);
+      cells.push_back((int)points.size());
+      points.push_back(Pt3d(25 * cellIdx + radius * cos(angle), radius * sin(angle), 0));
+    }
+  }
+  std::shared_ptr<XmUGrid> ugrid = XmUGrid::New(points, cells);
+  TS_REQUIRE_NOT_NULL(ugrid);
+
+  // the centroids are inside the cells so centroid cells are split into a fan
+  // with a triangle for each corner and midpoint
+  struct Mode
+  {
+    XmUGridTriangles2d::PointOptionEnum option;
+    const char* name;
+    int numTriangles;
+  };
+  Mode modes[] = {
+    {XmUGridTriangles2d::PO_NO_POINTS, "no points", numCellPoints - 2},
+    {XmUGridTriangles2d::PO_CENTROIDS_ONLY, "centroids", numCellPoints},
+    {XmUGridTriangles2d::PO_CENTROIDS_AND_MIDPOINTS, "centroids and midpoints",
+     2 * numCellPoints}};
+  for (const Mode& mode : modes)
+  {
+    XmUGridTriangles2dImpl triangles;
+    auto start = std::chrono::steady_clock::now();
+    triangles.BuildTriangles(*ugrid, mode.option);
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::ostringstream msg;
+    msg << "BuildTriangles with " << mode.name << ": " << seconds.count() << " seconds";
+    TS_TRACE(msg.str());
+    TS_ASSERT_EQUALS(3 * numCells * mode.numTriangles, (int)triangles.GetTriangles().size());
+  }
+} // XmUGridTriangles2dIntermediateTests::testBuildTrianglesLargePolygonModes
+//------------------------------------------------------------------------------
+/// \brief Benchmark building triangles for the ExtractorRealData example mesh
+///        as the data extractor does at start up.
+//------------------------------------------------------------------------------
+void XmUGridTriangles2dIntermediateTests::testBuildTrianglesRealData()
+{
+  std::shared_ptr<XmUGrid> ugrid = iReadRealDataUGrid();
+  TS_REQUIRE_NOT_NULL(ugrid);
+  TS_ASSERT_EQUALS(14266, ugrid->GetPointCount());
+  TS_ASSERT_EQUALS(28130, ugrid->GetCellCount());
+
+  const int numRepeats = 50;
+  struct Mode
+  {
+    XmUGridTriangles2d::PointOptionEnum option;
+    const char* name;
+  };
+  Mode modes[] = {{XmUGridTriangles2d::PO_NO_POINTS, "point scalars (no points)"},
+                  {XmUGridTriangles2d::PO_CENTROIDS_ONLY, "cell scalars (centroids)"}};
+  for (const Mode& mode : modes)
+  {
+    std::chrono::duration<double> seconds(0);
+    for (int i = 0; i < numRepeats; ++i)
+    {
+      XmUGridTriangles2dImpl triangles;
+      auto start = std::chrono::steady_clock::now();
+      triangles.BuildTriangles(*ugrid, mode.option);
+      seconds += std::chrono::steady_clock::now() - start;
+      int numTriangles = mode.option == XmUGridTriangles2d::PO_NO_POINTS ? 28130 : 3 * 28130;
+      TS_ASSERT_EQUALS(3 * numTriangles, (int)triangles.GetTriangles().size());
+    }
+    std::ostringstream msg;
+    msg << "BuildTriangles on ExtractorRealData for " << mode.name << ": "
+        << seconds.count() / numRepeats << " seconds";
+    TS_TRACE(msg.str());
+  }
+} // XmUGridTriangles2dIntermediateTests::testBuildTrianglesRealData
+
 #endif
@@ -10,6 +10,7 @@
 //----- Included files ---------------------------------------------------------
 
 // 3. Standard library headers
+#include <string>
 
 // 4. External library headers
 
@@ -28,6 +29,7 @@ namespace xms
 {
 //----- Forward declarations ---------------------------------------------------
 class XmUGrid;
+struct XmCellToPointOperator;
 
 //----- Constants / Enumerations -----------------------------------------------
 
@@ -40,7 +42,8 @@ public:
   static BSHP<XmUGridTriangles2d> New();
   virtual ~XmUGridTriangles2d();
 
-  /// \brief Generate triangles for the UGrid.
+  /// \brief Generate triangles for the UGrid. The triangles refer to the
+  ///        UGrid and its locations, so it must exist while they are used.
   /// \param[in] a_ugrid The UGrid for which triangles are generated.
   /// \param[in] a_pointOption Whether to add no points, add centroids only, or add centroids and
   /// midpoints.
@@ -49,9 +52,39 @@ public:
   /// \brief Generate triangles for the UGrid using earcut algorithm.
   /// \param[in] a_ugrid The UGrid for which triangles are generated.
   virtual void BuildEarcutTriangles(const XmUGrid& a_ugrid) = 0;
-  /// \brief Set triangle activity based on each triangles cell.
+  /// \brief Set triangle activity based on each triangles cell. The activity
+  ///        is seen by everything sharing the triangles. Use the
+  ///        GetIntersectedCell overload that takes a cell activity to give
+  ///        each user its own activity.
   /// \param[in] a_cellActivity The cell activity to set on the triangles.
   virtual void SetCellActivity(const DynBitset& a_cellActivity) = 0;
+  /// \brief Set the number of threads used to build triangles. Triangles are
+  ///        the same for any thread count. Midpoint triangles are always built
+  ///        serially.
+  /// \param[in] a_numThreads The number of threads. One (the default) builds
+  ///            serially. Zero or less uses the number of hardware threads.
+  virtual void SetThreadCount(int a_numThreads) = 0;
+
+  /// \brief Write the triangles to a binary file that can be read instead of
+  ///        building the triangles again for the same UGrid. A temporary file
+  ///        is renamed over the file so readers never see it partly written.
+  /// \param[in] a_fileName The file to write.
+  /// \param[in] a_ugrid The UGrid the triangles were built for.
+  /// \return True if the file was written.
+  virtual bool WriteToFile(const std::string& a_fileName, const XmUGrid& a_ugrid) const = 0;
+  /// \brief Read triangles written by WriteToFile. This only skips the
+  ///        triangulation: the triangle search is not in the file and is
+  ///        built again by the first search.
+  /// \param[in] a_fileName The file to read.
+  /// \param[in] a_ugrid The UGrid the triangles are for.
+  /// \param[in] a_pointOption The point option the triangles must have been
+  ///            built with.
+  /// \return False and leaves the triangles unchanged if the file is missing,
+  ///         is from another version, or was written for a different UGrid or
+  ///         point option.
+  virtual bool ReadFromFile(const std::string& a_fileName,
+                            const XmUGrid& a_ugrid,
+                            PointOptionEnum a_pointOption) = 0;
 
   /// \brief Get the generated triangle points.
   /// \return The triangle points
@@ -59,9 +92,12 @@ public:
   /// \brief Get the generated triangles.
   /// \return a vector of indices for the triangles.
   virtual const VecInt& GetTriangles() const = 0;
-  /// \brief Get the generated triangle points as a shared pointer.
+  /// \brief Get the generated triangle points as a shared pointer. When no
+  ///        points were added the triangle points are the UGrid locations,
+  ///        which the pointer refers to without owning, so it is only valid
+  ///        while the UGrid is.
   /// \return The triangle points
-  virtual BSHP<VecPt3d> GetPointsPtr() = 0;
+  virtual BSHP<const VecPt3d> GetPointsPtr() const = 0;
   /// \brief Get the generated triangles as a shared pointer.
   /// \return a vector of indices for the triangles.
   virtual BSHP<VecInt> GetTrianglesPtr() = 0;
@@ -70,13 +106,62 @@ public:
   /// \param[in] a_cellIdx The cell index.
   /// \return The point index of the cell centroid.
   virtual int GetCellCentroid(int a_cellIdx) const = 0;
+  /// \brief Get the operator that calculates UGrid point scalars from cell
+  ///        scalars, which depends only on the mesh and averaging mode. The
+  ///        operator is shared by everything using the triangles. Can be
+  ///        called from several threads at once.
+  /// \param[in] a_ugrid The UGrid the triangles were built for.
+  /// \param[in] a_useIdw Whether to use IDW rather than average.
+  /// \return The operator.
+  virtual BSHP<const XmCellToPointOperator> GetCellToPointOperator(const XmUGrid& a_ugrid,
+                                                                   bool a_useIdw) const = 0;
 
   /// \brief Get the cell index and interpolation values intersected by a point.
+  ///        Can be called from several threads at once.
   /// \param[in] a_point The point to intersect with the UGrid.
   /// \param[out] a_idxs The interpolation points.
   /// \param[out] a_weights The interpolation weights.
   /// \return The cell intersected by the point or -1 if outside of the UGrid.
-  virtual int GetIntersectedCell(const Pt3d& a_point, VecInt& a_idxs, VecDbl& a_weights) = 0;
+  virtual int GetIntersectedCell(const Pt3d& a_point,
+                                 VecInt& a_idxs,
+                                 VecDbl& a_weights) const = 0;
+  /// \brief Get the cell index and interpolation values intersected by a point
+  ///        ignoring triangles in inactive cells. The activity isn't stored
+  ///        so several extractors can share the triangles and search with
+  ///        their own activity from several threads at once.
+  /// \param[in] a_point The point to intersect with the UGrid.
+  /// \param[in] a_cellActivity The cell activity. Empty for all active.
+  /// \param[out] a_idxs The interpolation points.
+  /// \param[out] a_weights The interpolation weights.
+  /// \return The active cell intersected by the point or -1 if outside of the
+  ///         active cells.
+  virtual int GetIntersectedCell(const Pt3d& a_point,
+                                 const DynBitset& a_cellActivity,
+                                 VecInt& a_idxs,
+                                 VecDbl& a_weights) const = 0;
+  /// \brief Get the cell index and interpolation values intersected by a point
+  ///        checking a triangle expected to contain it, such as one found
+  ///        while traversing a polyline, before searching.
+  /// \param[in] a_point The point to intersect with the UGrid.
+  /// \param[in] a_triangleIdx The triangle to check first (index of the
+  ///            triangle, not of its first point) or -1 to search.
+  /// \param[in] a_cellActivity The cell activity. Empty for all active.
+  /// \param[out] a_idxs The interpolation points.
+  /// \param[out] a_weights The interpolation weights.
+  /// \return The active cell intersected by the point or -1 if outside of the
+  ///         active cells.
+  virtual int GetIntersectedCell(const Pt3d& a_point,
+                                 int a_triangleIdx,
+                                 const DynBitset& a_cellActivity,
+                                 VecInt& a_idxs,
+                                 VecDbl& a_weights) const = 0;
+  /// \brief Get the triangle of a cell that contains a point, such as a cell
+  ///        found while walking a polyline, to pass to GetIntersectedCell.
+  /// \param[in] a_cellIdx The cell.
+  /// \param[in] a_point The point.
+  /// \return The triangle (index of the triangle, not of its first point) or
+  ///         -1 if the point isn't in the cell.
+  virtual int GetCellTriangle(int a_cellIdx, const Pt3d& a_point) const = 0;
 
 protected:
   XmUGridTriangles2d();
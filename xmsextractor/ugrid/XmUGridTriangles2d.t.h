@@ -30,6 +30,24 @@ public:
   void testBuildEarcutTriangles();
   void testBuildCentroidAndEarcutTriangles();
   void testBuildCentroidAndEarcutTrianglesBottomFace();
+  void testBuildTrianglesParallel();
+  void testBuildEarcutTrianglesOnQuads();
+  void testBuildEarcutTrianglesLargePolygon();
+  void testSharedUGridPoints();
+  void testIntersectedCellWithActivity();
+  void testIntersectedCellWithTriangle();
+  void testCellTriangle();
+  void testWriteAndReadFile();
 }; // XmUGridTriangles2d
 
+////////////////////////////////////////////////////////////////////////////////
+class XmUGridTriangles2dIntermediateTests : public CxxTest::TestSuite
+{
+public:
+  void testBuildMidpointTrianglesLargeGrid();
+  void testBuildTrianglesLargePolygonModes();
+  void testBuildTrianglesRealData();
+  void testReadTrianglesFileLargeGrid();
+}; // XmUGridTriangles2dIntermediateTests
+
 #endif
@@ -13,6 +13,7 @@
 #include <xmsextractor/ugrid/XmUGridTriangulator.h>
 
 // 3. Standard library headers
+#include <algorithm>
 
 // 4. External library headers
 
@@ -59,14 +60,26 @@ public:
   virtual int GetCellCentroid(int a_cellIdx) const final;
   virtual void InitMidpoints() final;
   virtual int AddMidPoint(const int a_cellIdx, const int a_ptIdx0, const int a_ptIdx1) final;
+  virtual void Allocate(int a_numCentroids, int a_numTriangles) final;
+  virtual void SetCentroidPoint(const int a_cellIdx,
+                                const int a_pointIdx,
+                                const Pt3d& a_pt) final;
+  virtual void SetTriangle(const int a_triangleIdx,
+                           const int a_cellIdx,
+                           const int a_pt1,
+                           const int a_pt2,
+                           const int a_pt3) final;
 
 private:
   XmUGridTriangulatorImpl();
+  VecPt3d& GetWritablePoints(size_t a_numAdded);
+
   const XmUGrid& m_ugrid;
-  BSHP<VecPt3d> m_points;     ///< Triangle points for the UGrid
-  BSHP<VecInt> m_triangles;   ///< Triangles for the UGrid
-  VecInt m_centroidIdxs;      ///< Index of each cell centroid or -1 if none
-  VecInt m_triangleToCellIdx; ///< The cell index for each triangle
+  const VecPt3d& m_ugridPoints; ///< UGrid locations, the points until any are added
+  BSHP<VecPt3d> m_points;       ///< Triangle points once any are added, else null
+  BSHP<VecInt> m_triangles;     ///< Triangles for the UGrid
+  VecInt m_centroidIdxs;        ///< Index of each cell centroid or -1 if none
+  VecInt m_triangleToCellIdx;   ///< The cell index for each triangle
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -79,13 +92,32 @@ private:
 //------------------------------------------------------------------------------
 XmUGridTriangulatorImpl::XmUGridTriangulatorImpl(const XmUGrid& a_ugrid)
 : m_ugrid(a_ugrid)
-, m_points(new VecPt3d(a_ugrid.GetLocations()))
+, m_ugridPoints(a_ugrid.GetLocations())
+, m_points()
 , m_triangles(new VecInt)
 , m_centroidIdxs(a_ugrid.GetCellCount(), -1)
 , m_triangleToCellIdx()
 {
 } // XmUGridTriangulatorImpl::XmUGridTriangulatorImpl
 //------------------------------------------------------------------------------
+/// \brief Get the points to add centroids or midpoints to. The UGrid
+///        locations are used until the first point is added and are then
+///        copied so that the triangle points stay in one vector. The UGrid
+///        locations are never modified.
+/// \param[in] a_numAdded The number of points about to be added.
+/// \return The triangle points.
+//------------------------------------------------------------------------------
+VecPt3d& XmUGridTriangulatorImpl::GetWritablePoints(size_t a_numAdded)
+{
+  if (!m_points)
+  {
+    m_points.reset(new VecPt3d);
+    m_points->reserve(m_ugridPoints.size() + a_numAdded);
+    m_points->assign(m_ugridPoints.begin(), m_ugridPoints.end());
+  }
+  return *m_points;
+} // XmUGridTriangulatorImpl::GetWritablePoints
+//------------------------------------------------------------------------------
 /// \brief Add a cell point (for the cell centroid).
 /// \param a_cellIdx The cell index for the centroid point
 /// \param a_point The centroid point
@@ -93,8 +125,9 @@ XmUGridTriangulatorImpl::XmUGridTriangulatorImpl(const XmUGrid& a_ugrid)
 //------------------------------------------------------------------------------
 int XmUGridTriangulatorImpl::AddCentroidPoint(const int a_cellIdx, const Pt3d& a_point)
 {
-  int centroidIdx = (int)m_points->size();
-  m_points->push_back(a_point);
+  VecPt3d& points = GetWritablePoints(1);
+  int centroidIdx = (int)points.size();
+  points.push_back(a_point);
   m_centroidIdxs[a_cellIdx] = centroidIdx;
   return centroidIdx;
 } // XmUGridTriangulatorImpl::AddCentroidPoint
@@ -132,20 +165,32 @@ int XmUGridTriangulatorImpl::GetCellCentroid(int a_cellIdx) const
 //------------------------------------------------------------------------------
 void XmUGridTriangulatorImpl::InitMidpoints()
 {
-  BSHP<FlatMapEdgeMidpointInfo> midPoints(new FlatMapEdgeMidpointInfo());
+  // collect each edge from its lower point then sort them so the map can
+  // adopt them without shifting its storage for every insert
+  typedef std::pair<XmElementEdge, XmElementMidpointInfo> EdgeMidpoint;
+  std::vector<EdgeMidpoint> edges;
+  XmElementMidpointInfo info = {-1, -1};
   VecInt attachedPts;
-  int numPts = (int)m_points->size();
+  int numPts = (int)GetPoints().size();
   for (int ii = 0; ii < numPts; ++ii)
   {
     m_ugrid.GetPointAdjacentPoints(ii, attachedPts);
-    if (!attachedPts.empty())
+    for (auto&& ptIdx : attachedPts)
     {
-      XmElementMidpointInfo info = {-1, -1};
-      for (auto&& ptIdx : attachedPts)
-        midPoints->insert(midPoints->end(), std::pair<XmElementEdge, XmElementMidpointInfo>(
-                                              XmElementEdge(ii, ptIdx), info));
+      if (ptIdx > ii)
+        edges.push_back(EdgeMidpoint(XmElementEdge(ii, ptIdx), info));
     }
   }
+  std::sort(edges.begin(), edges.end(), [](const EdgeMidpoint& a_lhs, const EdgeMidpoint& a_rhs) {
+    return a_lhs.first < a_rhs.first;
+  });
+  auto last = std::unique(edges.begin(), edges.end(),
+                          [](const EdgeMidpoint& a_lhs, const EdgeMidpoint& a_rhs) {
+                            return a_lhs.first.GetPair() == a_rhs.first.GetPair();
+                          });
+
+  BSHP<FlatMapEdgeMidpointInfo> midPoints(new FlatMapEdgeMidpointInfo(
+    boost::container::ordered_unique_range, edges.begin(), last));
   SetMidpoints(midPoints);
 } // XmUGridTriangulatorImpl::InitMidpoints
 //------------------------------------------------------------------------------
@@ -165,22 +210,71 @@ int XmUGridTriangulatorImpl::AddMidPoint(const int a_cellIdx,
   auto&& idMid = info.midPtId;
   if (idMid < 0)
   {
-    Pt3d p0 = m_points->at(a_ptIdx0);
-    Pt3d p1 = m_points->at(a_ptIdx1);
+    VecPt3d& points = GetWritablePoints(1);
+    Pt3d p0 = points.at(a_ptIdx0);
+    Pt3d p1 = points.at(a_ptIdx1);
     double midPt[3] = {(p0[0] + p1[0]) / 2.0, (p0[1] + p1[1]) / 2.0, (p0[2] + p1[2]) / 2.0};
     cellMid = a_cellIdx;
-    idMid = (long)m_points->size();
-    m_points->emplace_back(midPt[0], midPt[1], midPt[2]);
+    idMid = (long)points.size();
+    points.emplace_back(midPt[0], midPt[1], midPt[2]);
   }
   return (int)idMid;
 } // XmUGridTriangulatorImpl::AddMidPoint
 //------------------------------------------------------------------------------
+/// \brief Size the points and triangles for a known number of centroids and
+///        triangles so they can be filled in with SetCentroidPoint and
+///        SetTriangle. Different slots can be set from several threads at once.
+/// \param[in] a_numCentroids The number of centroid points to add after the
+///            UGrid points.
+/// \param[in] a_numTriangles The number of triangles.
+//------------------------------------------------------------------------------
+void XmUGridTriangulatorImpl::Allocate(int a_numCentroids, int a_numTriangles)
+{
+  if (a_numCentroids > 0)
+    GetWritablePoints(a_numCentroids).resize(m_ugrid.GetPointCount() + a_numCentroids);
+  m_triangles->resize(3 * a_numTriangles);
+  m_triangleToCellIdx.resize(a_numTriangles);
+} // XmUGridTriangulatorImpl::Allocate
+//------------------------------------------------------------------------------
+/// \brief Set a previously allocated cell centroid point.
+/// \param[in] a_cellIdx The cell index for the centroid point
+/// \param[in] a_pointIdx The index of the point to set
+/// \param[in] a_pt The centroid point
+//------------------------------------------------------------------------------
+void XmUGridTriangulatorImpl::SetCentroidPoint(const int a_cellIdx,
+                                               const int a_pointIdx,
+                                               const Pt3d& a_pt)
+{
+  GetWritablePoints(0)[a_pointIdx] = a_pt;
+  m_centroidIdxs[a_cellIdx] = a_pointIdx;
+} // XmUGridTriangulatorImpl::SetCentroidPoint
+//------------------------------------------------------------------------------
+/// \brief Set a previously allocated triangle.
+/// \param[in] a_triangleIdx The index of the triangle to set
+/// \param[in] a_cellIdx The cell index the triangle is from
+/// \param[in] a_idx1 The first triangle point index (counter clockwise)
+/// \param[in] a_idx2 The second triangle point index (counter clockwise)
+/// \param[in] a_idx3 The third triangle point index (counter clockwise)
+//------------------------------------------------------------------------------
+void XmUGridTriangulatorImpl::SetTriangle(const int a_triangleIdx,
+                                          const int a_cellIdx,
+                                          const int a_idx1,
+                                          const int a_idx2,
+                                          const int a_idx3)
+{
+  int* triangle = &(*m_triangles)[3 * a_triangleIdx];
+  triangle[0] = a_idx1;
+  triangle[1] = a_idx2;
+  triangle[2] = a_idx3;
+  m_triangleToCellIdx[a_triangleIdx] = a_cellIdx;
+} // XmUGridTriangulatorImpl::SetTriangle
+//------------------------------------------------------------------------------
 /// \brief Get the generated triangle points.
 /// \return The triangle points
 //------------------------------------------------------------------------------
 const VecPt3d& XmUGridTriangulatorImpl::GetPoints() const
 {
-  return *m_points;
+  return m_points ? *m_points : m_ugridPoints;
 } // XmUGridTriangulatorImpl::GetPoints
 //------------------------------------------------------------------------------
 /// \brief Get the generated triangles.
@@ -192,7 +286,8 @@ const VecInt& XmUGridTriangulatorImpl::GetTriangles() const
 } // XmUGridTriangulatorImpl::GetTriangles
 //------------------------------------------------------------------------------
 /// \brief Get the generated triangle points as a shared pointer.
-/// \return The triangle points
+/// \return The triangle points or null if no points were added, in which
+///         case the points are the UGrid locations returned by GetPoints.
 //------------------------------------------------------------------------------
 BSHP<VecPt3d> XmUGridTriangulatorImpl::GetPointsPtr()
 {
@@ -52,6 +52,13 @@ public:
   virtual int GetCellCentroid(int a_cellIdx) const = 0;
   virtual void InitMidpoints() = 0;
   virtual int AddMidPoint(const int a_cellIdx, const int a_ptIdx0, const int a_ptIdx1) = 0;
+  virtual void Allocate(int a_numCentroids, int a_numTriangles) = 0;
+  virtual void SetCentroidPoint(const int a_cellIdx, const int a_pointIdx, const Pt3d& a_pt) = 0;
+  virtual void SetTriangle(const int a_triangleIdx,
+                           const int a_cellIdx,
+                           const int a_pt1,
+                           const int a_pt2,
+                           const int a_pt3) = 0;
 
 protected:
   XmUGridTriangulator();
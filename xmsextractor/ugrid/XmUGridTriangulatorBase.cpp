@@ -13,10 +13,14 @@
 #include <xmsextractor/ugrid/XmUGridTriangulatorBase.h>
 
 // 3. Standard library headers
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <set>
 #include <sstream>
 
 // 4. External library headers
-#include <boost/container/flat_map.hpp>
 
 // 5. Shared code headers
 #include <xmscore/misc/XmLog.h>   // XM_LOG
@@ -45,11 +49,7 @@ namespace xms
 
 namespace
 {
-typedef std::tuple<int, int, int> Triangle; ///< three consecutive polygon points for triangle
-typedef boost::container::flat_map<Triangle, double>
-  TriDoubleCache; ///< ratio cache to speed up earcut calculation
-typedef boost::container::flat_map<Triangle, bool>
-  TriBoolCache; ///< valid cache to speed up earcut calculation
+std::mutex g_logMutex; ///< serializes logging from cells triangulated in parallel
 
 //------------------------------------------------------------------------------
 /// \brief Calculate the magnitude of a vector.
@@ -80,170 +80,433 @@ void iFindArea2(const Pt3d& v1,
 //------------------------------------------------------------------------------
 /// \brief Calculate a quality ratio to use to determine which triangles to cut
 ///        using earcut triangulation. Better triangles have a lower ratio.
-/// \param[in] a_points: the array the points come from
-/// \param[in] a_idx1: first point of first edge
-/// \param[in] a_idx2: second point of first edge, first point of second edge
-/// \param[in] a_idx2: second point of second edge
+/// \param[in] a_v1: vector from the second point to the first point
+/// \param[in] a_v2: vector from the second point to the third point
+/// \param[in] a_v3: vector from the first point to the third point
+/// \param[in] a_area2: the triangle area times 2
+/// \param[in] a_crossZ: the cross product Z value of a_v2 and a_v1
 /// \param[in] a_topFace: is this a top face or a bottom face
-/// \param[out] a_areaCache: The ratio cache
-/// \param[out] a_crossZCache: The ratio cache
-/// \param[out] a_ratioCache: The ratio cache
 /// \return The ratio, -1.0 for an inverted triangle, or -2.0 for a zero area
 ///         triangle
 //------------------------------------------------------------------------------
-double iGetEarcutTriangleRatio(const VecPt3d& a_points,
-                               int a_idx1,
-                               int a_idx2,
-                               int a_idx3,
-                               bool a_topFace,
-                               TriDoubleCache& a_areaCache,
-                               TriDoubleCache& a_crossZCache,
-                               TriDoubleCache& a_ratioCache)
+double iEarcutTriangleRatio(const Pt3d& a_v1,
+                            const Pt3d& a_v2,
+                            const Pt3d& a_v3,
+                            double a_area2,
+                            double a_crossZ,
+                            bool a_topFace)
 {
-  Triangle triangle(a_idx1, a_idx2, a_idx3);
-  auto foundRatio = a_ratioCache.find(triangle);
-  if (foundRatio != a_ratioCache.end())
-    return foundRatio->second;
-
-  const Pt3d& pt1 = a_points[a_idx1];
-  const Pt3d& pt2 = a_points[a_idx2];
-  const Pt3d& pt3 = a_points[a_idx3];
-  Pt3d v1 = pt1 - pt2;
-  Pt3d v2 = pt3 - pt2;
-  Pt3d v3 = pt3 - pt1;
-  double area2;
-  double crossZ;
-
-  auto foundArea = a_areaCache.find(triangle);
-  auto foundCrossZ = a_crossZCache.find(triangle);
-  if (foundArea == a_areaCache.end() || foundCrossZ == a_crossZCache.end())
-  {
-    iFindArea2(v1, v2, area2, crossZ);
-    a_areaCache[triangle] = area2;
-    a_crossZCache[triangle] = crossZ;
-  }
-  else
-  {
-    area2 = foundArea->second;
-    crossZ = foundCrossZ->second;
-  }
-
   double ratio;
-  if ((a_topFace && crossZ <= 0.0) || (!a_topFace && crossZ >= 0.0))
+  if ((a_topFace && a_crossZ <= 0.0) || (!a_topFace && a_crossZ >= 0.0))
   {
     // inverted
     ratio = -1.0;
   }
   else
   {
-    if (area2 == 0.0)
+    if (a_area2 == 0.0)
     {
       // degenerate triangle
       ratio = -2.0;
     }
     else
     {
-      double perimeter = iMagnitude(v1) + iMagnitude(v2) + iMagnitude(v3);
-      ratio = perimeter * perimeter / area2;
+      double perimeter = iMagnitude(a_v1) + iMagnitude(a_v2) + iMagnitude(a_v3);
+      ratio = perimeter * perimeter / a_area2;
     }
   }
-
-  a_ratioCache[triangle] = ratio;
   return ratio;
-} // iGetEarcutTriangleRatio
-//------------------------------------------------------------------------------
-/// \brief Is this a valid triangle?
-/// \param a_points The points
-/// \param a_polygon The triangle polygon
-/// \param a_idx1 First triangle point
-/// \param a_idx2 Second triangle point
-/// \param a_idx3 Third triangle point
+} // iEarcutTriangleRatio
+//------------------------------------------------------------------------------
+/// \brief Is a point inside of an ear triangle?
+/// \param a_pt1 First triangle point
+/// \param a_pt2 Second triangle point
+/// \param a_pt3 Third triangle point
+/// \param a_pt The point to check
 /// \param[in] a_topFace Is this a top face or a bottom face
-/// \param a_validCache Cache of valid triangles
-/// \return
-//------------------------------------------------------------------------------
-bool iValidTriangle(const VecPt3d& a_points,
-                    const VecInt& a_polygon,
-                    int a_idx1,
-                    int a_idx2,
-                    int a_idx3,
-                    bool a_topFace,
-                    TriBoolCache& a_validCache)
+/// \return True if the point is inside of the triangle.
+//------------------------------------------------------------------------------
+bool iPointInEar(const Pt3d& a_pt1,
+                 const Pt3d& a_pt2,
+                 const Pt3d& a_pt3,
+                 const Pt3d& a_pt,
+                 bool a_topFace)
 {
-  Triangle triangle(a_idx1, a_idx2, a_idx3);
-  auto validIter = a_validCache.find(triangle);
-  if (validIter != a_validCache.end())
-    return validIter->second;
-
-  const Pt3d& pt1 = a_points[a_idx1];
-  const Pt3d& pt2 = a_points[a_idx2];
-  const Pt3d& pt3 = a_points[a_idx3];
-  for (int pointIndex : a_polygon)
+  if (a_topFace)
   {
-    if (pointIndex != a_idx1 && pointIndex != a_idx2 && pointIndex != a_idx3)
+    return gmTurn(a_pt1, a_pt2, a_pt, 0.0) == TURN_LEFT &&
+           gmTurn(a_pt2, a_pt3, a_pt) == TURN_LEFT && gmTurn(a_pt3, a_pt1, a_pt, 0.0) == TURN_LEFT;
+  }
+  return gmTurn(a_pt1, a_pt2, a_pt, 0.0) == TURN_RIGHT &&
+         gmTurn(a_pt2, a_pt3, a_pt) == TURN_RIGHT && gmTurn(a_pt3, a_pt1, a_pt, 0.0) == TURN_RIGHT;
+} // iPointInEar
+//------------------------------------------------------------------------------
+/// \brief Find the ear to cut off of a quad. Chooses the same ear as the
+///        general earcut loop without building the triangle caches.
+/// \param[in] a_points The points
+/// \param[in] a_quadIdxs The four cell point indices
+/// \return The position in a_quadIdxs of the ear to cut or -1 if there is no
+///         valid ear.
+//------------------------------------------------------------------------------
+int iFindQuadEar(const VecPt3d& a_points, const VecInt& a_quadIdxs)
+{
+  double area2[4];
+  double crossZ[4];
+  double area2Sum = 0.0;
+  for (int pointIdx = 0; pointIdx < 4; ++pointIdx)
+  {
+    const Pt3d& pt1 = a_points[a_quadIdxs[(pointIdx + 3) % 4]];
+    const Pt3d& pt2 = a_points[a_quadIdxs[pointIdx]];
+    const Pt3d& pt3 = a_points[a_quadIdxs[(pointIdx + 1) % 4]];
+    iFindArea2(pt1 - pt2, pt3 - pt2, area2[pointIdx], crossZ[pointIdx]);
+    if (crossZ[pointIdx] > 0.0)
+      area2Sum += area2[pointIdx];
+    else
+      area2Sum -= area2[pointIdx];
+  }
+  bool topFace = area2Sum > 0.0;
+
+  int bestIdx = -1;
+  int secondBestIdx = -1;
+  double bestRatio = std::numeric_limits<double>::max();
+  double secondBestRatio = std::numeric_limits<double>::max();
+  for (int pointIdx = 0; pointIdx < 4; ++pointIdx)
+  {
+    int idx1 = a_quadIdxs[(pointIdx + 3) % 4];
+    int idx2 = a_quadIdxs[pointIdx];
+    int idx3 = a_quadIdxs[(pointIdx + 1) % 4];
+    int idx4 = a_quadIdxs[(pointIdx + 2) % 4];
+    const Pt3d& pt1 = a_points[idx1];
+    const Pt3d& pt2 = a_points[idx2];
+    const Pt3d& pt3 = a_points[idx3];
+    double ratio = iEarcutTriangleRatio(pt1 - pt2, pt3 - pt2, pt3 - pt1, area2[pointIdx],
+                                        crossZ[pointIdx], topFace);
+    if (ratio <= 0.0)
+      continue;
+    if (idx4 != idx1 && idx4 != idx2 && idx4 != idx3 &&
+        iPointInEar(pt1, pt2, pt3, a_points[idx4], topFace))
+      continue;
+
+    if (ratio < bestRatio)
     {
-      const Pt3d& pt = a_points[pointIndex];
-      if (a_topFace)
-      {
-        if (gmTurn(pt1, pt2, pt, 0.0) == TURN_LEFT &&
-            gmTurn(pt2, pt3, pt) == TURN_LEFT &&
-            gmTurn(pt3, pt1, pt, 0.0) == TURN_LEFT)
-        {
-          a_validCache[triangle] = false;
-          return false;
-        }
-      }
-      else if (gmTurn(pt1, pt2, pt, 0.0) == TURN_RIGHT &&
-               gmTurn(pt2, pt3, pt) == TURN_RIGHT &&
-               gmTurn(pt3, pt1, pt, 0.0) == TURN_RIGHT)
-      {
-        a_validCache[triangle] = false;
-        return false;
-      }
+      secondBestRatio = bestRatio;
+      bestRatio = ratio;
+      secondBestIdx = bestIdx;
+      bestIdx = pointIdx;
+    }
+    else if (ratio < secondBestRatio)
+    {
+      secondBestRatio = ratio;
+      secondBestIdx = pointIdx;
     }
   }
 
-  a_validCache[triangle] = true;
-  return true;
-} // iValidTriangle
-//------------------------------------------------------------------------------
-/// \brief Determine if cell polygon is for a top or bottom face.
-/// \param polygonIdxs The cell point indices
-/// \param points The points
-/// \param areaCache The area cache
-/// \param crossZCache The cross Z cache
-/// \return True if the cell points are counter-clock-wise.
-//------------------------------------------------------------------------------
-bool iIsTopFace(const VecInt& polygonIdxs,
-                const VecPt3d& points,
-                TriDoubleCache& areaCache,
-                TriDoubleCache& crossZCache)
+  if (secondBestIdx >= 0)
+    bestIdx = secondBestIdx;
+  return bestIdx;
+} // iFindQuadEar
+//------------------------------------------------------------------------------
+/// \brief Is a triangle or quad strictly convex? A strictly convex cell always
+///        contains its centroid.
+/// \param[in] a_polygon The cell points.
+/// \return True if the polygon has three or four points that all turn the same
+///         way.
+//------------------------------------------------------------------------------
+bool iIsConvexTriangleOrQuad(const VecPt3d& a_polygon)
+{
+  size_t numPoints = a_polygon.size();
+  if (numPoints != 3 && numPoints != 4)
+    return false;
+
+  int numLeft = 0;
+  int numRight = 0;
+  for (size_t pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+  {
+    const Pt3d& pt1 = a_polygon[(pointIdx + numPoints - 1) % numPoints];
+    const Pt3d& pt2 = a_polygon[pointIdx];
+    const Pt3d& pt3 = a_polygon[(pointIdx + 1) % numPoints];
+    double crossZ = (pt2.x - pt1.x) * (pt3.y - pt2.y) - (pt2.y - pt1.y) * (pt3.x - pt2.x);
+    if (crossZ > 0.0)
+      ++numLeft;
+    else if (crossZ < 0.0)
+      ++numRight;
+  }
+  return numLeft == (int)numPoints || numRight == (int)numPoints;
+} // iIsConvexTriangleOrQuad
+//------------------------------------------------------------------------------
+/// \brief Log that a cell couldn't be split into triangles.
+/// \param[in] a_cellIdx The cell index.
+//------------------------------------------------------------------------------
+void iLogSplitError(int a_cellIdx)
+{
+  std::ostringstream ss;
+  ss << "Unable to split cell number " << a_cellIdx + 1 << " into triangles.";
+  std::lock_guard<std::mutex> lock(g_logMutex);
+  XM_LOG(xmlog::error, ss.str());
+} // iLogSplitError
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class XmEarClipper
+/// \brief Ear clipping triangulation of a polygon stored as a doubly linked
+///        list. Keeps the valid ears ordered by quality so each ear is found in
+///        logarithmic time, and only the two neighbors of a clipped ear are
+///        updated. Points that could be inside of an ear are found using a
+///        uniform grid of the polygon points.
+////////////////////////////////////////////////////////////////////////////////
+class XmEarClipper
+{
+public:
+  XmEarClipper(const VecPt3d& a_points, const VecInt& a_polygonIdxs);
+
+  /// \brief Get the number of points left in the polygon.
+  /// \return The number of points.
+  int GetNumPoints() const { return m_numPoints; }
+  bool ClipEar(int& a_idx1, int& a_idx2, int& a_idx3);
+  void GetLastTriangle(int& a_idx1, int& a_idx2, int& a_idx3) const;
+
+private:
+  void BuildGrid();
+  void UpdateEar(int a_node);
+  bool IsValidEar(int a_node) const;
+
+  const VecPt3d& m_points;           ///< the points the polygon indices refer to
+  const VecInt& m_idxs;              ///< point index of each polygon node
+  VecInt m_prev;                     ///< previous node of each node
+  VecInt m_next;                     ///< next node of each node
+  std::vector<char> m_removed;       ///< has the node been clipped
+  VecDbl m_ratios;                   ///< ear quality ratio of each node
+  std::vector<char> m_isEar;         ///< is the node in m_ears
+  std::set<std::pair<double, int>> m_ears; ///< valid ears by ratio then node
+  int m_numPoints;                   ///< number of nodes left in the polygon
+  bool m_topFace;                    ///< is the polygon counter clockwise
+  double m_gridMinX;                 ///< minimum x of the point grid
+  double m_gridMinY;                 ///< minimum y of the point grid
+  double m_gridCellSize;             ///< size of each point grid cell
+  int m_gridCols;                    ///< number of point grid columns
+  int m_gridRows;                    ///< number of point grid rows
+  VecInt m_gridStarts;               ///< start of each grid cell in m_gridNodes
+  VecInt m_gridNodes;                ///< nodes in each grid cell
+};
+//------------------------------------------------------------------------------
+/// \brief Constructor. Finds the polygon orientation and its initial ears.
+/// \param[in] a_points The points the polygon indices refer to.
+/// \param[in] a_polygonIdxs The polygon point indices (at least three).
+//------------------------------------------------------------------------------
+XmEarClipper::XmEarClipper(const VecPt3d& a_points, const VecInt& a_polygonIdxs)
+: m_points(a_points)
+, m_idxs(a_polygonIdxs)
+, m_prev(a_polygonIdxs.size())
+, m_next(a_polygonIdxs.size())
+, m_removed(a_polygonIdxs.size(), 0)
+, m_ratios(a_polygonIdxs.size(), -1.0)
+, m_isEar(a_polygonIdxs.size(), 0)
+, m_ears()
+, m_numPoints((int)a_polygonIdxs.size())
+, m_topFace(false)
+, m_gridMinX(0.0)
+, m_gridMinY(0.0)
+, m_gridCellSize(1.0)
+, m_gridCols(1)
+, m_gridRows(1)
+, m_gridStarts()
+, m_gridNodes()
 {
   double area2Sum = 0.0;
-  int numPoints = (int)polygonIdxs.size();
-  for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+  for (int node = 0; node < m_numPoints; ++node)
   {
-    int idx1 = polygonIdxs[(pointIdx + numPoints - 1) % numPoints];
-    int idx2 = polygonIdxs[pointIdx];
-    int idx3 = polygonIdxs[(pointIdx + 1) % numPoints];
-    const Pt3d& pt1 = points[idx1];
-    const Pt3d& pt2 = points[idx2];
-    const Pt3d& pt3 = points[idx3];
-    Pt3d v1 = pt1 - pt2;
-    Pt3d v2 = pt3 - pt2;
+    m_prev[node] = (node + m_numPoints - 1) % m_numPoints;
+    m_next[node] = (node + 1) % m_numPoints;
+    const Pt3d& pt1 = m_points[m_idxs[m_prev[node]]];
+    const Pt3d& pt2 = m_points[m_idxs[node]];
+    const Pt3d& pt3 = m_points[m_idxs[m_next[node]]];
     double area2, crossZ;
-    iFindArea2(v1, v2, area2, crossZ);
+    iFindArea2(pt1 - pt2, pt3 - pt2, area2, crossZ);
     if (crossZ > 0.0)
       area2Sum += area2;
     else
       area2Sum -= area2;
-    Triangle triangle(idx1, idx2, idx3);
-    areaCache[triangle] = area2;
-    crossZCache[triangle] = crossZ;
   }
-  bool topFace = area2Sum > 0.0;
-  return topFace;
-} // iIsTopFace
+  m_topFace = area2Sum > 0.0;
+
+  BuildGrid();
+  for (int node = 0; node < m_numPoints; ++node)
+    UpdateEar(node);
+} // XmEarClipper::XmEarClipper
+//------------------------------------------------------------------------------
+/// \brief Cut the best ear off of the polygon. Ties go to the earliest polygon
+///        point, and when four points are left the second best ear is cut.
+/// \param[out] a_idx1 The first ear triangle point index.
+/// \param[out] a_idx2 The second ear triangle point index.
+/// \param[out] a_idx3 The third ear triangle point index.
+/// \return False if the polygon has no valid ear.
+//------------------------------------------------------------------------------
+bool XmEarClipper::ClipEar(int& a_idx1, int& a_idx2, int& a_idx3)
+{
+  if (m_ears.empty())
+    return false;
+
+  auto ear = m_ears.begin();
+  if (m_numPoints == 4 && m_ears.size() > 1)
+    ++ear;
+  int node = ear->second;
+  int prev = m_prev[node];
+  int next = m_next[node];
+  a_idx1 = m_idxs[prev];
+  a_idx2 = m_idxs[node];
+  a_idx3 = m_idxs[next];
+
+  m_ears.erase(ear);
+  m_isEar[node] = 0;
+  m_removed[node] = 1;
+  m_next[prev] = next;
+  m_prev[next] = prev;
+  --m_numPoints;
+
+  UpdateEar(prev);
+  UpdateEar(next);
+  return true;
+} // XmEarClipper::ClipEar
+//------------------------------------------------------------------------------
+/// \brief Get the triangle left after cutting ears down to three points. The
+///        points are in their original polygon order.
+/// \param[out] a_idx1 The first triangle point index.
+/// \param[out] a_idx2 The second triangle point index.
+/// \param[out] a_idx3 The third triangle point index.
+//------------------------------------------------------------------------------
+void XmEarClipper::GetLastTriangle(int& a_idx1, int& a_idx2, int& a_idx3) const
+{
+  int first = 0;
+  while (m_removed[first])
+    ++first;
+  a_idx1 = m_idxs[first];
+  a_idx2 = m_idxs[m_next[first]];
+  a_idx3 = m_idxs[m_next[m_next[first]]];
+} // XmEarClipper::GetLastTriangle
+//------------------------------------------------------------------------------
+/// \brief Bucket the polygon nodes into a uniform grid with about one node per
+///        grid cell.
+//------------------------------------------------------------------------------
+void XmEarClipper::BuildGrid()
+{
+  double maxX = -std::numeric_limits<double>::max();
+  double maxY = -std::numeric_limits<double>::max();
+  m_gridMinX = std::numeric_limits<double>::max();
+  m_gridMinY = std::numeric_limits<double>::max();
+  for (int idx : m_idxs)
+  {
+    const Pt3d& pt = m_points[idx];
+    m_gridMinX = std::min(m_gridMinX, pt.x);
+    m_gridMinY = std::min(m_gridMinY, pt.y);
+    maxX = std::max(maxX, pt.x);
+    maxY = std::max(maxY, pt.y);
+  }
+
+  double width = maxX - m_gridMinX;
+  double height = maxY - m_gridMinY;
+  double numNodes = (double)m_idxs.size();
+  if (width > 0.0 && height > 0.0)
+    m_gridCellSize = std::sqrt(width * height / numNodes);
+  else
+    m_gridCellSize = std::max(width, height) / numNodes;
+  if (m_gridCellSize > 0.0 && std::isfinite(m_gridCellSize))
+  {
+    m_gridCols = (int)std::min(numNodes, width / m_gridCellSize) + 1;
+    m_gridRows = (int)std::min(numNodes, height / m_gridCellSize) + 1;
+  }
+  else
+  {
+    m_gridCellSize = 1.0;
+    m_gridCols = 1;
+    m_gridRows = 1;
+  }
+
+  // count the nodes in each grid cell then fill them in
+  VecInt nodeCells(m_idxs.size());
+  m_gridStarts.assign(m_gridCols * m_gridRows + 1, 0);
+  for (size_t node = 0; node < m_idxs.size(); ++node)
+  {
+    const Pt3d& pt = m_points[m_idxs[node]];
+    int col = std::min(m_gridCols - 1, std::max(0, (int)((pt.x - m_gridMinX) / m_gridCellSize)));
+    int row = std::min(m_gridRows - 1, std::max(0, (int)((pt.y - m_gridMinY) / m_gridCellSize)));
+    nodeCells[node] = row * m_gridCols + col;
+    ++m_gridStarts[nodeCells[node] + 1];
+  }
+  for (size_t cell = 1; cell < m_gridStarts.size(); ++cell)
+    m_gridStarts[cell] += m_gridStarts[cell - 1];
+  m_gridNodes.resize(m_idxs.size());
+  VecInt cellFill(m_gridStarts.begin(), m_gridStarts.end() - 1);
+  for (size_t node = 0; node < m_idxs.size(); ++node)
+    m_gridNodes[cellFill[nodeCells[node]]++] = (int)node;
+} // XmEarClipper::BuildGrid
+//------------------------------------------------------------------------------
+/// \brief Compute the ear ratio and validity of a node and add it to or remove
+///        it from the ears.
+/// \param[in] a_node The polygon node.
+//------------------------------------------------------------------------------
+void XmEarClipper::UpdateEar(int a_node)
+{
+  if (m_isEar[a_node])
+  {
+    m_ears.erase(std::make_pair(m_ratios[a_node], a_node));
+    m_isEar[a_node] = 0;
+  }
+
+  const Pt3d& pt1 = m_points[m_idxs[m_prev[a_node]]];
+  const Pt3d& pt2 = m_points[m_idxs[a_node]];
+  const Pt3d& pt3 = m_points[m_idxs[m_next[a_node]]];
+  Pt3d v1 = pt1 - pt2;
+  Pt3d v2 = pt3 - pt2;
+  double area2, crossZ;
+  iFindArea2(v1, v2, area2, crossZ);
+  m_ratios[a_node] = iEarcutTriangleRatio(v1, v2, pt3 - pt1, area2, crossZ, m_topFace);
+  double ratio = m_ratios[a_node];
+  if (ratio > 0.0 && ratio < std::numeric_limits<double>::max() && IsValidEar(a_node))
+  {
+    m_ears.insert(std::make_pair(m_ratios[a_node], a_node));
+    m_isEar[a_node] = 1;
+  }
+} // XmEarClipper::UpdateEar
+//------------------------------------------------------------------------------
+/// \brief Make sure no other polygon point is inside of the ear triangle.
+/// \param[in] a_node The polygon node at the tip of the ear.
+/// \return True if the ear is valid.
+//------------------------------------------------------------------------------
+bool XmEarClipper::IsValidEar(int a_node) const
+{
+  int idx1 = m_idxs[m_prev[a_node]];
+  int idx2 = m_idxs[a_node];
+  int idx3 = m_idxs[m_next[a_node]];
+  const Pt3d& pt1 = m_points[idx1];
+  const Pt3d& pt2 = m_points[idx2];
+  const Pt3d& pt3 = m_points[idx3];
+
+  // a point inside of the triangle is inside of its bounding box
+  double minX = std::min({pt1.x, pt2.x, pt3.x});
+  double maxX = std::max({pt1.x, pt2.x, pt3.x});
+  double minY = std::min({pt1.y, pt2.y, pt3.y});
+  double maxY = std::max({pt1.y, pt2.y, pt3.y});
+  int minCol = std::max(0, (int)((minX - m_gridMinX) / m_gridCellSize));
+  int maxCol = std::min(m_gridCols - 1, (int)((maxX - m_gridMinX) / m_gridCellSize));
+  int minRow = std::max(0, (int)((minY - m_gridMinY) / m_gridCellSize));
+  int maxRow = std::min(m_gridRows - 1, (int)((maxY - m_gridMinY) / m_gridCellSize));
+  for (int row = minRow; row <= maxRow; ++row)
+  {
+    for (int col = minCol; col <= maxCol; ++col)
+    {
+      int cell = row * m_gridCols + col;
+      for (int i = m_gridStarts[cell]; i < m_gridStarts[cell + 1]; ++i)
+      {
+        int node = m_gridNodes[i];
+        int pointIdx = m_idxs[node];
+        if (m_removed[node] || pointIdx == idx1 || pointIdx == idx2 || pointIdx == idx3)
+          continue;
+        if (iPointInEar(pt1, pt2, pt3, m_points[pointIdx], m_topFace))
+          return false;
+      }
+    }
+  }
+  return true;
+} // XmEarClipper::IsValidEar
 } // namespace
 
 class XmUGridTriangulatorBase::impl
@@ -252,6 +515,7 @@ public:
   impl();
   virtual ~impl() = default;
   BSHP<FlatMapEdgeMidpointInfo> m_midPoints;
+  VecPt3d m_polygon; ///< cell polygon reused for each centroid cell
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -264,6 +528,7 @@ public:
 //------------------------------------------------------------------------------
 XmUGridTriangulatorBase::impl::impl()
 : m_midPoints(nullptr)
+, m_polygon()
 {
 } // XmUGridTriangulatorBase::impl::impl
 ////////////////////////////////////////////////////////////////////////////////
@@ -313,78 +578,55 @@ XmElementMidpointInfo& XmUGridTriangulatorBase::FindMidPoint(const XmElementEdge
 //------------------------------------------------------------------------------
 void XmUGridTriangulatorBase::BuildEarcutTriangles(int a_cellIdx, const VecInt& a_cellPointIdxs)
 {
-  VecInt polygonIdxs = a_cellPointIdxs;
   const VecPt3d& points = GetPoints();
-
-  TriDoubleCache areaCache;
-  TriDoubleCache crossZCache;
-  bool topFace = iIsTopFace(polygonIdxs, points, areaCache, crossZCache);
-
-  // continually find best triangle on adjacent edges and cut it off polygon
-  TriDoubleCache ratioCache;
-  TriBoolCache validCache;
-  while (polygonIdxs.size() >= 4)
+  if (a_cellPointIdxs.size() == 3)
   {
-    int bestIdx = -1;
-    int secondBestIdx = -1;
-    double bestRatio = std::numeric_limits<double>::max();
-    double secondBestRatio = std::numeric_limits<double>::max();
-    int numPoints = (int)polygonIdxs.size();
-    for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+    AddTriangle(a_cellIdx, a_cellPointIdxs[0], a_cellPointIdxs[1], a_cellPointIdxs[2]);
+    return;
+  }
+  if (a_cellPointIdxs.size() == 4)
+  {
+    int earIdx = iFindQuadEar(points, a_cellPointIdxs);
+    if (earIdx < 0)
     {
-      int idx1 = polygonIdxs[(pointIdx + numPoints - 1) % numPoints];
-      int idx2 = polygonIdxs[pointIdx];
-      int idx3 = polygonIdxs[(pointIdx + 1) % numPoints];
-
-      // make sure triangle is valid (not inverted and doesn't have other points in it)
-      double ratio = iGetEarcutTriangleRatio(points, idx1, idx2, idx3, topFace,
-                                             areaCache, crossZCache, ratioCache);
-      if (ratio > 0.0)
-      {
-        if (iValidTriangle(points, polygonIdxs, idx1, idx2, idx3, topFace, validCache))
-        {
-          if (ratio < bestRatio)
-          {
-            secondBestRatio = bestRatio;
-            bestRatio = ratio;
-            secondBestIdx = bestIdx;
-            bestIdx = pointIdx;
-          }
-          else if (ratio < secondBestRatio)
-          {
-            secondBestRatio = ratio;
-            secondBestIdx = pointIdx;
-          }
-        }
-      }
+      iLogSplitError(a_cellIdx);
+      return;
     }
-
-    if (bestIdx >= 0)
+    AddTriangle(a_cellIdx, a_cellPointIdxs[(earIdx + 3) % 4], a_cellPointIdxs[earIdx],
+                a_cellPointIdxs[(earIdx + 1) % 4]);
+    int remaining[3];
+    int numRemaining = 0;
+    for (int pointIdx = 0; pointIdx < 4; ++pointIdx)
     {
-      if (numPoints == 4 && secondBestIdx >= 0)
-        bestIdx = secondBestIdx;
-
-      // cut off the ear triangle
-      int polygonIdx1 = (bestIdx + numPoints - 1) % numPoints;
-      int polygonIdx2 = bestIdx;
-      int polygonIdx3 = (bestIdx + 1) % numPoints;
-      int idx1 = polygonIdxs[polygonIdx1];
-      int idx2 = polygonIdxs[polygonIdx2];
-      int idx3 = polygonIdxs[polygonIdx3];
-      AddTriangle(a_cellIdx, idx1, idx2, idx3);
-      polygonIdxs.erase(polygonIdxs.begin() + polygonIdx2);
+      if (pointIdx != earIdx)
+        remaining[numRemaining++] = a_cellPointIdxs[pointIdx];
     }
-    else
+    AddTriangle(a_cellIdx, remaining[0], remaining[1], remaining[2]);
+    return;
+  }
+
+  if (a_cellPointIdxs.size() < 3)
+  {
+    iLogSplitError(a_cellIdx);
+    return;
+  }
+
+  // continually find best triangle on adjacent edges and cut it off polygon
+  XmEarClipper clipper(points, a_cellPointIdxs);
+  int idx1, idx2, idx3;
+  while (clipper.GetNumPoints() >= 4)
+  {
+    if (!clipper.ClipEar(idx1, idx2, idx3))
     {
-      std::ostringstream ss;
-      ss << "Unable to split cell number " << a_cellIdx + 1 << " into triangles.";
-      XM_LOG(xmlog::error, ss.str());
+      iLogSplitError(a_cellIdx);
       return;
     }
+    AddTriangle(a_cellIdx, idx1, idx2, idx3);
   }
 
   // push on remaining triangle
-  AddTriangle(a_cellIdx, polygonIdxs[0], polygonIdxs[1], polygonIdxs[2]);
+  clipper.GetLastTriangle(idx1, idx2, idx3);
+  AddTriangle(a_cellIdx, idx1, idx2, idx3);
 } // XmUGridTriangulatorBase::BuildEarcutTriangles
 //------------------------------------------------------------------------------
 /// \brief Attempt to generate triangles for a cell by adding a point at the
@@ -400,14 +642,15 @@ bool XmUGridTriangulatorBase::GenerateCentroidTriangles(int a_cellIdx,
   const VecPt3d& points = GetPoints();
   size_t numPoints = a_cellPointIdxs.size();
 
-  VecPt3d polygon;
+  VecPt3d& polygon = m_impl->m_polygon;
+  polygon.clear();
   for (size_t pointIdx = 0; pointIdx < numPoints; ++pointIdx)
     polygon.push_back(points[a_cellPointIdxs[pointIdx]]);
 
   Pt3d centroid = gmComputePolygonCentroid(polygon);
 
   // make sure the centroid is located inside the cell
-  if (gmPointInPolygon2D(polygon, centroid) != 1)
+  if (!iIsConvexTriangleOrQuad(polygon) && gmPointInPolygon2D(polygon, centroid) != 1)
   {
     return false;
   }